@@ -2,18 +2,36 @@
 
 #include <bitboard/bitboard_export.hpp>
 #include <bitboard/color.hpp>
+#include <bitboard/config.hpp>
 #include <bitboard/figure.hpp>
 #include <bitboard/position.hpp>
 #include <bitboard/turn.hpp>
+#include <bitboard/utils/attack_counts.hpp>
+#include <bitboard/utils/bit_const.hpp>
+#include <bitboard/utils/fen_parser.hpp>
+#include <bitboard/utils/mobility.hpp>
+#include <bitboard/utils/packed_board.hpp>
+#include <bitboard/utils/turn_changes.hpp>
+#include <bitboard/utils/turn_targets.hpp>
 
 namespace bitboard
 {
 
-using bitboard_field = uint64_t;
-using bitboard_hash = uint64_t;
-
-static constexpr auto kChessMaxTurns = 216;
+/**
+ * @brief Room for the turns of any position; 218 legal turns is the known
+ * maximum, pseudo-legal lists can be a bit longer.
+ */
+static constexpr auto kChessMaxTurns = 256;
 
+/**
+ * @brief A chess position stored as one bitboard per figure.
+ *
+ * Built with BITBOARD_ATTACK_CACHE, the board keeps the attack maps,
+ * checkers and pinned figures once they are computed, until the next change
+ * of the position. Queries on a const board then write the cache, so a board
+ * shared between threads has to be copied, not queried concurrently;
+ * kStartBitBoard comes with a full cache and is safe to share.
+ */
 class BITBOARD_EXPORT BitBoard
 {
 public:
@@ -29,32 +47,401 @@ public:
     kFlagsUpperBound = 64  // upper bound for generator
   };
 
+  /**
+   * @brief Squares and figures that give check to the enemy king, computed
+   * once per position by checkInfo() for any number of givesCheck calls.
+   */
+  struct CheckInfo
+  {
+    // squares from which a figure of the side to move checks, indexed by
+    // the figure without color minus one (pawn .. queen, king stays empty)
+    bitboard_field squares[6] = {};
+    // own figures that discover a check when they leave their ray
+    bitboard_field discovered = 0;
+    bitboard_field rays[8] = {};  // from the enemy king to the own slider
+    std::size_t count = 0;
+    Position king;  // the enemy king, invalid without one
+  };
+
   BitBoard() = default;
   BitBoard(BitBoard&&) = delete;
   BitBoard(const BitBoard& board) = default;
 
+  /**
+   * @brief Constructs a board from a FEN line (or "startpos"); leaves the board
+   * empty if the line can't be parsed. Use boardFromFen to get the reason.
+   */
   explicit BitBoard(std::string_view fen_line);
 
   BitBoard& operator=(BitBoard&&) = delete;
   BitBoard& operator=(const BitBoard&) = default;
 
-  void setTurn(Turn turn) const;
-  void setFlags(Flags flags) const;
-  void set(Position position, Figure figure) const;
+  void setTurn(Turn turn);
+  void setFlags(Flags flags);
+  void setCounters(uint16_t halfmove_clock, uint16_t fullmove_number);
+  void set(Position position, Figure figure);
 
-  void swap(Position pos_1, Position pos_2) const;
+  void swap(Position pos_1, Position pos_2);
+
+  /**
+   * @brief Makes the turn of the side to move in place.
+   *
+   * The turn is expected to be legal. The work is chosen by the kind of the
+   * turn; unclassified turns are classified first. Updates the castling
+   * rights, el passant, counters and the side to move. A turn that doesn't
+   * fit the board, e.g. a stale killer or hash move, leaves it unchanged: see
+   * applicable().
+   */
+  void executeTurn(Turn turn);
+
+  /**
+   * @brief Returns the turn with its kind taken from the board, turns that
+   * are already classified are returned as they are.
+   *
+   * Castling is a king move by two files, a promotion without a figure
+   * promotes to a queen.
+   */
+  [[nodiscard]] Turn classify(Turn turn) const noexcept;
+
+  /**
+   * @brief Writes the figures the turn takes away and puts down into `out`,
+   * which must have room for kTurnMaxChanges changes: the captured figure,
+   * the moved one from and to its squares, the promoted figure and the
+   * castling rook.
+   *
+   * @return Number of written changes, zero for the turns executeTurn()
+   * ignores.
+   */
+  std::size_t turnChanges(Turn turn, FigureChange* out) const noexcept;
 
   [[nodiscard]] Turn turn() const;
   [[nodiscard]] std::string fen() const;
   [[nodiscard]] bitboard_hash hash() const;
   [[nodiscard]] Color side() const noexcept;
   [[nodiscard]] Flags flags() const noexcept;
+  [[nodiscard]] Position elPassant() const noexcept;
+  [[nodiscard]] uint16_t halfmoveClock() const noexcept;
+  [[nodiscard]] uint16_t fullmoveNumber() const noexcept;
   [[nodiscard]] Figure get(Position position) const noexcept;
 
+  /**
+   * @brief Returns the bitboard of the given figure (with its color);
+   * Figure::kEmpty gives the empty squares.
+   */
+  [[nodiscard]] bitboard_field pieces(Figure figure) const noexcept;
+
+  /**
+   * @brief Returns the bitboard of all figures of both colors.
+   */
+  [[nodiscard]] bitboard_field occupancy() const noexcept;
+
+  /**
+   * @brief Returns the bitboard of all white figures.
+   */
+  [[nodiscard]] bitboard_field whites() const noexcept;
+
+  /**
+   * @brief Returns the bitboard of all black figures.
+   */
+  [[nodiscard]] bitboard_field blacks() const noexcept;
+
+  /**
+   * @brief Returns figures of both colors that attack the position.
+   *
+   * Sliders are traced through `occupancy`, which lets callers look through
+   * figures they have removed; pass occupancy() for the board as it is.
+   */
+  [[nodiscard]] bitboard_field attackersTo(
+      Position position, bitboard_field occupancy) const noexcept;
+
+  /**
+   * @brief Checks whether the king of the given color is attacked.
+   */
+  [[nodiscard]] bool kingAttacked(Color color) const noexcept;
+
+  /**
+   * @brief Checks whether the turn is legal for the side to move without
+   * generating moves.
+   *
+   * Reachability comes from the attack masks of the moved figure, king
+   * safety from the attackers of the king with the occupancy changed by the
+   * turn, which covers pins, checks and el passant. A classified turn must
+   * carry the kind the board gives it; a promotion must name its figure.
+   * Meant for untrusted turns, e.g. from clients or the hash table.
+   */
+  [[nodiscard]] bool isLegal(Turn turn) const noexcept;
+
+  /**
+   * @brief Writes the legal turns of the side to move into `out`, which must
+   * have room for kChessMaxTurns turns. The turns are classified.
+   *
+   * Checks and pins are computed once per call, so no turn is made to test
+   * the king.
+   *
+   * @return Number of written turns.
+   */
+  std::size_t getTurns(Turn* out) const noexcept;
+
+  /**
+   * @brief Returns the legal turns of the side to move as target masks per
+   * from-square, the same turns as getTurns().
+   *
+   * The masks come straight from the attack lookups and the checks and pins,
+   * no Turn is written; enough for highlighting, policy masks and counting.
+   */
+  [[nodiscard]] TurnTargets getTargets() const noexcept;
+
+  /**
+   * @brief Writes the pseudo-legal turns of the side to move into `out`,
+   * which must have room for kChessMaxTurns turns.
+   *
+   * Same as getTurns without the check and pin computation, the turns may
+   * leave the own king attacked; filter them with isLegalAfterPseudo before
+   * or after making them. Castling is complete here, it is never generated
+   * out of, through or into check.
+   *
+   * @return Number of written turns.
+   */
+  std::size_t getPseudoTurns(Turn* out) const noexcept;
+
+  /**
+   * @brief Checks whether a turn from getPseudoTurns keeps the own king safe.
+   */
+  [[nodiscard]] bool isLegalAfterPseudo(Turn turn) const noexcept;
+
+  /**
+   * @brief Returns the figures that attack the king of the side to move.
+   */
+  [[nodiscard]] bitboard_field checkers() const noexcept;
+
+  /**
+   * @brief Returns the figures of the side to move that can't leave the line
+   * between their king and an enemy slider.
+   */
+  [[nodiscard]] bitboard_field pinned() const noexcept;
+
+  /**
+   * @brief Returns the squares attacked by the figures of the color.
+   *
+   * Sliders see through the enemy king, so the map also tells the squares
+   * the king can't step back to along a checking ray.
+   */
+  [[nodiscard]] bitboard_field attacks(Color color) const noexcept;
+
+  /**
+   * @brief Returns how many figures of the color attack every square.
+   *
+   * The attacks of every figure are summed into bit-sliced counters, the
+   * pawns as two sets; squares with a count match attacks().
+   */
+  [[nodiscard]] AttackCounts attackCounts(Color color) const noexcept;
+
+  /**
+   * @brief Returns the mobility and king zone attacks of the color, straight
+   * from the attack lookups; no turns are generated.
+   *
+   * A figure's safe targets are the squares it attacks that hold no own
+   * figure and aren't attacked by an enemy pawn; pawns count their pushes
+   * and captures, the king only the squares the enemy doesn't attack. Pins
+   * are ignored. The king zone terms leave the own king out.
+   */
+  [[nodiscard]] Mobility mobility(Color color) const noexcept;
+
+  /**
+   * @brief Checks whether the side to move has a legal turn.
+   *
+   * Stops at the first one, trying king steps, knights and pawns before the
+   * sliders; no move list is written.
+   */
+  [[nodiscard]] bool hasLegalMove() const noexcept;
+
+  /**
+   * @brief Checks whether the side to move is in check without a legal turn.
+   */
+  [[nodiscard]] bool isCheckmate() const noexcept;
+
+  /**
+   * @brief Checks whether the side to move isn't in check and has no legal
+   * turn.
+   */
+  [[nodiscard]] bool isStalemate() const noexcept;
+
+  /**
+   * @brief Computes the check squares and discovered check candidates of the
+   * side to move.
+   */
+  [[nodiscard]] CheckInfo checkInfo() const noexcept;
+
+  /**
+   * @brief Checks whether the turn of the side to move checks the enemy
+   * king, without making it.
+   *
+   * Direct checks are looked up in the check squares, discovered checks in
+   * the candidates and their rays; promotions, el passant and castling
+   * trace the sliders with the occupancy after the turn.
+   */
+  [[nodiscard]] bool givesCheck(Turn turn,
+                                const CheckInfo& info) const noexcept;
+
+  /**
+   * @brief Same as above with checkInfo() computed for the call.
+   */
+  [[nodiscard]] bool givesCheck(Turn turn) const noexcept;
+
+  /**
+   * @brief Static exchange evaluation: the material the side to move wins
+   * with the turn when both sides keep recapturing on its target with the
+   * least valuable figure, each free to stop.
+   *
+   * Sliders behind the capturing figures join as they are removed (x-rays).
+   * Pins are ignored, the king only captures an undefended figure. A
+   * promotion of the turn itself counts; castling is worth zero.
+   *
+   * @return The balance in centipawns, see figureValue.
+   */
+  [[nodiscard]] int see(Turn turn) const noexcept;
+
+  /**
+   * @brief Checks whether see(turn) >= threshold, stopping as soon as the
+   * outcome is known.
+   */
+  [[nodiscard]] bool seeGE(Turn turn, int threshold) const noexcept;
+
   bool operator==(const BitBoard& board) const = default;
   bool operator!=(const BitBoard& board) const = default;
 
 protected:
+  /**
+   * @brief Replaces all figures, `fields` are in the order of the members
+   * below (white pawn .. black king).
+   */
+  void setPieces(const bitboard_field (&fields)[12]) noexcept;
+
+  /**
+   * @brief Returns the bitboard of a figure (not Figure::kEmpty).
+   */
+  bitboard_field& field(Figure figure) noexcept;
+
+  /**
+   * @brief Checks whether the classified turn fits the board: it moves a
+   * figure of the side to move, quiet kinds go to an empty square, captures
+   * take an opponent figure, el passant takes an opponent pawn and castling
+   * finds its own rook.
+   */
+  [[nodiscard]] bool applicable(Turn turn) const noexcept;
+
+  /**
+   * @brief Checks the castling of the side to move to `to`: the right, the
+   * rook, the empty squares between and that the king isn't attacked on the
+   * way.
+   */
+  [[nodiscard]] bool castlingAllowed(Position to) const noexcept;
+
+  /**
+   * @brief Checks whether the own king isn't attacked after the classified
+   * turn, which must not be a king move.
+   */
+  [[nodiscard]] bool kingSafeAfter(Turn turn) const noexcept;
+
+  /**
+   * @brief Checks and pins of the side to move.
+   */
+  struct Restrictions
+  {
+    /**
+     * @brief Returns the squares a figure other than the king may go to from
+     * `from_mask`, before removing the own figures.
+     */
+    [[nodiscard]] bitboard_field allowed(
+        bitboard_field from_mask) const noexcept;
+
+    bitboard_field checkers = 0;
+    // the checker and the squares between it and the king, everything when
+    // not in check, nothing on a double check
+    bitboard_field target = ~bitboard_field {0};
+    bitboard_field pinned = 0;
+    Position king;  // pinned figures stay on the line through the king
+  };
+
+  /**
+   * @brief Returns the checkers and pinned figures of the side to move with
+   * the squares they leave to the other figures.
+   */
+  [[nodiscard]] Restrictions restrictions() const noexcept;
+
+  /**
+   * @brief Computes the attack map of a color, see attacks().
+   */
+  [[nodiscard]] bitboard_field computeAttacks(Color color) const noexcept;
+
+  /**
+   * @brief Computes the checkers and pinned figures of the side to move.
+   */
+  void computeChecks(bitboard_field& checkers,
+                     bitboard_field& pinned) const noexcept;
+
+  /**
+   * @brief Drops the cached attack maps, called by every change of the
+   * figures or the side to move.
+   */
+  void invalidate() noexcept;
+
+  /**
+   * @brief Returns the least valuable figure of the color among `attackers`
+   * as a single bit, and its figure without color.
+   */
+  [[nodiscard]] bitboard_field leastValuable(bitboard_field attackers,
+                                             bool white,
+                                             Figure& figure) const noexcept;
+
+  /**
+   * @brief The captures on the target square of a turn, each side taking
+   * back with its least valuable attacker; shared by see() and seeGE().
+   */
+  struct Exchange
+  {
+    /**
+     * @brief Returns the least valuable attacker of the side to capture as a
+     * single bit, zero when it has none, and its figure without color.
+     */
+    [[nodiscard]] bitboard_field next(Figure& figure) const noexcept;
+
+    /**
+     * @brief Checks whether the other side attacks the square besides `bit`,
+     * a king may only capture when it doesn't.
+     */
+    [[nodiscard]] bool defended(bitboard_field bit) const noexcept;
+
+    /**
+     * @brief Makes the capture with `bit`: the sliders behind it join in and
+     * the other side is to capture.
+     */
+    void capture(bitboard_field bit) noexcept;
+
+    const BitBoard* board = nullptr;
+    int gain = 0;  // value the turn takes, a promotion included
+    int attacker = 0;  // value of the figure the turn leaves on the square
+    Position to;
+    bitboard_field all = 0;  // occupancy after the turn
+    bitboard_field attackers = 0;
+    bitboard_field white_figures = 0;
+    bitboard_field black_figures = 0;
+    bool white = false;  // side to capture
+  };
+
+  /**
+   * @brief Returns the exchange after the classified turn, which must be
+   * valid and not castling.
+   */
+  [[nodiscard]] Exchange startExchange(Turn turn) const noexcept;
+
+  /**
+   * @brief Shared implementation of getTurns, getPseudoTurns and getTargets;
+   * hands the turns it finds to `emit`, which writes turns or target masks.
+   */
+  template<bool kLegal, typename Emitter>
+  void generate(Emitter& emit) const noexcept;
+
   // bitboards white
   bitboard_field m_white_pawn = 0;
   bitboard_field m_white_knight = 0;
@@ -71,8 +458,43 @@ protected:
   bitboard_field m_black_king = 0;
   // other state
   bitboard_hash m_hash = 0;
-  Turn m_prev_turn();
+  Turn m_prev_turn;
+  uint16_t m_halfmove_clock = 0;
+  uint16_t m_fullmove_number = 1;
   Flags m_flags = Flags::kFlagsDefault;
+
+#ifdef BITBOARD_ATTACK_CACHE
+  /**
+   * @brief Attack maps, checkers and pins computed on first use; never part
+   * of the comparison of boards.
+   */
+  struct AttackCache
+  {
+    static constexpr uint8_t kWhiteAttacks = 1;
+    static constexpr uint8_t kBlackAttacks = 2;
+    static constexpr uint8_t kChecks = 4;
+
+    friend constexpr bool operator==(const AttackCache&,
+                                     const AttackCache&) noexcept
+    {
+      return true;
+    }
+
+    bitboard_field attacks[2] = {};  // white, black
+    bitboard_field checkers = 0;
+    bitboard_field pinned = 0;
+    uint8_t valid = 0;
+  };
+
+  mutable AttackCache m_cache;
+#endif
+
+  friend FenStatus boardFromFen(std::string_view fen,
+                                BitBoard& board,
+                                std::size_t& index) noexcept;
+  friend bool unpackBoard(const PackedBoard& packed, BitBoard& board) noexcept;
+  friend std::size_t unpackBoard(std::span<const uint8_t> data,
+                                 BitBoard& board) noexcept;
 };
 
 BITBOARD_EXPORT extern const char* const kStartPosition;
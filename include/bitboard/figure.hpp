@@ -39,4 +39,15 @@ enum struct Figure : int8_t
   kBKing = -6,
 };
 
+/**
+ * @brief Material value of a figure of either color in centipawns; the king
+ * is worth more than all other figures together.
+ */
+constexpr int figureValue(Figure figure) noexcept
+{
+  constexpr int kValues[] = {0, 100, 320, 330, 500, 900, 20000};
+  const auto index = static_cast<int8_t>(figure);
+  return kValues[index < 0 ? -index : index];
+}
+
 }  // namespace bitboard
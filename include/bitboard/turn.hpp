@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 #include <bitboard/bitboard_export.hpp>
@@ -9,12 +10,47 @@
 namespace bitboard
 {
 
+/**
+ * @brief Maximal length of a turn in UCI notation (`e7e8q`).
+ */
+constexpr std::size_t kTurnMaxLength = 5;
+
+/**
+ * @brief Kind of a turn, filled in by the generator so make-move doesn't have
+ * to rediscover it from the board.
+ *
+ * Promotions take the upper half of the values: the low two bits hold the
+ * figure (knight .. queen) and the third bit marks a capture.
+ */
+enum struct TurnKind : uint8_t
+{
+  kUnknown = 0,  // not classified, e.g. parsed from UCI
+  kQuiet = 1,
+  kDoublePush = 2,
+  kCapture = 3,
+  kElPassant = 4,
+  kCastling = 5,
+  kPromotion = 8,
+  kPromotionCapture = 12,
+};
+
+/**
+ * @brief Returns the kind of a promotion to `figure` (knight .. queen).
+ */
+constexpr TurnKind promotionKind(Figure figure, bool capture) noexcept
+{
+  return static_cast<TurnKind>(
+      static_cast<uint8_t>(capture ? TurnKind::kPromotionCapture
+                                   : TurnKind::kPromotion)
+      | ((static_cast<uint8_t>(figure) - static_cast<uint8_t>(Figure::kKnight))
+         & 3U));
+}
+
 /**
  * @brief Represents a chess turn (move).
  *
- * Encapsulates move information: start/end positions, promotion figure (if pawn
- * promotion), and flags for validity, promotion (is a pawn promotion), and
- * triviality (simple move). Optimized for size (2 bytes).
+ * Encapsulates move information: start/end positions and the kind of the
+ * turn, which includes the promotion figure. Optimized for size (2 bytes).
  */
 class BITBOARD_EXPORT Turn
 {
@@ -47,27 +83,43 @@ public:
   constexpr Turn(Position from, Position to, Figure figure) noexcept;
 
   /**
-   * @brief Constructs a Turn from chess notation; invalidates on parsing errors
-   * or invalid positions.
-   * @param chess_format A string in chess notation.
+   * @brief Constructs a Turn of the given kind; invalidates on invalid input.
+   * @param from The starting position.
+   * @param to The ending position.
+   * @param kind The kind, promotions are made with promotionKind.
+   */
+  constexpr Turn(Position from, Position to, TurnKind kind) noexcept;
+
+  /**
+   * @brief Constructs a Turn from UCI notation (`e2e4`, `e7e8q`); invalidates
+   * on parsing errors or invalid positions.
+   * @param chess_format A string in UCI notation.
    */
   explicit Turn(std::string_view chess_format);
 
   /**
-   * @brief Converts the Turn to a string (e.g., algebraic notation).
+   * @brief Converts the Turn to UCI notation.
    * @return String representation of the turn.
    */
   [[nodiscard]] std::string toString() const;
 
   /**
-   * @brief Equality operator.
+   * @brief Writes the Turn in UCI notation into `out`, which must have room
+   * for kTurnMaxLength characters; no terminating zero is written.
+   * @return Number of written characters.
    */
-  constexpr bool operator==(const Turn& other) const = default;
+  constexpr std::size_t toChars(char* out) const noexcept;
+
+  /**
+   * @brief Equality operator, compares the squares and the promotion figure;
+   * a classified turn equals the same turn parsed without a board.
+   */
+  constexpr bool operator==(const Turn& other) const noexcept;
 
   /**
    * @brief Inequality operator.
    */
-  constexpr bool operator!=(const Turn& other) const = default;
+  constexpr bool operator!=(const Turn& other) const noexcept;
 
   /**
    * @brief Assignment operator.
@@ -110,6 +162,19 @@ public:
    */
   [[nodiscard]] constexpr bool trivial() const noexcept;
 
+  /**
+   * @brief Gets the kind; both promotion kinds are reported without the
+   * figure, use figure() for it.
+   * @return The kind (TurnKind::kUnknown if not classified).
+   */
+  [[nodiscard]] constexpr TurnKind kind() const noexcept;
+
+  /**
+   * @brief Checks if the Turn is classified as a capture (including el
+   * passant and capturing promotions).
+   */
+  [[nodiscard]] constexpr bool capture() const noexcept;
+
   /**
    * @brief Unsafely constructs a Turn without validation. Use with caution.
    * @param from The starting position.
@@ -135,16 +200,43 @@ public:
                                         Figure figure,
                                         bool trivial) noexcept;
 
-private:
-  constexpr Turn(Position from, Position to, bool trivial);
-  constexpr Turn(Position from, Position to, Figure figure, bool trivial);
+  /**
+   * @brief Unsafely constructs a Turn of the given kind without validation.
+   * Use with caution.
+   * @param from The starting position.
+   * @param to The ending position.
+   * @param kind The kind of the turn.
+   * @return A Turn object.
+   */
+  static constexpr Turn unsafeConstruct(Position from,
+                                        Position to,
+                                        TurnKind kind) noexcept;
 
+private:
   uint16_t m_from : 6 = 0;
   uint16_t m_to : 6 = 0;
-  uint16_t m_trivial : 1 = 0;
-  uint16_t m_figure : 3 = static_cast<uint16_t>(Figure::kEmpty);
+  uint16_t m_kind : 4 = static_cast<uint16_t>(TurnKind::kUnknown);
 };
 
+/**
+ * @brief A turn with an ordering score, for move ordering in search.
+ */
+struct ScoredTurn
+{
+  Turn turn;
+  int16_t score = 0;
+
+  /**
+   * @brief Orders by score, higher scores first.
+   */
+  constexpr bool operator<(const ScoredTurn& other) const noexcept
+  {
+    return score > other.score;
+  }
+};
+
+static_assert(sizeof(ScoredTurn) == 4, "ScoredTurn must be exactly 4 bytes!");
+
 /**
  * @brief Ensures Turn size is exactly 2 bytes for efficiency.
  */
@@ -161,22 +253,30 @@ constexpr Turn::Turn(Position from, Position to) noexcept
 }
 
 constexpr Turn::Turn(Position from, Position to, Figure figure) noexcept
-    : m_from(from.index())
-    , m_to(to.index())
-    , m_figure(static_cast<uint16_t>(figure))
+    : Turn(from, to, promotionKind(figure, false))
 {
-  if (!from.valid() || !to.valid() || figure == Figure::kEmpty
-      || figure == Figure::kPawn || figure == Figure::kBKing)
+  if (figure < Figure::kKnight || figure > Figure::kQueen) {
+    *this = {};
+  }
+}
+
+constexpr Turn::Turn(Position from, Position to, TurnKind kind) noexcept
+    : m_from(from.index() & 0x3FU)
+    , m_to(to.index() & 0x3FU)
+    , m_kind(static_cast<uint8_t>(kind) & 0x0FU)
+{
+  const auto value = static_cast<uint8_t>(kind);
+  if (!from.valid() || !to.valid() || value > 15
+      || (value > static_cast<uint8_t>(TurnKind::kCastling)
+          && value < static_cast<uint8_t>(TurnKind::kPromotion)))
   {
-    m_from = 0;
-    m_to = 0;
-    m_figure = static_cast<uint16_t>(Figure::kEmpty);
+    *this = {};
   }
 }
 
 inline Turn::Turn(std::string_view chess_format)
 {
-  if (chess_format.length() < 4 && chess_format.length() > 5) {
+  if (chess_format.length() < 4 || chess_format.length() > 5) {
     return;
   }
 
@@ -186,7 +286,7 @@ inline Turn::Turn(std::string_view chess_format)
   auto figure = Figure::kEmpty;
   if (chess_format.length() == 5) {
     switch (chess_format[4]) {
-      case 'k':
+      case 'n':
         figure = Figure::kKnight;
         break;
       case 'b':
@@ -204,42 +304,40 @@ inline Turn::Turn(std::string_view chess_format)
     }
   }
   if (from_pos.valid() && to_pos.valid()) {
-    m_from = from_pos.index();
-    m_to = to_pos.index();
-    m_figure = static_cast<uint16_t>(figure);
+    *this = figure == Figure::kEmpty ? Turn(from_pos, to_pos)
+                                     : Turn(from_pos, to_pos, figure);
   }
 }
 
 inline std::string Turn::toString() const
 {
-  std::string result;
-  result.reserve(5);
-
-  auto from_str = Position(m_from).toString();
-  auto to_str = Position(m_to).toString();
-
-  result += from_str + to_str;
+  char buffer[kTurnMaxLength];
+  return {buffer, toChars(buffer)};
+}
 
-  if (auto figure = static_cast<Figure>(m_figure); figure != Figure::kEmpty) {
-    switch (figure) {
-      case Figure::kKnight:
-        result.push_back('k');
-        break;
-      case Figure::kBishop:
-        result.push_back('b');
-        break;
-      case Figure::kRook:
-        result.push_back('r');
-        break;
-      case Figure::kQueen:
-        result.push_back('q');
-        break;
-      default:
-        break;
-    }
+constexpr std::size_t Turn::toChars(char* out) const noexcept
+{
+  out[0] = static_cast<char>('a' + (m_from % kBoardSize));
+  out[1] = static_cast<char>('8' - (m_from / kBoardSize));
+  out[2] = static_cast<char>('a' + (m_to % kBoardSize));
+  out[3] = static_cast<char>('8' - (m_to / kBoardSize));
+
+  switch (figure()) {
+    case Figure::kKnight:
+      out[4] = 'n';
+      return 5;
+    case Figure::kBishop:
+      out[4] = 'b';
+      return 5;
+    case Figure::kRook:
+      out[4] = 'r';
+      return 5;
+    case Figure::kQueen:
+      out[4] = 'q';
+      return 5;
+    default:
+      return 4;
   }
-
-  return result;
 }
 
 constexpr Position Turn::from() const noexcept
@@ -254,7 +352,9 @@ constexpr Position Turn::to() const noexcept
 
 constexpr Figure Turn::figure() const noexcept
 {
-  return static_cast<Figure>(m_figure);
+  return promotion() ? static_cast<Figure>(static_cast<uint8_t>(Figure::kKnight)
+                                           + (m_kind & 3U))
+                     : Figure::kEmpty;
 }
 
 constexpr bool Turn::valid() const noexcept
@@ -264,19 +364,43 @@ constexpr bool Turn::valid() const noexcept
 
 constexpr bool Turn::promotion() const noexcept
 {
-  return static_cast<Figure>(m_figure) != Figure::kEmpty;
+  return m_kind >= static_cast<uint8_t>(TurnKind::kPromotion);
 }
 
 constexpr bool Turn::trivial() const noexcept
 {
-  return m_trivial;
+  return m_kind == static_cast<uint8_t>(TurnKind::kQuiet);
+}
+
+constexpr TurnKind Turn::kind() const noexcept
+{
+  return static_cast<TurnKind>(promotion() ? m_kind & 0x0CU : m_kind);
+}
+
+constexpr bool Turn::capture() const noexcept
+{
+  return m_kind == static_cast<uint8_t>(TurnKind::kCapture)
+      || m_kind == static_cast<uint8_t>(TurnKind::kElPassant)
+      || m_kind >= static_cast<uint8_t>(TurnKind::kPromotionCapture);
+}
+
+constexpr bool Turn::operator==(const Turn& other) const noexcept
+{
+  return m_from == other.m_from && m_to == other.m_to
+      && figure() == other.figure();
+}
+
+constexpr bool Turn::operator!=(const Turn& other) const noexcept
+{
+  return !(*this == other);
 }
 
 constexpr Turn Turn::unsafeConstruct(Position from,
                                      Position to,
                                      bool trivial) noexcept
 {
-  return Turn(from, to, Figure::kEmpty, trivial);
+  return unsafeConstruct(
+      from, to, trivial ? TurnKind::kQuiet : TurnKind::kUnknown);
 }
 
 constexpr Turn Turn::unsafeConstruct(Position from,
@@ -284,22 +408,23 @@ constexpr Turn Turn::unsafeConstruct(Position from,
                                      Figure figure,
                                      bool trivial) noexcept
 {
-  return Turn(from, to, figure, trivial);
+  return unsafeConstruct(
+      from,
+      to,
+      figure == Figure::kEmpty
+          ? (trivial ? TurnKind::kQuiet : TurnKind::kUnknown)
+          : promotionKind(figure, false));
 }
 
-constexpr Turn::Turn(Position from, Position to, bool trivial)
-    : m_from(from.index())
-    , m_to(to.index())
-    , m_trivial(trivial)
-{
-}
-
-constexpr Turn::Turn(Position from, Position to, Figure figure, bool trivial)
-    : m_from(from.index())
-    , m_to(to.index())
-    , m_trivial(trivial)
-    , m_figure(static_cast<uint16_t>(figure))
+constexpr Turn Turn::unsafeConstruct(Position from,
+                                     Position to,
+                                     TurnKind kind) noexcept
 {
+  Turn turn;
+  turn.m_from = from.index() & 0x3FU;
+  turn.m_to = to.index() & 0x3FU;
+  turn.m_kind = static_cast<uint8_t>(kind) & 0x0FU;
+  return turn;
 }
 
 }  // namespace bitboard
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <bitboard/position.hpp>
+#include <bitboard/utils/bit_const.hpp>
+
+namespace bitboard
+{
+
+/**
+ * @brief Number of attackers of every square, bit-sliced: plane `i` holds
+ * bit `i` of the count of all 64 squares.
+ *
+ * Adding an attack bitboard is a ripple of half adders over the planes, two
+ * bitboards go through one full adder first, so a whole figure costs a
+ * handful of logic operations instead of a loop over its squares. Counts
+ * saturate at 15; a square can only have more attackers with several
+ * promoted knights.
+ */
+struct AttackCounts
+{
+  static constexpr std::size_t kPlanes = 4;
+
+  bitboard_field planes[kPlanes] = {};
+
+  /**
+   * @brief Adds one to the squares of `attacks`.
+   */
+  constexpr void add(bitboard_field attacks) noexcept
+  {
+    carry(0, attacks);
+  }
+
+  /**
+   * @brief Adds the squares of both bitboards, two where they overlap.
+   */
+  constexpr void add(bitboard_field first, bitboard_field second) noexcept
+  {
+    const bitboard_field sum = planes[0] ^ first ^ second;
+    const bitboard_field carried =
+        (planes[0] & first) | (planes[0] & second) | (first & second);
+    planes[0] = sum;
+    carry(1, carried);
+  }
+
+  /**
+   * @brief Returns the squares attacked at least once.
+   */
+  [[nodiscard]] constexpr bitboard_field once() const noexcept
+  {
+    return planes[0] | planes[1] | planes[2] | planes[3];
+  }
+
+  /**
+   * @brief Returns the squares attacked at least twice.
+   */
+  [[nodiscard]] constexpr bitboard_field twice() const noexcept
+  {
+    return planes[1] | planes[2] | planes[3];
+  }
+
+  /**
+   * @brief Returns the number of attackers of the square.
+   */
+  [[nodiscard]] constexpr uint8_t count(Position position) const noexcept
+  {
+    uint8_t result = 0;
+    for (std::size_t i = 0; i < kPlanes; ++i) {
+      result |=
+          static_cast<uint8_t>(((planes[i] >> position.index()) & 1U) << i);
+    }
+    return result;
+  }
+
+  /**
+   * @brief Writes the counts of all squares, indexed like Position.
+   */
+  constexpr void counts(uint8_t (&out)[64]) const noexcept
+  {
+    // a rank at a time: the bits of a plane spread to the bytes of a word
+    constexpr bitboard_field kBytes = 0x0101010101010101ULL;
+    constexpr bitboard_field kDiagonal = 0x8040201008040201ULL;
+    constexpr bitboard_field kLow = 0x7F7F7F7F7F7F7F7FULL;
+    for (unsigned rank = 0; rank < 8; ++rank) {
+      bitboard_field rank_counts = 0;
+      for (std::size_t i = 0; i < kPlanes; ++i) {
+        const bitboard_field bits =
+            (((planes[i] >> (rank * 8U)) & 0xFFU) * kBytes) & kDiagonal;
+        rank_counts |= ((((bits + kLow) | bits) >> 7U) & kBytes) << i;
+      }
+      for (unsigned file = 0; file < 8; ++file) {
+        out[(rank * 8U) + file] =
+            static_cast<uint8_t>(rank_counts >> (file * 8U));
+      }
+    }
+  }
+
+private:
+  // adds `bits` to the planes from `plane` on, the carry out saturates
+  constexpr void carry(std::size_t plane, bitboard_field bits) noexcept
+  {
+    for (; plane < kPlanes && bits != 0; ++plane) {
+      const bitboard_field next = planes[plane] & bits;
+      planes[plane] ^= bits;
+      bits = next;
+    }
+    for (bitboard_field& value : planes) {
+      value |= bits;
+    }
+  }
+};
+
+}  // namespace bitboard
@@ -1 +1,43 @@
 #pragma once
+
+#include <cstdint>
+
+namespace bitboard
+{
+
+using bitboard_field = uint64_t;
+using bitboard_hash = uint64_t;
+
+/**
+ * @brief Files (columns) of the board, `row_a` is the leftmost one.
+ */
+constexpr bitboard_field row_a = (1ULL) + (1ULL << 8ULL) + (1ULL << 16ULL)
+    + (1ULL << 24ULL) + (1ULL << 32ULL) + (1ULL << 40ULL) + (1ULL << 48ULL)
+    + (1ULL << 56ULL);
+constexpr bitboard_field row_b = row_a << 1ULL;
+constexpr bitboard_field row_c = row_a << 2ULL;
+constexpr bitboard_field row_d = row_a << 3ULL;
+constexpr bitboard_field row_e = row_a << 4ULL;
+constexpr bitboard_field row_f = row_a << 5ULL;
+constexpr bitboard_field row_g = row_a << 6ULL;
+constexpr bitboard_field row_h = row_a << 7ULL;
+constexpr bitboard_field rows[8] {
+    row_a, row_b, row_c, row_d, row_e, row_f, row_g, row_h};
+
+/**
+ * @brief Ranks of the board, `line_8` occupies the lowest byte.
+ */
+constexpr bitboard_field line_8 = (1ULL) + (1ULL << 1ULL) + (1ULL << 2ULL)
+    + (1ULL << 3ULL) + (1ULL << 4ULL) + (1ULL << 5ULL) + (1ULL << 6ULL)
+    + (1ULL << 7ULL);
+constexpr bitboard_field line_7 = line_8 << 8ULL;
+constexpr bitboard_field line_6 = line_8 << 16ULL;
+constexpr bitboard_field line_5 = line_8 << 24ULL;
+constexpr bitboard_field line_4 = line_8 << 32ULL;
+constexpr bitboard_field line_3 = line_8 << 40ULL;
+constexpr bitboard_field line_2 = line_8 << 48ULL;
+constexpr bitboard_field line_1 = line_8 << 56ULL;
+constexpr bitboard_field lines[8] {
+    line_1, line_2, line_3, line_4, line_5, line_6, line_7, line_8};
+
+}  // namespace bitboard
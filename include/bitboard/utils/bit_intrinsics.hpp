@@ -1,43 +1,80 @@
 #pragma once
 
-// #include <cstdint>
-
-// using bitboard = uint64_t;
-
-// #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
-
-// #  include <intrin.h>
-// #  pragma intrinsic(_BitScanForward)
-
-// inline unsigned log2_64(bitboard value)
-// {
-//   unsigned long result = 0;
-//   _BitScanForward64(&result, value);
-//   return result;
-// }
-// #elif defined(__GNUC__) \
-//     && (defined(__x86_64__) || defined(__i386__) || defined(__x86__))
-// inline auto log2_64(bitboard value) -> unsigned
-// {
-//   return static_cast<unsigned>(__builtin_ctzll(value));
-// }
-// #else
-
-// constexpr const int tab64[64] = {
-//     63, 0,  58, 1,  59, 47, 53, 2,  60, 39, 48, 27, 54, 33, 42, 3,
-//     61, 51, 37, 40, 49, 18, 28, 20, 55, 30, 34, 11, 43, 14, 22, 4,
-//     62, 57, 46, 52, 38, 26, 32, 41, 50, 36, 17, 19, 29, 10, 13, 21,
-//     56, 45, 25, 31, 35, 16, 9,  12, 44, 24, 15, 8,  23, 7,  6,  5};
-
-// constexpr unsigned log2_64(bitboard value)
-// {
-//   value |= value >> 1;
-//   value |= value >> 2;
-//   value |= value >> 4;
-//   value |= value >> 8;
-//   value |= value >> 16;
-//   value |= value >> 32;
-//   return tab64[((bitboard)((value - (value >> 1)) * 0x07EDD5E59A4E28C2)) >>
-//   58];
-// }
-// #endif
+#include <bit>
+
+#include <bitboard/utils/bit_const.hpp>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  include <intrin.h>
+#  pragma intrinsic(_BitScanForward64)
+#endif
+
+namespace bitboard
+{
+
+/**
+ * @brief Returns the index of the least significant set bit.
+ *
+ * The result is undefined for an empty bitboard.
+ */
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+inline unsigned log2_64(bitboard_field value)
+{
+  unsigned long result = 0;
+  _BitScanForward64(&result, value);
+  return result;
+}
+#elif defined(__GNUC__) \
+    && (defined(__x86_64__) || defined(__i386__) || defined(__x86__))
+inline auto log2_64(bitboard_field value) -> unsigned
+{
+  return static_cast<unsigned>(__builtin_ctzll(value));
+}
+#else
+
+constexpr const int tab64[64] = {
+    63, 0,  58, 1,  59, 47, 53, 2,  60, 39, 48, 27, 54, 33, 42, 3,
+    61, 51, 37, 40, 49, 18, 28, 20, 55, 30, 34, 11, 43, 14, 22, 4,
+    62, 57, 46, 52, 38, 26, 32, 41, 50, 36, 17, 19, 29, 10, 13, 21,
+    56, 45, 25, 31, 35, 16, 9,  12, 44, 24, 15, 8,  23, 7,  6,  5};
+
+constexpr unsigned log2_64(bitboard_field value)
+{
+  value &= ~value + 1;
+  value |= value >> 1;
+  value |= value >> 2;
+  value |= value >> 4;
+  value |= value >> 8;
+  value |= value >> 16;
+  value |= value >> 32;
+  return static_cast<unsigned>(
+      tab64[((value - (value >> 1)) * 0x07EDD5E59A4E28C2) >> 58]);
+}
+#endif
+
+/**
+ * @brief Reverses the order of the bytes, which mirrors the board between
+ * the ranks.
+ */
+constexpr bitboard_field byteSwap(bitboard_field value)
+{
+#if defined(__GNUC__)
+  return __builtin_bswap64(value);
+#else
+  value = ((value & 0x00FF00FF00FF00FFULL) << 8U)
+      | ((value >> 8U) & 0x00FF00FF00FF00FFULL);
+  value = ((value & 0x0000FFFF0000FFFFULL) << 16U)
+      | ((value >> 16U) & 0x0000FFFF0000FFFFULL);
+  return (value << 32U) | (value >> 32U);
+#endif
+}
+
+/**
+ * @brief Returns the number of set bits.
+ */
+constexpr int popCount(bitboard_field value)
+{
+  return std::popcount(value);
+}
+
+}  // namespace bitboard
@@ -1,63 +1,42 @@
 #pragma once
 
-// #include <bit>
-// #include <string_view>
-
-// #include <bitboard/position.hpp>
-
-// #include "bit_intrinsics.hpp"
-
-// constexpr bitboard getBitBoardOne()
-// {
-//   return static_cast<bitboard>(1);
-// }
-
-// constexpr bitboard positionToMask(Position position)
-// {
-//   return getBitBoardOne() << position.index();
-// }
-
-// constexpr bitboard operator"" _bm(const char* str, std::size_t len)
-// {
-//   return positionToMask(Position(std::string_view(str, len)));
-// }
-
-// constexpr bitboard row_a = (1ULL) + (1ULL << 8ULL) + (1ULL << 16ULL)
-//     + (1ULL << 24ULL) + (1ULL << 32ULL) + (1ULL << 40ULL) + (1ULL << 48ULL)
-//     + (1ULL << 56ULL);
-// constexpr bitboard row_b = row_a << 1ULL;
-// constexpr bitboard row_c = row_a << 2ULL;
-// constexpr bitboard row_d = row_a << 3ULL;
-// constexpr bitboard row_e = row_a << 4ULL;
-// constexpr bitboard row_f = row_a << 5ULL;
-// constexpr bitboard row_g = row_a << 6ULL;
-// constexpr bitboard row_h = row_a << 7ULL;
-// constexpr bitboard rows[8] {
-//     row_a, row_b, row_c, row_d, row_e, row_f, row_g, row_h};
-
-// constexpr bitboard line_8 = (1ULL) + (1ULL << 1ULL) + (1ULL << 2ULL)
-//     + (1ULL << 3ULL) + (1ULL << 4ULL) + (1ULL << 5ULL) + (1ULL << 6ULL)
-//     + (1ULL << 7ULL);
-// constexpr bitboard line_7 = line_8 << 8ULL;
-// constexpr bitboard line_6 = line_8 << 16ULL;
-// constexpr bitboard line_5 = line_8 << 24ULL;
-// constexpr bitboard line_4 = line_8 << 32ULL;
-// constexpr bitboard line_3 = line_8 << 40ULL;
-// constexpr bitboard line_2 = line_8 << 48ULL;
-// constexpr bitboard line_1 = line_8 << 56ULL;
-// constexpr bitboard lines[8] {
-//     line_1, line_2, line_3, line_4, line_5, line_6, line_7, line_8};
-
-// inline bitboard takeBit(bitboard& board)
-// {
-//   bitboard copy = board;
-//   bitboard minus = (board - 1);
-//   bitboard next = board & minus;
-//   board = next;
-//   return copy;
-// }
-
-// constexpr int popCount(bitboard b)
-// {
-//   return std::popcount(b);
-// }
+#include <string_view>
+
+#include <bitboard/position.hpp>
+#include <bitboard/utils/bit_const.hpp>
+#include <bitboard/utils/bit_intrinsics.hpp>
+
+namespace bitboard
+{
+
+constexpr bitboard_field getBitBoardOne()
+{
+  return static_cast<bitboard_field>(1);
+}
+
+constexpr bitboard_field positionToMask(Position position)
+{
+  return getBitBoardOne() << position.index();
+}
+
+constexpr bitboard_field operator"" _bm(const char* str, std::size_t len)
+{
+  return positionToMask(Position(std::string_view(str, len)));
+}
+
+/**
+ * @brief Removes the least significant bit from the board.
+ *
+ * Returns the board as it was before the removal, so `log2_64` of the result
+ * is the index of the removed bit and zero means the board was empty.
+ */
+inline bitboard_field takeBit(bitboard_field& board)
+{
+  bitboard_field copy = board;
+  bitboard_field minus = (board - 1);
+  bitboard_field next = board & minus;
+  board = next;
+  return copy;
+}
+
+}  // namespace bitboard
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <bitboard/bitboard_export.hpp>
+#include <bitboard/color.hpp>
+#include <bitboard/utils/bit_const.hpp>
+
+namespace bitboard
+{
+
+class BitBoard;
+
+/**
+ * @brief Positions stored structure-of-arrays, one lane per position.
+ *
+ * Positions are grouped in blocks of kLanes; a block keeps every figure
+ * bitboard, the flags and the el passant square as one array of kLanes
+ * values. The kernels walk a block with one vector per bitboard, eight
+ * positions per instruction with AVX-512, four with AVX2, and a plain loop
+ * on other CPUs (see cpuLevel()). Nothing is looked up in tables, so every
+ * lane runs the same instructions whatever the position.
+ *
+ * The results match BitBoard: attacks() matches BitBoard::attacks(),
+ * checkers() BitBoard::checkers() and legalTurnCounts() the number of turns
+ * from BitBoard::getTurns(). Every kernel writes the first
+ * `min(size(), out.size())` entries of `out`.
+ */
+class BITBOARD_EXPORT BitBoardBatch
+{
+public:
+  /**
+   * @brief Number of positions in a block.
+   */
+  static constexpr std::size_t kLanes = 8;
+
+  /**
+   * @brief Appends the position of the board.
+   */
+  void add(const BitBoard& board);
+
+  /**
+   * @brief Removes all positions, keeps the memory.
+   */
+  void clear() noexcept;
+
+  /**
+   * @brief Reserves memory for `size` positions.
+   */
+  void reserve(std::size_t size);
+
+  [[nodiscard]] std::size_t size() const noexcept;
+  [[nodiscard]] bool empty() const noexcept;
+
+  /**
+   * @brief Squares attacked by `color` in every position, sliders see
+   * through the enemy king.
+   */
+  void attacks(Color color, std::span<bitboard_field> out) const noexcept;
+
+  /**
+   * @brief Figures giving check to the side to move in every position.
+   */
+  void checkers(std::span<bitboard_field> out) const noexcept;
+
+  /**
+   * @brief Number of legal turns of the side to move in every position,
+   * promotions count once per figure.
+   */
+  void legalTurnCounts(std::span<uint8_t> out) const noexcept;
+
+private:
+  std::vector<bitboard_field> m_blocks;
+  std::size_t m_size = 0;
+};
+
+}  // namespace bitboard
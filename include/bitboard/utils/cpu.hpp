@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#include <bitboard/bitboard_export.hpp>
+
+namespace bitboard
+{
+
+/**
+ * @brief Instruction set levels of x86-64 the dispatched kernels are built
+ * for.
+ */
+enum struct CpuLevel : uint8_t
+{
+  kCpuBaseline = 0,  // x86-64, or a build without dispatch
+  kCpuV2,  // x86-64-v2: POPCNT, SSE4.2
+  kCpuV3,  // x86-64-v3: AVX2, BMI1, BMI2, LZCNT, FMA
+  kCpuV4,  // x86-64-v4: AVX-512 F, BW, DQ, VL
+};
+
+/**
+ * @brief Returns the level of the kernels in use.
+ *
+ * The highest level the processor supports is selected once, on the first
+ * use of a kernel. The environment variable `BITBOARD_CPU_LEVEL` set to a
+ * name of cpuLevelName lowers it, to compare the kernels on one host.
+ */
+BITBOARD_EXPORT CpuLevel cpuLevel() noexcept;
+
+/**
+ * @brief Returns the name of the level: `x86-64`, `x86-64-v2`, `x86-64-v3`
+ * or `x86-64-v4`.
+ */
+BITBOARD_EXPORT const char* cpuLevelName(CpuLevel level) noexcept;
+
+}  // namespace bitboard
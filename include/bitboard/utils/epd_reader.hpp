@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <string_view>
+
+#include <bitboard/bitboard.hpp>
+#include <bitboard/bitboard_export.hpp>
+
+namespace bitboard
+{
+
+/**
+ * @brief Default size of the part of the file handled by one worker at once.
+ */
+constexpr std::size_t kEpdChunkSize = std::size_t {1} << 20U;
+
+/**
+ * @brief Maximal number of boards passed to the callback at once.
+ */
+constexpr std::size_t kEpdBatchSize = 16384;
+
+/**
+ * @brief Reads EPD/FEN files (one position per line) through a memory mapping.
+ *
+ * The mapped file is split into chunks of about `chunk_size` bytes aligned to
+ * line boundaries. Chunks are parsed in parallel with boardFromFen straight
+ * into per-worker batches, so no memory is allocated per line. Lines that
+ * can't be parsed (including empty lines and comments) are skipped.
+ */
+class BITBOARD_EXPORT EpdReader
+{
+public:
+  /**
+   * @brief Receives a batch of parsed boards and the index of the chunk they
+   * come from.
+   */
+  using Callback =
+      std::function<void(std::span<const BitBoard> boards, std::size_t chunk)>;
+
+  /**
+   * @brief Maps the file; check valid() for the result.
+   * @param path Path of the file.
+   */
+  explicit EpdReader(const char* path);
+
+  /**
+   * @brief Wraps already loaded text, the data must outlive the reader.
+   * @param data Text with one position per line.
+   */
+  explicit EpdReader(std::string_view data) noexcept;
+
+  EpdReader(const EpdReader&) = delete;
+  EpdReader(EpdReader&&) = delete;
+  EpdReader& operator=(const EpdReader&) = delete;
+  EpdReader& operator=(EpdReader&&) = delete;
+
+  ~EpdReader();
+
+  /**
+   * @brief Checks whether the file was opened and mapped.
+   */
+  [[nodiscard]] bool valid() const noexcept;
+
+  /**
+   * @brief Returns the whole text of the file.
+   */
+  [[nodiscard]] std::string_view data() const noexcept;
+
+  /**
+   * @brief Parses the file and passes the boards to `callback`.
+   *
+   * In ordered mode batches arrive in file order and the callback is never
+   * called concurrently. In unordered mode batches arrive as soon as they are
+   * ready and the callback must be thread safe.
+   *
+   * @param callback Receives the batches; the span is valid only during the
+   * call.
+   * @param threads Number of workers, zero means hardware concurrency.
+   * @param ordered Whether to keep the order of the file.
+   * @param chunk_size Size of the chunk handled by a worker at once.
+   * @return Number of parsed boards.
+   */
+  std::size_t read(const Callback& callback,
+                   unsigned threads = 0,
+                   bool ordered = true,
+                   std::size_t chunk_size = kEpdChunkSize) const;
+
+private:
+  std::string_view m_data;
+  void* m_mapping = nullptr;
+  std::size_t m_mapping_size = 0;
+  bool m_valid = false;
+};
+
+}  // namespace bitboard
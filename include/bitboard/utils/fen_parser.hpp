@@ -1,24 +1,67 @@
 #pragma once
 
-// #include <stdexcept>
-// #include <string>
-// #include <string_view>
-
-// class bit_board;
-
-// class FenError : public std::runtime_error
-// {
-// public:
-//   explicit FenError(const std::string& message)
-//       : std::runtime_error("FEN Parsing Error: " + message)
-//   {
-//   }
-
-//   explicit FenError(const char* message)
-//       : std::runtime_error(std::string("FEN Parsing Error: ") + message)
-//   {
-//   }
-// };
-
-// void boardFromFen(std::string_view fen, bit_board& board, size_t& index);
-// std::string boardToFen(const bit_board& board);
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <bitboard/bitboard_export.hpp>
+
+namespace bitboard
+{
+
+class BitBoard;
+
+/**
+ * @brief Result of parsing a FEN line.
+ */
+enum struct FenStatus : uint8_t
+{
+  kFenOk = 0,
+  kFenInvalidCharacter,  // unexpected character in the piece placement
+  kFenInvalidBoard,  // piece placement doesn't describe 8 ranks of 8 squares
+  kFenIncomplete,  // the line ends before the side/castling/el passant fields
+  kFenInvalidSide,
+  kFenInvalidCastling,
+  kFenInvalidElPassant,
+  kFenInvalidCounter,
+};
+
+/**
+ * @brief Maximal length of a FEN line written by boardToFen, without the
+ * terminating zero.
+ */
+constexpr std::size_t kFenMaxLength = 96;
+
+/**
+ * @brief Parses a FEN (or EPD) line starting at `index` into `board`.
+ *
+ * Reads the piece placement, side, castling and el passant fields and, when
+ * present, the halfmove clock and fullmove number. The word "startpos" is
+ * accepted as the initial position. On success `index` points past the parsed
+ * text, so trailing EPD operations or UCI moves can be read from there. On
+ * failure the board is left unchanged. Doesn't allocate or throw.
+ *
+ * @return FenStatus::kFenOk or the reason of the failure.
+ */
+BITBOARD_EXPORT FenStatus boardFromFen(std::string_view fen,
+                                       BitBoard& board,
+                                       std::size_t& index) noexcept;
+
+/**
+ * @brief Parses a whole FEN line into `board`.
+ */
+BITBOARD_EXPORT FenStatus boardFromFen(std::string_view fen,
+                                       BitBoard& board) noexcept;
+
+/**
+ * @brief Writes the FEN line of the board into `out`.
+ *
+ * `out` must have room for kFenMaxLength characters; no terminating zero is
+ * written.
+ *
+ * @return Number of written characters.
+ */
+BITBOARD_EXPORT std::size_t boardToFen(const BitBoard& board,
+                                       char* out) noexcept;
+
+}  // namespace bitboard
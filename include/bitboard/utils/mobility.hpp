@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+namespace bitboard
+{
+
+/**
+ * @brief Weights of the figures attacking the enemy king zone, pawn to king.
+ */
+constexpr uint16_t kKingAttackWeights[6] = {0, 81, 52, 44, 10, 0};
+
+/**
+ * @brief Mobility and king safety terms of one color, see
+ * BitBoard::mobility().
+ */
+struct Mobility
+{
+  // safe target squares summed over the figures, pawn to king
+  uint8_t figures[6] = {};
+  // figures attacking the zone of the enemy king, its square and neighbours
+  uint8_t king_attackers = 0;
+  // attacked squares of the zone summed over these figures
+  uint8_t king_attacks = 0;
+  // kKingAttackWeights of these figures summed
+  uint16_t king_attack_weight = 0;
+
+  bool operator==(const Mobility& other) const = default;
+};
+
+}  // namespace bitboard
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <bitboard/bitboard_export.hpp>
+#include <bitboard/color.hpp>
+#include <bitboard/figure.hpp>
+#include <bitboard/position.hpp>
+#include <bitboard/turn.hpp>
+
+namespace bitboard
+{
+
+class BitBoard;
+
+/**
+ * @brief Input feature sets of NNUE evaluators, one feature per figure and
+ * square relative to the king of the perspective.
+ */
+enum struct NnueFeatureSet : uint8_t
+{
+  // kings aren't features, 641 features per king square with a bias slot
+  kHalfKP = 0,
+  // kings are features too, 768 features per king square
+  kHalfKA,
+};
+
+constexpr std::size_t kHalfKPDimensions = 64 * 641;
+constexpr std::size_t kHalfKADimensions = 64 * 768;
+
+/**
+ * @brief Maximal number of active features of one perspective.
+ */
+constexpr std::size_t kNnueMaxActive = 32;
+
+/**
+ * @brief Returns the index of a feature, squares use the a1 = 0 numbering of
+ * the usual trainers.
+ *
+ * The white perspective sees the board as it is, black sees it rotated; the
+ * figure index counts own and enemy figures alternately, pawn first. HalfKP
+ * leaves slot 0 of every king square unused, as the original networks do.
+ * Kings of HalfKP have no feature; the result is meaningless for them.
+ */
+constexpr uint32_t nnueFeature(NnueFeatureSet set,
+                               Color perspective,
+                               Position king,
+                               Figure figure,
+                               Position square) noexcept
+{
+  // Position counts from a8, the trainers from a1
+  const bool white = perspective == Color::kWhite;
+  const auto orient = [white](Position position)
+  { return static_cast<uint32_t>(position.index() ^ (white ? 56U : 7U)); };
+  const auto value = static_cast<int8_t>(figure);
+  const auto type = static_cast<uint32_t>(value > 0 ? value : -value) - 1;
+  const uint32_t enemy = (value > 0) == white ? 0 : 1;
+  const uint32_t piece = (type * 2) + enemy;
+  if (set == NnueFeatureSet::kHalfKP) {
+    return (orient(king) * 641) + 1 + (piece * 64) + orient(square);
+  }
+  return (orient(king) * 768) + (piece * 64) + orient(square);
+}
+
+/**
+ * @brief Writes the active features of the perspective into `out`.
+ * @return Number of written features, at most `out.size()`; zero without a
+ * king of the perspective.
+ */
+BITBOARD_EXPORT std::size_t nnueFeatures(const BitBoard& board,
+                                         Color perspective,
+                                         NnueFeatureSet set,
+                                         std::span<uint32_t> out) noexcept;
+
+/**
+ * @brief Features that a turn adds and removes, per perspective (white
+ * first).
+ *
+ * A perspective whose king moves needs a refresh, all its features change;
+ * its lists stay empty then.
+ */
+struct NnueDelta
+{
+  static constexpr std::size_t kMaxChanges = 2;
+
+  uint32_t added[2][kMaxChanges] = {};
+  uint32_t removed[2][kMaxChanges] = {};
+  uint8_t added_count[2] = {};
+  uint8_t removed_count[2] = {};
+  bool refresh[2] = {};
+};
+
+/**
+ * @brief Computes the feature changes of a legal turn of the side to move,
+ * from the board before the turn. Turns of unknown kind change nothing.
+ */
+BITBOARD_EXPORT NnueDelta nnueDelta(const BitBoard& board,
+                                    Turn turn,
+                                    NnueFeatureSet set) noexcept;
+
+}  // namespace bitboard
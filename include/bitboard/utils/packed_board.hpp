@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <bitboard/bitboard_export.hpp>
+
+namespace bitboard
+{
+
+class BitBoard;
+
+/**
+ * @brief Fixed size binary encoding of a board, 32 bytes.
+ *
+ * Layout (multi-byte values are little-endian):
+ *  - bytes 0..7   occupancy bitboard;
+ *  - bytes 8..23  4-bit codes of the occupied squares in the order of the
+ *                 occupancy bits, low nibble first (white pawn..king 0..5,
+ *                 black pawn..king 6..11);
+ *  - byte 24      bit 0 black to move, bits 1..4 castling KQkq;
+ *  - byte 25      el passant square or 64 if there is none;
+ *  - bytes 26..27 halfmove clock;
+ *  - bytes 28..29 fullmove number;
+ *  - bytes 30..31 zero.
+ *
+ * Only boards with at most 32 figures can be packed.
+ */
+struct PackedBoard
+{
+  uint8_t data[32];
+
+  bool operator==(const PackedBoard& other) const = default;
+};
+
+static_assert(sizeof(PackedBoard) == 32, "PackedBoard must be 32 bytes!");
+
+/**
+ * @brief Maximal length of the variable size encoding.
+ */
+constexpr std::size_t kPackedBoardMaxLength = 48;
+
+/**
+ * @brief Packs the board into the fixed size encoding.
+ * @return False if the board has more than 32 figures.
+ */
+BITBOARD_EXPORT bool packBoard(const BitBoard& board,
+                               PackedBoard& packed) noexcept;
+
+/**
+ * @brief Unpacks the fixed size encoding.
+ * @return False if the data is corrupted, the board is left unchanged then.
+ */
+BITBOARD_EXPORT bool unpackBoard(const PackedBoard& packed,
+                                 BitBoard& board) noexcept;
+
+/**
+ * @brief Packs the board into the variable size encoding.
+ *
+ * The layout is the occupancy bitboard, one nibble per occupied square (the
+ * last byte is padded with zero), the side/castling byte, the el passant byte
+ * and both counters as LEB128 varints. `out` must have room for
+ * kPackedBoardMaxLength bytes.
+ *
+ * @return Number of written bytes.
+ */
+BITBOARD_EXPORT std::size_t packBoard(const BitBoard& board,
+                                      uint8_t* out) noexcept;
+
+/**
+ * @brief Unpacks one board in the variable size encoding from the front of
+ * `data`.
+ * @return Number of consumed bytes or zero if the data is truncated or
+ * corrupted, the board is left unchanged then.
+ */
+BITBOARD_EXPORT std::size_t unpackBoard(std::span<const uint8_t> data,
+                                        BitBoard& board) noexcept;
+
+/**
+ * @brief Packs `boards` into `packed`, which must be at least as long.
+ * @return Number of packed boards; stops at the first board that can't be
+ * packed.
+ */
+BITBOARD_EXPORT std::size_t packBoards(std::span<const BitBoard> boards,
+                                       std::span<PackedBoard> packed) noexcept;
+
+/**
+ * @brief Unpacks `packed` into `boards`, which must be at least as long.
+ * @return Number of unpacked boards; stops at the first corrupted entry.
+ */
+BITBOARD_EXPORT std::size_t unpackBoards(std::span<const PackedBoard> packed,
+                                         std::span<BitBoard> boards) noexcept;
+
+}  // namespace bitboard
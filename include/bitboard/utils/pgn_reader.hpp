@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <bitboard/bitboard.hpp>
+#include <bitboard/bitboard_export.hpp>
+#include <bitboard/turn.hpp>
+
+namespace bitboard
+{
+
+/**
+ * @brief Default size of the part of the file handled by one worker at once.
+ */
+constexpr std::size_t kPgnChunkSize = std::size_t {1} << 20U;
+
+/**
+ * @brief Result of replaying the moves of a game.
+ */
+enum struct PgnStatus : uint8_t
+{
+  kPgnOk = 0,
+  kPgnInvalidFen,  // the FEN tag can't be parsed
+  kPgnInvalidMove,  // a move can't be decoded in the current position
+  kPgnIllegalMove,  // a move leaves the own king attacked
+};
+
+/**
+ * @brief A game read from a PGN file.
+ *
+ * Views point into the text of the file, `turns` into a buffer of the worker;
+ * both are valid only during the callback.
+ */
+struct BITBOARD_EXPORT PgnGame
+{
+  /**
+   * @brief Returns the value of the tag pair without quotes or an empty view.
+   */
+  [[nodiscard]] std::string_view tag(std::string_view name) const noexcept;
+
+  std::string_view tags;  // the tag pair section
+  std::string_view result;  // the game termination marker, empty if missing
+  BitBoard start;  // the initial position, empty if the FEN tag is invalid
+  BitBoard board;  // the position after the last decoded turn
+  std::span<const Turn> turns;  // turns replayed until the first error
+  PgnStatus status = PgnStatus::kPgnOk;
+};
+
+/**
+ * @brief Reads one game from `text` into `game`, decoding the movetext with
+ * turnFromSan.
+ *
+ * Comments, variations, numeric annotation glyphs and move numbers are
+ * skipped. Decoding stops at the first move that fails. `turns` is cleared
+ * and reused as the storage of game.turns, so a caller reading many games
+ * allocates only while the buffer grows.
+ *
+ * @return Status of the game, also stored in game.status.
+ */
+BITBOARD_EXPORT PgnStatus readPgnGame(std::string_view text,
+                                      PgnGame& game,
+                                      std::vector<Turn>& turns);
+
+/**
+ * @brief Reads PGN files through a memory mapping.
+ *
+ * The mapped file is split into chunks of about `chunk_size` bytes, every
+ * chunk is extended to the start of the game that follows it, so games are
+ * never cut. Chunks are decoded in parallel and games are replayed on a
+ * BitBoard of the worker.
+ */
+class BITBOARD_EXPORT PgnReader
+{
+public:
+  /**
+   * @brief Receives a game and the index of the chunk it comes from.
+   */
+  using Callback = std::function<void(const PgnGame& game, std::size_t chunk)>;
+
+  /**
+   * @brief Maps the file; check valid() for the result.
+   * @param path Path of the file.
+   */
+  explicit PgnReader(const char* path);
+
+  /**
+   * @brief Wraps already loaded text, the data must outlive the reader.
+   * @param data Text of the games.
+   */
+  explicit PgnReader(std::string_view data) noexcept;
+
+  PgnReader(const PgnReader&) = delete;
+  PgnReader(PgnReader&&) = delete;
+  PgnReader& operator=(const PgnReader&) = delete;
+  PgnReader& operator=(PgnReader&&) = delete;
+
+  ~PgnReader();
+
+  /**
+   * @brief Checks whether the file was opened and mapped.
+   */
+  [[nodiscard]] bool valid() const noexcept;
+
+  /**
+   * @brief Returns the whole text of the file.
+   */
+  [[nodiscard]] std::string_view data() const noexcept;
+
+  /**
+   * @brief Reads the games and passes them to `callback`.
+   *
+   * In ordered mode games arrive in file order and the callback is never
+   * called concurrently. In unordered mode games arrive as soon as they are
+   * ready and the callback must be thread safe.
+   *
+   * @param callback Receives the games.
+   * @param threads Number of workers, zero means hardware concurrency.
+   * @param ordered Whether to keep the order of the file.
+   * @param chunk_size Size of the chunk handled by a worker at once.
+   * @return Number of read games.
+   */
+  std::size_t read(const Callback& callback,
+                   unsigned threads = 0,
+                   bool ordered = true,
+                   std::size_t chunk_size = kPgnChunkSize) const;
+
+private:
+  std::string_view m_data;
+  void* m_mapping = nullptr;
+  std::size_t m_mapping_size = 0;
+  bool m_valid = false;
+};
+
+}  // namespace bitboard
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <bitboard/bitboard_export.hpp>
+#include <bitboard/color.hpp>
+#include <bitboard/turn.hpp>
+
+namespace bitboard
+{
+
+class BitBoard;
+
+/**
+ * @brief Move encodings of neural network policy heads.
+ *
+ * Both see the board from the side to move: black turns are mirrored
+ * vertically first, so its pawns move up the board like white ones.
+ */
+enum struct PolicyEncoding : uint8_t
+{
+  // [73][8][8] planes from the from-square, a8 first: 56 queen moves (north,
+  // north-east .. north-west, distance 1 to 7 each), 8 knight jumps and 9
+  // underpromotions (knight, bishop, rook; each capturing to the left,
+  // straight, capturing to the right); a pawn's queen move to the last rank
+  // promotes to a queen
+  kAlphaZero = 0,
+  // the 1858 moves of Leela Chess Zero: every queen and knight move by
+  // from-square then to-square with a1 = 0, then the promotions to queen,
+  // rook and bishop; a pawn's plain move to the last rank promotes to a
+  // knight
+  kCompact,
+};
+
+constexpr std::size_t kAlphaZeroPolicySize = 73 * 64;
+constexpr std::size_t kCompactPolicySize = 1858;
+
+/**
+ * @brief Index of turns that the encoding can't express.
+ */
+constexpr uint16_t kNoPolicyIndex = 0xFFFF;
+
+/**
+ * @brief Returns the number of indices of the encoding.
+ */
+constexpr std::size_t policySize(PolicyEncoding encoding) noexcept
+{
+  return encoding == PolicyEncoding::kAlphaZero ? kAlphaZeroPolicySize
+                                                : kCompactPolicySize;
+}
+
+/**
+ * @brief Returns the number of 64 bit words of a legal turn mask.
+ */
+constexpr std::size_t policyWords(PolicyEncoding encoding) noexcept
+{
+  return (policySize(encoding) + 63) / 64;
+}
+
+/**
+ * @brief Returns the index of a turn of `side`, kNoPolicyIndex for turns no
+ * figure can make. Castling is the two square move of the king.
+ */
+BITBOARD_EXPORT uint16_t policyIndex(PolicyEncoding encoding,
+                                     Color side,
+                                     Turn turn) noexcept;
+
+/**
+ * @brief Writes the indices of the turns of `side` into `out`, at most
+ * `out.size()` of them.
+ */
+BITBOARD_EXPORT void policyIndices(PolicyEncoding encoding,
+                                   Color side,
+                                   std::span<const Turn> turns,
+                                   std::span<uint16_t> out) noexcept;
+
+/**
+ * @brief Returns the turn of an index for the side to move of the board,
+ * the board tells whether a plain move promotes a pawn. Out of range
+ * indices and moves off the board give an invalid Turn; the turn isn't
+ * checked for legality.
+ */
+BITBOARD_EXPORT Turn policyTurn(const BitBoard& board,
+                                PolicyEncoding encoding,
+                                uint16_t index) noexcept;
+
+/**
+ * @brief Writes the legal turns of the board as a dense bitset, bit `i % 64`
+ * of word `i / 64` for index `i`. The words of the encoding are cleared
+ * first, policyWords(); bits beyond `mask` are dropped.
+ * @return Number of legal turns.
+ */
+BITBOARD_EXPORT std::size_t policyMask(const BitBoard& board,
+                                       PolicyEncoding encoding,
+                                       std::span<uint64_t> mask) noexcept;
+
+}  // namespace bitboard
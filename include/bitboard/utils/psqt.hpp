@@ -0,0 +1,251 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <bitboard/bitboard.hpp>
+#include <bitboard/figure.hpp>
+#include <bitboard/position.hpp>
+#include <bitboard/turn.hpp>
+#include <bitboard/utils/bit_utils.hpp>
+#include <bitboard/utils/turn_changes.hpp>
+
+namespace bitboard
+{
+
+/**
+ * @brief Material and piece-square sums of a position, white minus black.
+ */
+struct PsqtScore
+{
+  int32_t material = 0;
+  int32_t midgame = 0;
+  int32_t endgame = 0;
+
+  bool operator==(const PsqtScore& other) const = default;
+};
+
+/**
+ * @brief Tables of the simplified evaluation function: figureValue for the
+ * material and one piece-square table per figure; the king has its own
+ * endgame table.
+ *
+ * Any type with the same static members can be passed to PsqtBoard:
+ * kMaterial per figure pawn to king, kMidgame and kEndgame indexed by the
+ * figure and the Position index as seen by white, a8 first. Black reads
+ * the tables mirrored.
+ */
+struct SimplifiedPsqt
+{
+  static constexpr std::array<int16_t, 6> kMaterial = {
+      figureValue(Figure::kPawn),
+      figureValue(Figure::kKnight),
+      figureValue(Figure::kBishop),
+      figureValue(Figure::kRook),
+      figureValue(Figure::kQueen),
+      figureValue(Figure::kKing),
+  };
+
+  // clang-format off
+  static constexpr std::array<int16_t, 64> kPawn = {
+        0,   0,   0,   0,   0,   0,   0,   0,
+       50,  50,  50,  50,  50,  50,  50,  50,
+       10,  10,  20,  30,  30,  20,  10,  10,
+        5,   5,  10,  25,  25,  10,   5,   5,
+        0,   0,   0,  20,  20,   0,   0,   0,
+        5,  -5, -10,   0,   0, -10,  -5,   5,
+        5,  10,  10, -20, -20,  10,  10,   5,
+        0,   0,   0,   0,   0,   0,   0,   0,
+  };
+
+  static constexpr std::array<int16_t, 64> kKnight = {
+      -50, -40, -30, -30, -30, -30, -40, -50,
+      -40, -20,   0,   0,   0,   0, -20, -40,
+      -30,   0,  10,  15,  15,  10,   0, -30,
+      -30,   5,  15,  20,  20,  15,   5, -30,
+      -30,   0,  15,  20,  20,  15,   0, -30,
+      -30,   5,  10,  15,  15,  10,   5, -30,
+      -40, -20,   0,   5,   5,   0, -20, -40,
+      -50, -40, -30, -30, -30, -30, -40, -50,
+  };
+
+  static constexpr std::array<int16_t, 64> kBishop = {
+      -20, -10, -10, -10, -10, -10, -10, -20,
+      -10,   0,   0,   0,   0,   0,   0, -10,
+      -10,   0,   5,  10,  10,   5,   0, -10,
+      -10,   5,   5,  10,  10,   5,   5, -10,
+      -10,   0,  10,  10,  10,  10,   0, -10,
+      -10,  10,  10,  10,  10,  10,  10, -10,
+      -10,   5,   0,   0,   0,   0,   5, -10,
+      -20, -10, -10, -10, -10, -10, -10, -20,
+  };
+
+  static constexpr std::array<int16_t, 64> kRook = {
+        0,   0,   0,   0,   0,   0,   0,   0,
+        5,  10,  10,  10,  10,  10,  10,   5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+        0,   0,   0,   5,   5,   0,   0,   0,
+  };
+
+  static constexpr std::array<int16_t, 64> kQueen = {
+      -20, -10, -10,  -5,  -5, -10, -10, -20,
+      -10,   0,   0,   0,   0,   0,   0, -10,
+      -10,   0,   5,   5,   5,   5,   0, -10,
+       -5,   0,   5,   5,   5,   5,   0,  -5,
+        0,   0,   5,   5,   5,   5,   0,  -5,
+      -10,   5,   5,   5,   5,   5,   0, -10,
+      -10,   0,   5,   0,   0,   0,   0, -10,
+      -20, -10, -10,  -5,  -5, -10, -10, -20,
+  };
+
+  static constexpr std::array<int16_t, 64> kKingMidgame = {
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -20, -30, -30, -40, -40, -30, -30, -20,
+      -10, -20, -20, -20, -20, -20, -20, -10,
+       20,  20,   0,   0,   0,   0,  20,  20,
+       20,  30,  10,   0,   0,  10,  30,  20,
+  };
+
+  static constexpr std::array<int16_t, 64> kKingEndgame = {
+      -50, -40, -30, -20, -20, -30, -40, -50,
+      -30, -20, -10,   0,   0, -10, -20, -30,
+      -30, -10,  20,  30,  30,  20, -10, -30,
+      -30, -10,  30,  40,  40,  30, -10, -30,
+      -30, -10,  30,  40,  40,  30, -10, -30,
+      -30, -10,  20,  30,  30,  20, -10, -30,
+      -30, -30,   0,   0,   0,   0, -30, -30,
+      -50, -30, -30, -30, -30, -30, -30, -50,
+  };
+  // clang-format on
+
+  static constexpr std::array<std::array<int16_t, 64>, 6> kMidgame = {
+      kPawn, kKnight, kBishop, kRook, kQueen, kKingMidgame};
+  static constexpr std::array<std::array<int16_t, 64>, 6> kEndgame = {
+      kPawn, kKnight, kBishop, kRook, kQueen, kKingEndgame};
+};
+
+/**
+ * @brief A BitBoard with material and piece-square sums kept up to date.
+ *
+ * The tables come in as the template parameter, see SimplifiedPsqt, so the
+ * lookups are constants and boards without the accumulator pay nothing.
+ * set(), swap() and executeTurn() adjust the sums by the figures that
+ * change instead of walking the twelve bitboards; the board itself is only
+ * reachable read-only, so the sums can't fall behind it.
+ */
+template<typename Tables>
+class PsqtBoard
+{
+public:
+  PsqtBoard() = default;
+
+  explicit PsqtBoard(const BitBoard& board)
+      : m_board(board)
+      , m_score(evaluate(board))
+  {
+  }
+
+  /**
+   * @brief Constructs the board from a FEN line, see BitBoard.
+   */
+  explicit PsqtBoard(std::string_view fen_line)
+      : PsqtBoard(BitBoard(fen_line))
+  {
+  }
+
+  [[nodiscard]] const BitBoard& board() const noexcept { return m_board; }
+
+  [[nodiscard]] const PsqtScore& score() const noexcept { return m_score; }
+
+  void set(Position position, Figure figure)
+  {
+    update(m_board.get(position), position, -1);
+    update(figure, position, 1);
+    m_board.set(position, figure);
+  }
+
+  void swap(Position pos_1, Position pos_2)
+  {
+    const Figure figure_1 = m_board.get(pos_1);
+    const Figure figure_2 = m_board.get(pos_2);
+    set(pos_2, figure_1);
+    set(pos_1, figure_2);
+  }
+
+  /**
+   * @brief Makes the turn like BitBoard::executeTurn, the sums follow the
+   * moved, captured and promoted figures.
+   */
+  void executeTurn(Turn turn)
+  {
+    turn = m_board.classify(turn);
+    FigureChange changes[kTurnMaxChanges];
+    const std::size_t count = m_board.turnChanges(turn, changes);
+    for (std::size_t i = 0; i < count; ++i) {
+      update(changes[i].figure, changes[i].position, changes[i].count);
+    }
+    m_board.executeTurn(turn);
+  }
+
+  /**
+   * @brief Computes the sums of the board from scratch.
+   */
+  [[nodiscard]] static PsqtScore evaluate(const BitBoard& board) noexcept
+  {
+    PsqtScore result;
+    for (int8_t type = 1; type <= 6; ++type) {
+      for (const int8_t sign : {int8_t {1}, int8_t {-1}}) {
+        const auto figure = static_cast<Figure>(type * sign);
+        bitboard_field pieces = board.pieces(figure);
+        for (bitboard_field bit = takeBit(pieces); bit; bit = takeBit(pieces))
+        {
+          add(result,
+              figure,
+              Position(static_cast<uint8_t>(log2_64(bit))),
+              1);
+        }
+      }
+    }
+    return result;
+  }
+
+private:
+  static void add(PsqtScore& score,
+                  Figure figure,
+                  Position position,
+                  int32_t count) noexcept
+  {
+    const auto value = static_cast<int8_t>(figure);
+    if (value == 0) {
+      return;
+    }
+    // black reads the tables from its side of the board
+    const int32_t sign = value > 0 ? count : -count;
+    const auto type =
+        static_cast<std::size_t>((value > 0 ? value : -value) - 1);
+    const std::size_t square =
+        value > 0 ? position.index() : position.index() ^ 56U;
+    score.material += sign * Tables::kMaterial[type];
+    score.midgame += sign * Tables::kMidgame[type][square];
+    score.endgame += sign * Tables::kEndgame[type][square];
+  }
+
+  void update(Figure figure, Position position, int32_t count) noexcept
+  {
+    add(m_score, figure, position, count);
+  }
+
+  BitBoard m_board;
+  PsqtScore m_score;
+};
+
+}  // namespace bitboard
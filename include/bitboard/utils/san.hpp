@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include <bitboard/bitboard_export.hpp>
+#include <bitboard/turn.hpp>
+
+namespace bitboard
+{
+
+class BitBoard;
+
+/**
+ * @brief Maximal length of a move written by turnToSan (`Qa1xb2#`), without
+ * the terminating zero.
+ */
+constexpr std::size_t kSanMaxLength = 7;
+
+/**
+ * @brief Decodes a move in standard algebraic notation (`Nbd7`, `exd8=Q+`,
+ * `O-O-O`) made by the side to move.
+ *
+ * The candidates are taken from the attack masks of the target square and
+ * filtered by the disambiguation, so no move list is generated. Legality is
+ * tested only when more than one candidate is left; a single candidate is
+ * trusted, callers replaying untrusted games should check the king after
+ * making the turn. Castling is always tested in full, the rook, the path
+ * and the squares of the king, as the king check afterwards can't see them.
+ * Check, mate and annotation suffixes are ignored, castling may use either
+ * `O` or `0`.
+ *
+ * @return The turn or an invalid Turn if the text is malformed, matches no
+ * figure or stays ambiguous.
+ */
+BITBOARD_EXPORT Turn turnFromSan(const BitBoard& board,
+                                 std::string_view san) noexcept;
+
+/**
+ * @brief Writes the turn of the side to move in standard algebraic notation
+ * into `out`.
+ *
+ * The turn is expected to be legal. Disambiguation comes from the attack
+ * masks of the target square, limited to figures that aren't pinned. A `+`
+ * or `#` suffix is added by making the turn on a copy; only a check triggers
+ * the search for a reply. `out` must have room for kSanMaxLength characters;
+ * no terminating zero is written.
+ *
+ * @return Number of written characters, zero if there is no figure of the
+ * side to move on the start square.
+ */
+BITBOARD_EXPORT std::size_t turnToSan(const BitBoard& board,
+                                      Turn turn,
+                                      char* out) noexcept;
+
+}  // namespace bitboard
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <bitboard/bitboard_export.hpp>
+
+namespace bitboard
+{
+
+class BitBoard;
+
+/**
+ * @brief Planes of one board in the tensor: white pawn to king, black pawn
+ * to king, the side to move, four castling rights (white king side, white
+ * queen side, black king side, black queen side) and the el passant target.
+ *
+ * The side plane is all ones when black is to move, the castling planes are
+ * all ones while the right is kept.
+ */
+constexpr std::size_t kTensorPlanes = 18;
+constexpr std::size_t kTensorSidePlane = 12;
+constexpr std::size_t kTensorCastlingPlane = 13;
+constexpr std::size_t kTensorElPassantPlane = 17;
+
+/**
+ * @brief Values per board, [kTensorPlanes][8][8] with the squares in Position
+ * order, a8 first.
+ */
+constexpr std::size_t kTensorBoardSize = kTensorPlanes * 64;
+
+/**
+ * @brief Writes the boards as dense [N][18][8][8] zeros and ones into `out`,
+ * which holds at least boards.size() * kTensorBoardSize values.
+ *
+ * The bits are expanded by the widest kernel of the running CPU.
+ */
+BITBOARD_EXPORT void boardsToTensor(std::span<const BitBoard> boards,
+                                    uint8_t* out) noexcept;
+
+BITBOARD_EXPORT void boardsToTensor(std::span<const BitBoard> boards,
+                                    float* out) noexcept;
+
+}  // namespace bitboard
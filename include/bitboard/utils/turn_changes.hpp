@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <bitboard/figure.hpp>
+#include <bitboard/position.hpp>
+
+namespace bitboard
+{
+
+/**
+ * @brief Maximal number of figure changes of a turn, reached by castling.
+ */
+constexpr std::size_t kTurnMaxChanges = 4;
+
+/**
+ * @brief A figure that a turn puts on (+1) or takes from (-1) a square, see
+ * BitBoard::turnChanges().
+ */
+struct FigureChange
+{
+  Figure figure = Figure::kEmpty;
+  Position position;
+  int8_t count = 0;
+};
+
+}  // namespace bitboard
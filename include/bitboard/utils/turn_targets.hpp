@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+
+#include <bitboard/utils/bit_const.hpp>
+#include <bitboard/utils/bit_utils.hpp>
+
+namespace bitboard
+{
+
+/**
+ * @brief Legal turns of the side to move as target squares per from-square,
+ * see BitBoard::getTargets().
+ */
+struct TurnTargets
+{
+  // legal to-squares by the Position index of the from-square; castling is
+  // the king's two square step
+  bitboard_field targets[64] = {};
+  // from-squares of the pawns with targets that promote, every target stands
+  // for four turns, one per figure
+  bitboard_field promotions = 0;
+
+  /**
+   * @brief Returns the number of legal turns, as getTurns() would write.
+   */
+  [[nodiscard]] std::size_t count() const noexcept
+  {
+    // most squares hold no figure of the side to move
+    std::size_t result = 0;
+    for (const bitboard_field squares : targets) {
+      if (squares != 0) {
+        result += static_cast<std::size_t>(popCount(squares));
+      }
+    }
+    bitboard_field pawns = promotions;
+    for (bitboard_field bit = takeBit(pawns); bit; bit = takeBit(pawns)) {
+      result += 3 * static_cast<std::size_t>(popCount(targets[log2_64(bit)]));
+    }
+    return result;
+  }
+
+  bool operator==(const TurnTargets& other) const = default;
+};
+
+}  // namespace bitboard
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include <bitboard/bitboard_export.hpp>
+#include <bitboard/turn.hpp>
+
+namespace bitboard
+{
+
+class BitBoard;
+
+/**
+ * @brief Result of parsing a UCI move list or position command.
+ */
+enum struct UciStatus : uint8_t
+{
+  kUciOk = 0,
+  kUciInvalidPosition,  // neither `startpos` nor a valid `fen ...`
+  kUciInvalidTurn,  // a token of the move list isn't a move
+  kUciTooManyTurns,  // the output span is full
+};
+
+/**
+ * @brief Parses whitespace separated moves in UCI notation into `turns`.
+ *
+ * Parsing stops at the first token that isn't a move or when `turns` is
+ * full; `count` receives the number of stored turns in every case. Doesn't
+ * allocate or throw.
+ */
+BITBOARD_EXPORT UciStatus turnsFromUci(std::string_view moves,
+                                       std::span<Turn> turns,
+                                       std::size_t& count) noexcept;
+
+/**
+ * @brief Parses a `position startpos|fen <fen> [moves ...]` command, the
+ * leading `position` is optional.
+ *
+ * `board` receives the position before the moves, `turns` and `count` the
+ * moves as with turnsFromUci. On an invalid position the board is left
+ * unchanged and no moves are read.
+ */
+BITBOARD_EXPORT UciStatus positionFromUci(std::string_view command,
+                                          BitBoard& board,
+                                          std::span<Turn> turns,
+                                          std::size_t& count) noexcept;
+
+/**
+ * @brief Writes the turns in UCI notation separated by spaces into `out`.
+ *
+ * `out` must have room for `turns.size() * (kTurnMaxLength + 1)` characters;
+ * no terminating zero is written.
+ *
+ * @return Number of written characters.
+ */
+BITBOARD_EXPORT std::size_t turnsToUci(std::span<const Turn> turns,
+                                       char* out) noexcept;
+
+}  // namespace bitboard
@@ -0,0 +1,587 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "bitboard/utils/bit_const.hpp"
+#include "bitboard/utils/bit_intrinsics.hpp"
+#include "kernels.hpp"
+
+// The positions of a block live in the lanes of one vector. With the GNU
+// vector extension a step is one AVX-512 instruction, two AVX2 ones or a few
+// SSE2 ones, whatever the kernel is compiled for; other compilers get plain
+// loops over the lanes. No kernel reads a table, so lanes never branch.
+
+namespace bitboard
+{
+
+#if defined(__GNUC__)
+
+// the kernels are inlined into the wrappers of every level, no vector ever
+// crosses a call
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wpsabi"
+
+using Lanes = bitboard_field
+    __attribute__((vector_size(kBatchLanes * sizeof(bitboard_field))));
+
+BITBOARD_KERNEL_BODY Lanes splat(bitboard_field value) noexcept
+{
+  return Lanes {} + value;
+}
+
+// all ones in the lanes that aren't zero
+BITBOARD_KERNEL_BODY Lanes nonZero(Lanes value) noexcept
+{
+  return reinterpret_cast<Lanes>(value != 0);
+}
+
+#else
+
+struct Lanes
+{
+  bitboard_field& operator[](std::size_t index) noexcept
+  {
+    return lanes[index];
+  }
+
+  bitboard_field operator[](std::size_t index) const noexcept
+  {
+    return lanes[index];
+  }
+
+  bitboard_field lanes[kBatchLanes];
+};
+
+template<typename Operation>
+inline Lanes lanewise(Lanes left, Lanes right, Operation operation) noexcept
+{
+  Lanes result;
+  for (std::size_t i = 0; i < kBatchLanes; ++i) {
+    result[i] = operation(left[i], right[i]);
+  }
+  return result;
+}
+
+inline Lanes operator&(Lanes left, Lanes right) noexcept
+{
+  return lanewise(left, right, [](auto a, auto b) { return a & b; });
+}
+
+inline Lanes operator|(Lanes left, Lanes right) noexcept
+{
+  return lanewise(left, right, [](auto a, auto b) { return a | b; });
+}
+
+inline Lanes operator^(Lanes left, Lanes right) noexcept
+{
+  return lanewise(left, right, [](auto a, auto b) { return a ^ b; });
+}
+
+inline Lanes operator+(Lanes left, Lanes right) noexcept
+{
+  return lanewise(left, right, [](auto a, auto b) { return a + b; });
+}
+
+inline Lanes operator-(Lanes left, Lanes right) noexcept
+{
+  return lanewise(left, right, [](auto a, auto b) { return a - b; });
+}
+
+inline Lanes operator~(Lanes value) noexcept
+{
+  return lanewise(value, value, [](auto a, auto) { return ~a; });
+}
+
+inline Lanes operator<<(Lanes value, int shift) noexcept
+{
+  return lanewise(value, value, [shift](auto a, auto) { return a << shift; });
+}
+
+inline Lanes operator>>(Lanes value, int shift) noexcept
+{
+  return lanewise(value, value, [shift](auto a, auto) { return a >> shift; });
+}
+
+inline Lanes& operator|=(Lanes& left, Lanes right) noexcept
+{
+  return left = left | right;
+}
+
+inline Lanes& operator&=(Lanes& left, Lanes right) noexcept
+{
+  return left = left & right;
+}
+
+inline Lanes& operator+=(Lanes& left, Lanes right) noexcept
+{
+  return left = left + right;
+}
+
+inline Lanes splat(bitboard_field value) noexcept
+{
+  Lanes result;
+  for (auto& lane : result.lanes) {
+    lane = value;
+  }
+  return result;
+}
+
+inline Lanes nonZero(Lanes value) noexcept
+{
+  return lanewise(value,
+                  value,
+                  [](auto a, auto)
+                  { return a != 0 ? ~bitboard_field {0} : 0; });
+}
+
+#endif
+
+BITBOARD_KERNEL_BODY Lanes isZero(Lanes value) noexcept
+{
+  return ~nonZero(value);
+}
+
+BITBOARD_KERNEL_BODY Lanes select(Lanes mask, Lanes yes, Lanes no) noexcept
+{
+  return (mask & yes) | (~mask & no);
+}
+
+BITBOARD_KERNEL_BODY bool any(Lanes value) noexcept
+{
+  bitboard_field result = 0;
+  for (std::size_t i = 0; i < kBatchLanes; ++i) {
+    result |= value[i];
+  }
+  return result != 0;
+}
+
+BITBOARD_KERNEL_BODY Lanes loadPlane(const bitboard_field* block,
+                                     std::size_t plane) noexcept
+{
+  Lanes result;
+  std::memcpy(&result, block + (plane * kBatchLanes), sizeof(result));
+  return result;
+}
+
+// Mirrors the boards of the lanes between the ranks.
+BITBOARD_KERNEL_BODY Lanes swapLanes(Lanes value) noexcept
+{
+  Lanes result;
+  for (std::size_t i = 0; i < kBatchLanes; ++i) {
+    result[i] = byteSwap(value[i]);
+  }
+  return result;
+}
+
+// Number of set bits of every lane, without popcnt on any level.
+BITBOARD_KERNEL_BODY Lanes countLanes(Lanes value) noexcept
+{
+  value = value - ((value >> 1) & splat(0x5555555555555555ULL));
+  value = (value & splat(0x3333333333333333ULL))
+      + ((value >> 2) & splat(0x3333333333333333ULL));
+  value = (value + (value >> 4)) & splat(0x0F0F0F0F0F0F0F0FULL);
+  value = value + (value >> 8);
+  value = value + (value >> 16);
+  value = value + (value >> 32);
+  return value & splat(0x7F);
+}
+
+// Moves the squares by kShift indices, positive towards rank 1, dropping the
+// ones that wrap around the board.
+template<int kShift>
+BITBOARD_KERNEL_BODY Lanes stepLanes(Lanes value) noexcept
+{
+  constexpr int kFile = ((kShift % 8) + 8 + 4) % 8 - 4;  // -2 .. 2
+  constexpr bitboard_field kWrap = kFile == 1 ? ~row_a
+      : kFile == 2                            ? ~(row_a | row_b)
+      : kFile == -1                           ? ~row_h
+      : kFile == -2                           ? ~(row_g | row_h)
+                                              : ~bitboard_field {0};
+  if constexpr (kShift > 0) {
+    return (value << kShift) & splat(kWrap);
+  } else {
+    return (value >> -kShift) & splat(kWrap);
+  }
+}
+
+// Directions of the sliders as index steps.
+constexpr int kNorth = -8;
+constexpr int kSouth = 8;
+constexpr int kEast = 1;
+constexpr int kWest = -1;
+constexpr int kNorthEast = -7;
+constexpr int kNorthWest = -9;
+constexpr int kSouthEast = 9;
+constexpr int kSouthWest = 7;
+
+// Occluded Kogge-Stone fill: the attacks of the sliders in one direction up
+// to and including the first blocker.
+template<int kStep>
+BITBOARD_KERNEL_BODY Lanes slideLanes(Lanes sliders, Lanes empty) noexcept
+{
+  // a shift that wraps drops the square, so the empty squares carry the
+  // wrap mask of the direction through every doubling
+  Lanes propagate = empty & stepLanes<kStep>(splat(~bitboard_field {0}));
+  sliders |= propagate & stepLanes<kStep>(sliders);
+  propagate &= stepLanes<kStep>(propagate);
+  sliders |= propagate & stepLanes<2 * kStep>(sliders);
+  propagate &= stepLanes<2 * kStep>(propagate);
+  sliders |= propagate & stepLanes<4 * kStep>(sliders);
+  return stepLanes<kStep>(sliders);
+}
+
+BITBOARD_KERNEL_BODY Lanes knightLanes(Lanes knights) noexcept
+{
+  return stepLanes<17>(knights) | stepLanes<15>(knights)
+      | stepLanes<10>(knights) | stepLanes<6>(knights)
+      | stepLanes<-17>(knights) | stepLanes<-15>(knights)
+      | stepLanes<-10>(knights) | stepLanes<-6>(knights);
+}
+
+BITBOARD_KERNEL_BODY Lanes kingLanes(Lanes kings) noexcept
+{
+  return stepLanes<kNorth>(kings) | stepLanes<kSouth>(kings)
+      | stepLanes<kEast>(kings) | stepLanes<kWest>(kings)
+      | stepLanes<kNorthEast>(kings) | stepLanes<kNorthWest>(kings)
+      | stepLanes<kSouthEast>(kings) | stepLanes<kSouthWest>(kings);
+}
+
+BITBOARD_KERNEL_BODY Lanes rookLanes(Lanes rooks, Lanes empty) noexcept
+{
+  return slideLanes<kNorth>(rooks, empty) | slideLanes<kSouth>(rooks, empty)
+      | slideLanes<kEast>(rooks, empty) | slideLanes<kWest>(rooks, empty);
+}
+
+BITBOARD_KERNEL_BODY Lanes bishopLanes(Lanes bishops, Lanes empty) noexcept
+{
+  return slideLanes<kNorthEast>(bishops, empty)
+      | slideLanes<kNorthWest>(bishops, empty)
+      | slideLanes<kSouthEast>(bishops, empty)
+      | slideLanes<kSouthWest>(bishops, empty);
+}
+
+// Attack map of one color in the lanes, sliders see through the enemy king.
+BITBOARD_KERNEL_BODY Lanes attackLanes(const bitboard_field* block,
+                                       bool white) noexcept
+{
+  const std::size_t own = white ? kBatchWhitePawn : kBatchBlackPawn;
+  const std::size_t enemy = white ? kBatchBlackPawn : kBatchWhitePawn;
+
+  Lanes occupancy = splat(0);
+  for (std::size_t i = kBatchWhitePawn; i <= kBatchBlackKing; ++i) {
+    occupancy |= loadPlane(block, i);
+  }
+  const Lanes empty = ~occupancy | loadPlane(block, enemy + kBatchKing);
+  const Lanes pawns = loadPlane(block, own + kBatchPawn);
+  const Lanes queens = loadPlane(block, own + kBatchQueen);
+  return (white ? stepLanes<kNorthEast>(pawns) | stepLanes<kNorthWest>(pawns)
+                : stepLanes<kSouthEast>(pawns) | stepLanes<kSouthWest>(pawns))
+      | knightLanes(loadPlane(block, own + kBatchKnight))
+      | kingLanes(loadPlane(block, own + kBatchKing))
+      | rookLanes(loadPlane(block, own + kBatchRook) | queens, empty)
+      | bishopLanes(loadPlane(block, own + kBatchBishop) | queens, empty);
+}
+
+// A block seen from the side to move: positions with black to move are
+// mirrored, so the own pawns always go north and castle on rank 1.
+struct BatchSides
+{
+  Lanes white;  // all ones in the lanes with white to move
+  Lanes own[6];  // pawn .. king
+  Lanes enemy[6];
+  Lanes own_all;
+  Lanes enemy_all;
+  Lanes empty;
+  Lanes el_passant;
+  Lanes short_castling;
+  Lanes long_castling;
+};
+
+BITBOARD_KERNEL_BODY BatchSides orientLanes(
+    const bitboard_field* block) noexcept
+{
+  const Lanes flags = loadPlane(block, kBatchFlags);
+
+  BatchSides sides;
+  sides.white = isZero(flags & splat(1));
+  sides.own_all = splat(0);
+  sides.enemy_all = splat(0);
+  for (std::size_t i = 0; i < 6; ++i) {
+    const Lanes white = loadPlane(block, kBatchWhitePawn + i);
+    const Lanes black = loadPlane(block, kBatchBlackPawn + i);
+    sides.own[i] = select(sides.white, white, swapLanes(black));
+    sides.enemy[i] = select(sides.white, black, swapLanes(white));
+    sides.own_all |= sides.own[i];
+    sides.enemy_all |= sides.enemy[i];
+  }
+  sides.empty = ~(sides.own_all | sides.enemy_all);
+  const Lanes el_passant = loadPlane(block, kBatchElPassant);
+  sides.el_passant =
+      select(sides.white, el_passant, swapLanes(el_passant));
+  sides.short_castling = nonZero(
+      flags & select(sides.white, splat(4), splat(16)));  // kFlagsWhiteOo
+  sides.long_castling = nonZero(
+      flags & select(sides.white, splat(8), splat(32)));  // kFlagsWhiteOoo
+  return sides;
+}
+
+// Rays from the own king up to the first blocker, N S E W NE NW SE SW.
+struct BatchRays
+{
+  Lanes rays[8];
+  Lanes sliders[8];  // enemy figures that move along the ray
+};
+
+BITBOARD_KERNEL_BODY BatchRays kingRays(const BatchSides& sides) noexcept
+{
+  const Lanes king = sides.own[5];
+  const Lanes queens = sides.enemy[4];
+  const Lanes straight = sides.enemy[3] | queens;
+  const Lanes diagonal = sides.enemy[2] | queens;
+  BatchRays result;
+  result.rays[0] = slideLanes<kNorth>(king, sides.empty);
+  result.rays[1] = slideLanes<kSouth>(king, sides.empty);
+  result.rays[2] = slideLanes<kEast>(king, sides.empty);
+  result.rays[3] = slideLanes<kWest>(king, sides.empty);
+  result.rays[4] = slideLanes<kNorthEast>(king, sides.empty);
+  result.rays[5] = slideLanes<kNorthWest>(king, sides.empty);
+  result.rays[6] = slideLanes<kSouthEast>(king, sides.empty);
+  result.rays[7] = slideLanes<kSouthWest>(king, sides.empty);
+  for (std::size_t i = 0; i < 8; ++i) {
+    result.sliders[i] = i < 4 ? straight : diagonal;
+  }
+  return result;
+}
+
+// Figures checking the own king, in the oriented board.
+BITBOARD_KERNEL_BODY Lanes checkerLanes(const BatchSides& sides,
+                                        const BatchRays& rays) noexcept
+{
+  const Lanes king = sides.own[5];
+  Lanes result =
+      ((stepLanes<kNorthEast>(king) | stepLanes<kNorthWest>(king))
+       & sides.enemy[0])
+      | (knightLanes(king) & sides.enemy[1]);
+  for (std::size_t i = 0; i < 8; ++i) {
+    result |= rays.rays[i] & rays.sliders[i];
+  }
+  return result;
+}
+
+// Same as the ray of the direction index, with another set of empty squares.
+BITBOARD_KERNEL_BODY Lanes rayLanes(std::size_t direction,
+                                    Lanes king,
+                                    Lanes empty) noexcept
+{
+  switch (direction) {
+    case 0:
+      return slideLanes<kNorth>(king, empty);
+    case 1:
+      return slideLanes<kSouth>(king, empty);
+    case 2:
+      return slideLanes<kEast>(king, empty);
+    case 3:
+      return slideLanes<kWest>(king, empty);
+    case 4:
+      return slideLanes<kNorthEast>(king, empty);
+    case 5:
+      return slideLanes<kNorthWest>(king, empty);
+    case 6:
+      return slideLanes<kSouthEast>(king, empty);
+    default:
+      return slideLanes<kSouthWest>(king, empty);
+  }
+}
+
+// Turns of the pawns `pawns` that push into `push` or capture into
+// `capture`, promotions count four times.
+BITBOARD_KERNEL_BODY Lanes pawnTurnLanes(const BatchSides& sides,
+                                         Lanes pawns,
+                                         Lanes push,
+                                         Lanes capture) noexcept
+{
+  const Lanes single = stepLanes<kNorth>(pawns) & sides.empty;
+  const Lanes doubled =
+      stepLanes<kNorth>(single & splat(line_3)) & sides.empty & push;
+  const Lanes pushes = single & push;
+  const Lanes east = stepLanes<kNorthEast>(pawns) & sides.enemy_all & capture;
+  const Lanes west = stepLanes<kNorthWest>(pawns) & sides.enemy_all & capture;
+  const Lanes last = splat(line_8);
+  const Lanes promotions = countLanes(pushes & last)
+      + countLanes(east & last) + countLanes(west & last);
+  return countLanes(pushes) + countLanes(doubled) + countLanes(east)
+      + countLanes(west) + promotions + promotions + promotions;
+}
+
+// Number of legal turns of the side to move in every lane.
+BITBOARD_KERNEL_BODY Lanes countLegalLanes(const bitboard_field* block) noexcept
+{
+  const BatchSides sides = orientLanes(block);
+  const BatchRays rays = kingRays(sides);
+  const Lanes* own = sides.own;
+  const Lanes* enemy = sides.enemy;
+  const Lanes king = own[5];
+
+  // squares attacked by the enemy, the sliders look through the own king
+  const Lanes through = sides.empty | king;
+  const Lanes danger =
+      stepLanes<kSouthEast>(enemy[0]) | stepLanes<kSouthWest>(enemy[0])
+      | knightLanes(enemy[1]) | kingLanes(enemy[5])
+      | rookLanes(enemy[3] | enemy[4], through)
+      | bishopLanes(enemy[2] | enemy[4], through);
+  Lanes count = countLanes(kingLanes(king) & ~sides.own_all & ~danger);
+
+  // a single check leaves the checker and the squares towards it
+  const Lanes checkers = checkerLanes(sides, rays);
+  Lanes block_squares = checkers;
+  for (std::size_t i = 0; i < 8; ++i) {
+    block_squares |= nonZero(rays.rays[i] & rays.sliders[i]) & rays.rays[i];
+  }
+  const Lanes target = isZero(checkers)
+      | (isZero(checkers & (checkers - splat(1))) & block_squares);
+  const Lanes allowed = target & ~sides.own_all;
+
+  // a pinned figure keeps to the line from the king to the pinner
+  Lanes pinned = splat(0);
+  Lanes pin_lines[8];
+  Lanes pins[8];
+  for (std::size_t i = 0; i < 8; ++i) {
+    const Lanes first = rays.rays[i] & sides.own_all;
+    const Lanes xray = rayLanes(i, king, sides.empty | first);
+    const Lanes pin = nonZero(first) & nonZero(xray & rays.sliders[i]);
+    pins[i] = first & pin;
+    pin_lines[i] = xray & pin;
+    pinned |= pins[i];
+  }
+
+  const Lanes knights = own[1] & ~pinned;
+  count += countLanes(stepLanes<17>(knights) & allowed)
+      + countLanes(stepLanes<15>(knights) & allowed)
+      + countLanes(stepLanes<10>(knights) & allowed)
+      + countLanes(stepLanes<6>(knights) & allowed)
+      + countLanes(stepLanes<-17>(knights) & allowed)
+      + countLanes(stepLanes<-15>(knights) & allowed)
+      + countLanes(stepLanes<-10>(knights) & allowed)
+      + countLanes(stepLanes<-6>(knights) & allowed);
+
+  // per direction the rays of a set never overlap, a slider stops the ray
+  // of the one behind it
+  const Lanes straight = (own[3] | own[4]) & ~pinned;
+  const Lanes diagonal = (own[2] | own[4]) & ~pinned;
+  count += countLanes(slideLanes<kNorth>(straight, sides.empty) & allowed)
+      + countLanes(slideLanes<kSouth>(straight, sides.empty) & allowed)
+      + countLanes(slideLanes<kEast>(straight, sides.empty) & allowed)
+      + countLanes(slideLanes<kWest>(straight, sides.empty) & allowed)
+      + countLanes(slideLanes<kNorthEast>(diagonal, sides.empty) & allowed)
+      + countLanes(slideLanes<kNorthWest>(diagonal, sides.empty) & allowed)
+      + countLanes(slideLanes<kSouthEast>(diagonal, sides.empty) & allowed)
+      + countLanes(slideLanes<kSouthWest>(diagonal, sides.empty) & allowed);
+  for (std::size_t i = 0; i < 8; ++i) {
+    const Lanes movers = i < 4 ? own[3] | own[4] : own[2] | own[4];
+    count += nonZero(pins[i] & movers) & countLanes(pin_lines[i] & allowed);
+  }
+
+  // pawns pinned on the file only push, on a diagonal only capture
+  count += pawnTurnLanes(sides, own[0] & ~pinned, allowed, allowed);
+  if (any(pinned & own[0])) {
+    count += pawnTurnLanes(sides,
+                           own[0] & (pins[0] | pins[1]),
+                           allowed & (pin_lines[0] | pin_lines[1]),
+                           splat(0));
+    count += pawnTurnLanes(
+        sides,
+        own[0] & (pins[4] | pins[5] | pins[6] | pins[7]),
+        splat(0),
+        allowed & (pin_lines[4] | pin_lines[5] | pin_lines[6] | pin_lines[7]));
+  }
+
+  // el passant: replay the capture on the occupancy and look at the king
+  const Lanes east_capturer =
+      stepLanes<kSouthWest>(sides.el_passant) & own[0];
+  const Lanes west_capturer =
+      stepLanes<kSouthEast>(sides.el_passant) & own[0];
+  if (any(east_capturer | west_capturer)) {
+    const Lanes captured = stepLanes<kSouth>(sides.el_passant);
+    const Lanes other_checkers = checkers & (enemy[0] | enemy[1]) & ~captured;
+    for (const Lanes capturer : {east_capturer, west_capturer}) {
+      const Lanes empty =
+          (sides.empty | capturer | captured) & ~sides.el_passant;
+      Lanes attacked = other_checkers;
+      for (std::size_t i = 0; i < 8; ++i) {
+        attacked |= rayLanes(i, king, empty) & rays.sliders[i];
+      }
+      count += nonZero(capturer) & isZero(attacked) & splat(1);
+    }
+  }
+
+  // castling: the rook in the corner, the squares between empty and the
+  // king's path not attacked
+  const Lanes occupied = ~sides.empty;
+  constexpr bitboard_field kE1 = 1ULL << 60U;
+  const Lanes short_castling = sides.short_castling
+      & nonZero(king & splat(kE1)) & nonZero(own[3] & splat(1ULL << 63U))
+      & isZero(occupied & splat(3ULL << 61U))
+      & isZero(danger & splat(7ULL << 60U));
+  const Lanes long_castling = sides.long_castling
+      & nonZero(king & splat(kE1)) & nonZero(own[3] & splat(1ULL << 56U))
+      & isZero(occupied & splat(7ULL << 57U))
+      & isZero(danger & splat(7ULL << 58U));
+  count += (short_castling & splat(1)) + (long_castling & splat(1));
+  return count;
+}
+
+// Checkers of the side to move in every lane, in the board as stored.
+BITBOARD_KERNEL_BODY Lanes checkersLanes(const bitboard_field* block) noexcept
+{
+  const BatchSides sides = orientLanes(block);
+  const Lanes checkers = checkerLanes(sides, kingRays(sides));
+  return select(sides.white, checkers, swapLanes(checkers));
+}
+
+// Drivers over the blocks, writing the first `size` lanes.
+
+BITBOARD_KERNEL_BODY void batchAttacks(const bitboard_field* blocks,
+                                       std::size_t size,
+                                       bool white,
+                                       bitboard_field* out) noexcept
+{
+  for (std::size_t lane = 0; lane < size; lane += kBatchLanes) {
+    const Lanes result =
+        attackLanes(blocks + (lane * kBatchPlanes), white);
+    for (std::size_t i = 0; i < kBatchLanes && lane + i < size; ++i) {
+      out[lane + i] = result[i];
+    }
+  }
+}
+
+BITBOARD_KERNEL_BODY void batchCheckers(const bitboard_field* blocks,
+                                        std::size_t size,
+                                        bitboard_field* out) noexcept
+{
+  for (std::size_t lane = 0; lane < size; lane += kBatchLanes) {
+    const Lanes result = checkersLanes(blocks + (lane * kBatchPlanes));
+    for (std::size_t i = 0; i < kBatchLanes && lane + i < size; ++i) {
+      out[lane + i] = result[i];
+    }
+  }
+}
+
+BITBOARD_KERNEL_BODY void batchLegalCounts(const bitboard_field* blocks,
+                                           std::size_t size,
+                                           uint8_t* out) noexcept
+{
+  for (std::size_t lane = 0; lane < size; lane += kBatchLanes) {
+    const Lanes result = countLegalLanes(blocks + (lane * kBatchPlanes));
+    for (std::size_t i = 0; i < kBatchLanes && lane + i < size; ++i) {
+      out[lane + i] = static_cast<uint8_t>(result[i]);
+    }
+  }
+}
+
+#if defined(__GNUC__)
+#  pragma GCC diagnostic pop
+#endif
+
+}  // namespace bitboard
@@ -1,30 +1,1612 @@
-// #include <algorithm>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <string>
+
+#include "bitboard/bitboard.hpp"
+
+#include "bitboard/utils/bit_utils.hpp"
+#include "bitboard/utils/fen_parser.hpp"
+#include "kernels.hpp"
+#include "magic.hpp"
+
+namespace bitboard
+{
+
+namespace
+{
+
+// Castling rights kept when a turn starts or ends on the square.
+constexpr std::array<uint8_t, 64> generateCastlingKeep()
+{
+  std::array<uint8_t, 64> result {};
+  for (auto& value : result) {
+    value = 0xFF;
+  }
+  constexpr auto kWhiteOo =
+      static_cast<uint8_t>(BitBoard::Flags::kFlagsWhiteOo);
+  constexpr auto kWhiteOoo =
+      static_cast<uint8_t>(BitBoard::Flags::kFlagsWhiteOoo);
+  constexpr auto kBlackOo =
+      static_cast<uint8_t>(BitBoard::Flags::kFlagsBlackOo);
+  constexpr auto kBlackOoo =
+      static_cast<uint8_t>(BitBoard::Flags::kFlagsBlackOoo);
+
+  result["a8"_pv] = static_cast<uint8_t>(~kBlackOoo);
+  result["e8"_pv] = static_cast<uint8_t>(~(kBlackOo | kBlackOoo));
+  result["h8"_pv] = static_cast<uint8_t>(~kBlackOo);
+  result["a1"_pv] = static_cast<uint8_t>(~kWhiteOoo);
+  result["e1"_pv] = static_cast<uint8_t>(~(kWhiteOo | kWhiteOoo));
+  result["h1"_pv] = static_cast<uint8_t>(~kWhiteOo);
+  return result;
+}
+
+constexpr auto g_castling_keep = generateCastlingKeep();
+
+// Moves the pawns of the color `kShift` squares forward, white pawns go to
+// lower indices. 8 and 16 push, 7 and 9 capture and drop the pawns that
+// would wrap around the board.
+template<unsigned kShift>
+constexpr bitboard_field pawnsShift(bitboard_field pawns, bool white)
+{
+  const bitboard_field shifted = white ? pawns >> kShift : pawns << kShift;
+  if constexpr (kShift == 9) {
+    return shifted & (white ? ~row_h : ~row_a);
+  } else if constexpr (kShift == 7) {
+    return shifted & (white ? ~row_a : ~row_h);
+  } else {
+    return shifted;
+  }
+}
+
+// Squares attacked by the pawns in `pawns`.
+constexpr bitboard_field pawnAttacks(bitboard_field pawns, bool white)
+{
+  return pawnsShift<9>(pawns, white) | pawnsShift<7>(pawns, white);
+}
+
+}  // namespace
+
+const char* const kStartPosition =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+// The shared board is queried from any thread, its cache is filled here so
+// that queries only read it.
+const BitBoard kStartBitBoard = []
+{
+  const BitBoard board(kStartPosition);
+  static_cast<void>(board.attacks(Color::kWhite));
+  static_cast<void>(board.attacks(Color::kBlack));
+  static_cast<void>(board.checkers());
+  return board;
+}();
+
+BitBoard::BitBoard(std::string_view fen_line)
+{
+  boardFromFen(fen_line, *this);
+}
+
+std::string BitBoard::fen() const
+{
+  char buffer[kFenMaxLength];
+  return {buffer, boardToFen(*this, buffer)};
+}
+
+void BitBoard::setTurn(Turn turn)
+{
+  m_prev_turn = turn;
+}
+
+void BitBoard::setFlags(Flags flags)
+{
+  invalidate();
+  m_flags = flags;
+}
+
+void BitBoard::setCounters(uint16_t halfmove_clock, uint16_t fullmove_number)
+{
+  m_halfmove_clock = halfmove_clock;
+  m_fullmove_number = fullmove_number;
+}
+
+void BitBoard::set(Position position, Figure figure)
+{
+  invalidate();
+  const bitboard_field mask = positionToMask(position);
+  const bitboard_field clear = ~mask;
+
+  m_white_pawn &= clear;
+  m_white_knight &= clear;
+  m_white_bishop &= clear;
+  m_white_rook &= clear;
+  m_white_queen &= clear;
+  m_white_king &= clear;
+  m_black_pawn &= clear;
+  m_black_knight &= clear;
+  m_black_bishop &= clear;
+  m_black_rook &= clear;
+  m_black_queen &= clear;
+  m_black_king &= clear;
+
+  switch (figure) {
+    case Figure::kEmpty:
+      break;
+    case Figure::kWPawn:
+      m_white_pawn |= mask;
+      break;
+    case Figure::kWKnight:
+      m_white_knight |= mask;
+      break;
+    case Figure::kWBishop:
+      m_white_bishop |= mask;
+      break;
+    case Figure::kWRook:
+      m_white_rook |= mask;
+      break;
+    case Figure::kWQueen:
+      m_white_queen |= mask;
+      break;
+    case Figure::kWKing:
+      m_white_king |= mask;
+      break;
+    case Figure::kBPawn:
+      m_black_pawn |= mask;
+      break;
+    case Figure::kBKnight:
+      m_black_knight |= mask;
+      break;
+    case Figure::kBBishop:
+      m_black_bishop |= mask;
+      break;
+    case Figure::kBRook:
+      m_black_rook |= mask;
+      break;
+    case Figure::kBQueen:
+      m_black_queen |= mask;
+      break;
+    case Figure::kBKing:
+      m_black_king |= mask;
+      break;
+  }
+}
+
+void BitBoard::setPieces(const bitboard_field (&fields)[12]) noexcept
+{
+  invalidate();
+  m_white_pawn = fields[0];
+  m_white_knight = fields[1];
+  m_white_bishop = fields[2];
+  m_white_rook = fields[3];
+  m_white_queen = fields[4];
+  m_white_king = fields[5];
+  m_black_pawn = fields[6];
+  m_black_knight = fields[7];
+  m_black_bishop = fields[8];
+  m_black_rook = fields[9];
+  m_black_queen = fields[10];
+  m_black_king = fields[11];
+  m_hash = 0;
+}
+
+void BitBoard::swap(Position pos_1, Position pos_2)
+{
+  if (pos_1 == pos_2) {
+    return;
+  }
+  const auto figure_1 = get(pos_1);
+  const auto figure_2 = get(pos_2);
+  set(pos_2, figure_1);
+  set(pos_1, figure_2);
+}
+
+Turn BitBoard::turn() const
+{
+  return m_prev_turn;
+}
+
+bitboard_hash BitBoard::hash() const
+{
+  return m_hash;
+}
+
+Color BitBoard::side() const noexcept
+{
+  return (static_cast<uint8_t>(m_flags)
+          & static_cast<uint8_t>(Flags::kFlagsColor))
+      ? Color::kBlack
+      : Color::kWhite;
+}
+
+BitBoard::Flags BitBoard::flags() const noexcept
+{
+  return m_flags;
+}
+
+Position BitBoard::elPassant() const noexcept
+{
+  if ((static_cast<uint8_t>(m_flags)
+       & static_cast<uint8_t>(Flags::kFlagsElPassant))
+      == 0)
+  {
+    return {};
+  }
+  return Position(static_cast<uint8_t>(
+      (m_prev_turn.from().index() + m_prev_turn.to().index()) / 2));
+}
+
+uint16_t BitBoard::halfmoveClock() const noexcept
+{
+  return m_halfmove_clock;
+}
+
+uint16_t BitBoard::fullmoveNumber() const noexcept
+{
+  return m_fullmove_number;
+}
+
+Figure BitBoard::get(Position position) const noexcept
+{
+  const bitboard_field mask = positionToMask(position);
+  if (mask & m_white_pawn) {
+    return Figure::kWPawn;
+  }
+  if (mask & m_white_knight) {
+    return Figure::kWKnight;
+  }
+  if (mask & m_white_bishop) {
+    return Figure::kWBishop;
+  }
+  if (mask & m_white_rook) {
+    return Figure::kWRook;
+  }
+  if (mask & m_white_queen) {
+    return Figure::kWQueen;
+  }
+  if (mask & m_white_king) {
+    return Figure::kWKing;
+  }
+  if (mask & m_black_pawn) {
+    return Figure::kBPawn;
+  }
+  if (mask & m_black_knight) {
+    return Figure::kBKnight;
+  }
+  if (mask & m_black_bishop) {
+    return Figure::kBBishop;
+  }
+  if (mask & m_black_rook) {
+    return Figure::kBRook;
+  }
+  if (mask & m_black_queen) {
+    return Figure::kBQueen;
+  }
+  if (mask & m_black_king) {
+    return Figure::kBKing;
+  }
+  return Figure::kEmpty;
+}
+
+bitboard_field BitBoard::pieces(Figure figure) const noexcept
+{
+  switch (figure) {
+    case Figure::kWPawn:
+      return m_white_pawn;
+    case Figure::kWKnight:
+      return m_white_knight;
+    case Figure::kWBishop:
+      return m_white_bishop;
+    case Figure::kWRook:
+      return m_white_rook;
+    case Figure::kWQueen:
+      return m_white_queen;
+    case Figure::kWKing:
+      return m_white_king;
+    case Figure::kBPawn:
+      return m_black_pawn;
+    case Figure::kBKnight:
+      return m_black_knight;
+    case Figure::kBBishop:
+      return m_black_bishop;
+    case Figure::kBRook:
+      return m_black_rook;
+    case Figure::kBQueen:
+      return m_black_queen;
+    case Figure::kBKing:
+      return m_black_king;
+    case Figure::kEmpty:
+      break;
+  }
+  return ~occupancy();
+}
+
+bitboard_field BitBoard::occupancy() const noexcept
+{
+  return m_white_pawn | m_white_knight | m_white_bishop | m_white_rook
+      | m_white_queen | m_white_king | m_black_pawn | m_black_knight
+      | m_black_bishop | m_black_rook | m_black_queen | m_black_king;
+}
+
+bitboard_field BitBoard::whites() const noexcept
+{
+  return m_white_pawn | m_white_knight | m_white_bishop | m_white_rook
+      | m_white_queen | m_white_king;
+}
+
+bitboard_field BitBoard::blacks() const noexcept
+{
+  return m_black_pawn | m_black_knight | m_black_bishop | m_black_rook
+      | m_black_queen | m_black_king;
+}
+
+bitboard_field BitBoard::attackersTo(Position position,
+                                     bitboard_field occupancy) const noexcept
+{
+  const bitboard_field mask = positionToMask(position);
+  // white pawns capture towards the lower indices, black towards the higher
+  const bitboard_field white_pawns =
+      ((mask << 9) & ~row_a) | ((mask << 7) & ~row_h);
+  const bitboard_field black_pawns =
+      ((mask >> 9) & ~row_h) | ((mask >> 7) & ~row_a);
+  const bitboard_field straight =
+      m_white_rook | m_white_queen | m_black_rook | m_black_queen;
+  const bitboard_field diagonal =
+      m_white_bishop | m_white_queen | m_black_bishop | m_black_queen;
+
+  return (white_pawns & m_white_pawn) | (black_pawns & m_black_pawn)
+      | (processKnight(position) & (m_white_knight | m_black_knight))
+      | (processKing(position) & (m_white_king | m_black_king))
+      | (processRook(position, occupancy) & straight)
+      | (processBishop(position, occupancy) & diagonal);
+}
+
+bool BitBoard::kingAttacked(Color color) const noexcept
+{
+  const bitboard_field king =
+      color == Color::kWhite ? m_white_king : m_black_king;
+  if (king == 0) {
+    return false;
+  }
+  const bitboard_field enemies = color == Color::kWhite ? blacks() : whites();
+  return (attackersTo(Position(static_cast<uint8_t>(log2_64(king))),
+                      occupancy())
+          & enemies)
+      != 0;
+}
+
+bool BitBoard::isLegal(Turn turn) const noexcept
+{
+  if (!turn.valid()) {
+    return false;
+  }
+  const Position from = turn.from();
+  const Position to = turn.to();
+  const bool white = side() == Color::kWhite;
+  const auto moved = static_cast<int8_t>(get(from));
+  const bitboard_field own = white ? whites() : blacks();
+  const bitboard_field to_mask = positionToMask(to);
+  if (moved == 0 || (moved > 0) != white || (own & to_mask) != 0) {
+    return false;
+  }
+
+  // the kind of a classified turn has to match the board, executeTurn trusts
+  // it; a pawn reaching the last rank has to name the figure. A promotion
+  // without the capture flag is classified again, as the one from UCI.
+  const Turn expected = classify(
+      turn.promotion() ? Turn(from, to, turn.figure()) : Turn(from, to));
+  if (expected.promotion() != turn.promotion()
+      || (turn.kind() != TurnKind::kUnknown
+          && turn.kind() != TurnKind::kPromotion
+          && turn.kind() != expected.kind()))
+  {
+    return false;
+  }
+
+  const bitboard_field from_mask = positionToMask(from);
+  const bitboard_field all = occupancy();
+  const auto figure = static_cast<Figure>(moved > 0 ? moved : -moved);
+  bitboard_field reach = 0;
+
+  switch (figure) {
+    case Figure::kPawn: {
+      const bitboard_field push = white ? from_mask >> 8U : from_mask << 8U;
+      const bitboard_field attacks = pawnAttacks(from_mask, white);
+      switch (expected.kind()) {
+        case TurnKind::kQuiet:
+        case TurnKind::kPromotion:
+          reach = push & ~all;
+          break;
+        case TurnKind::kDoublePush:
+          if ((from_mask & (white ? line_2 : line_7)) != 0
+              && (push & all) == 0)
+          {
+            reach = (white ? push >> 8U : push << 8U) & ~all;
+          }
+          break;
+        default:
+          reach = attacks;
+          break;
+      }
+      break;
+    }
+    case Figure::kKnight:
+      reach = processKnight(from);
+      break;
+    case Figure::kBishop:
+      reach = processBishop(from, all);
+      break;
+    case Figure::kRook:
+      reach = processRook(from, all);
+      break;
+    case Figure::kQueen:
+      reach = processRook(from, all) | processBishop(from, all);
+      break;
+    case Figure::kKing:
+      if (expected.kind() == TurnKind::kCastling) {
+        return castlingAllowed(to);
+      }
+      return (processKing(from) & to_mask) != 0
+          && (attacks(white ? Color::kBlack : Color::kWhite) & to_mask) == 0;
+    default:
+      return false;
+  }
+  return (reach & to_mask) != 0 && kingSafeAfter(expected);
+}
+
+bool BitBoard::castlingAllowed(Position to) const noexcept
+{
+  const bool white = side() == Color::kWhite;
+  const bool king_side = to.x() == 6;
+  const auto rank = static_cast<uint8_t>(white ? 7 : 0);
+  const Flags right = white
+      ? (king_side ? Flags::kFlagsWhiteOo : Flags::kFlagsWhiteOoo)
+      : (king_side ? Flags::kFlagsBlackOo : Flags::kFlagsBlackOoo);
+  if ((to.x() != 2 && !king_side) || to.y() != rank
+      || (static_cast<uint8_t>(m_flags) & static_cast<uint8_t>(right)) == 0)
+  {
+    return false;
+  }
+
+  const bitboard_field line = line_8 << (rank * 8U);
+  const bitboard_field rook = line & (king_side ? row_h : row_a);
+  const bitboard_field between =
+      line & (king_side ? row_f | row_g : row_b | row_c | row_d);
+  const bitboard_field all = occupancy();
+  const bitboard_field king = white ? m_white_king : m_black_king;
+  const bitboard_field rooks = white ? m_white_rook : m_black_rook;
+  if ((king & line & row_e) == 0 || (rooks & rook) == 0
+      || (all & between) != 0)
+  {
+    return false;
+  }
+
+  // the king may neither start, pass nor end on an attacked square
+  const bitboard_field path =
+      line & (king_side ? row_e | row_f | row_g : row_c | row_d | row_e);
+  return (attacks(white ? Color::kBlack : Color::kWhite) & path) == 0;
+}
+
+bool BitBoard::kingSafeAfter(Turn turn) const noexcept
+{
+  const bool white = side() == Color::kWhite;
+  const bitboard_field king = white ? m_white_king : m_black_king;
+  if (king == 0) {
+    return true;
+  }
+  const bitboard_field from_mask = positionToMask(turn.from());
+  bitboard_field removed = positionToMask(turn.to());
+  if (turn.kind() == TurnKind::kElPassant) {
+    removed |= positionToMask(Position(turn.to().x(), turn.from().y()));
+  }
+  // the moved figure blocks at its target, captured figures stop attacking
+  const bitboard_field all = (occupancy() & ~from_mask & ~removed)
+      | positionToMask(turn.to());
+  const bitboard_field enemies = (white ? blacks() : whites()) & ~removed;
+  return (attackersTo(Position(static_cast<uint8_t>(log2_64(king))), all)
+          & enemies)
+      == 0;
+}
+
+bool BitBoard::isLegalAfterPseudo(Turn turn) const noexcept
+{
+  const bool white = side() == Color::kWhite;
+  const bitboard_field king = white ? m_white_king : m_black_king;
+  const bitboard_field from_mask = positionToMask(turn.from());
+  if ((king & from_mask) == 0) {
+    return kingSafeAfter(turn);
+  }
+  if (turn.kind() == TurnKind::kCastling) {
+    return true;
+  }
+  return (attacks(white ? Color::kBlack : Color::kWhite)
+          & positionToMask(turn.to()))
+      == 0;
+}
+
+void BitBoard::invalidate() noexcept
+{
+#ifdef BITBOARD_ATTACK_CACHE
+  m_cache.valid = 0;
+#endif
+}
+
+bitboard_field BitBoard::computeAttacks(Color color) const noexcept
+{
+  const bool white = color == Color::kWhite;
+  // sliders look through the enemy king
+  const bitboard_field all =
+      occupancy() & ~(white ? m_black_king : m_white_king);
+  bitboard_field result =
+      pawnAttacks(white ? m_white_pawn : m_black_pawn, white);
+
+  bitboard_field knights = white ? m_white_knight : m_black_knight;
+  for (bitboard_field bit = takeBit(knights); bit; bit = takeBit(knights)) {
+    result |= processKnight(Position(static_cast<uint8_t>(log2_64(bit))));
+  }
+  result |= kernels().slider_attacks(
+      white ? m_white_rook | m_white_queen : m_black_rook | m_black_queen,
+      white ? m_white_bishop | m_white_queen : m_black_bishop | m_black_queen,
+      all);
+  const bitboard_field king = white ? m_white_king : m_black_king;
+  if (king != 0) {
+    result |= processKing(Position(static_cast<uint8_t>(log2_64(king))));
+  }
+  return result;
+}
+
+AttackCounts BitBoard::attackCounts(Color color) const noexcept
+{
+  const bool white = color == Color::kWhite;
+  const bitboard_field all =
+      occupancy() & ~(white ? m_black_king : m_white_king);
+  const bitboard_field pawns = white ? m_white_pawn : m_black_pawn;
+  AttackCounts result;
+  result.add(pawnsShift<9>(pawns, white), pawnsShift<7>(pawns, white));
+
+  bitboard_field knights = white ? m_white_knight : m_black_knight;
+  for (bitboard_field bit = takeBit(knights); bit; bit = takeBit(knights)) {
+    result.add(processKnight(Position(static_cast<uint8_t>(log2_64(bit)))));
+  }
+  bitboard_field rooks =
+      white ? m_white_rook | m_white_queen : m_black_rook | m_black_queen;
+  for (bitboard_field bit = takeBit(rooks); bit; bit = takeBit(rooks)) {
+    result.add(
+        processRook(Position(static_cast<uint8_t>(log2_64(bit))), all));
+  }
+  bitboard_field bishops =
+      white ? m_white_bishop | m_white_queen : m_black_bishop | m_black_queen;
+  for (bitboard_field bit = takeBit(bishops); bit; bit = takeBit(bishops)) {
+    result.add(
+        processBishop(Position(static_cast<uint8_t>(log2_64(bit))), all));
+  }
+  const bitboard_field king = white ? m_white_king : m_black_king;
+  if (king != 0) {
+    result.add(processKing(Position(static_cast<uint8_t>(log2_64(king)))));
+  }
+  return result;
+}
+
+Mobility BitBoard::mobility(Color color) const noexcept
+{
+  const bool white = color == Color::kWhite;
+  const bitboard_field own = white ? whites() : blacks();
+  const bitboard_field enemies = white ? blacks() : whites();
+  const bitboard_field all = own | enemies;
+  const bitboard_field empty = ~all;
+  const bitboard_field area =
+      ~own & ~pawnAttacks(white ? m_black_pawn : m_white_pawn, !white);
+  const bitboard_field enemy_king = white ? m_black_king : m_white_king;
+  const bitboard_field zone = enemy_king == 0
+      ? 0
+      : enemy_king
+          | processKing(Position(static_cast<uint8_t>(log2_64(enemy_king))));
+
+  Mobility result;
+  const auto add = [&result, area, zone](Figure figure, bitboard_field targets)
+  {
+    const auto type = static_cast<std::size_t>(figure) - 1;
+    result.figures[type] =
+        static_cast<uint8_t>(result.figures[type] + popCount(targets & area));
+    if ((targets & zone) != 0) {
+      result.king_attackers++;
+      result.king_attacks =
+          static_cast<uint8_t>(result.king_attacks + popCount(targets & zone));
+      result.king_attack_weight += kKingAttackWeights[type];
+    }
+  };
+
+  const bitboard_field pawns = white ? m_white_pawn : m_black_pawn;
+  const bitboard_field single = pawnsShift<8>(pawns, white) & empty;
+  const bitboard_field double_push =
+      pawnsShift<8>(single & (white ? line_3 : line_6), white) & empty;
+  const bitboard_field east = pawnsShift<9>(pawns, white);
+  const bitboard_field west = pawnsShift<7>(pawns, white);
+  result.figures[0] = static_cast<uint8_t>(
+      popCount(single & area) + popCount(double_push & area)
+      + popCount(east & enemies & area) + popCount(west & enemies & area));
+  result.king_attackers = static_cast<uint8_t>(
+      popCount(pawnAttacks(zone, !white) & pawns));
+  result.king_attacks =
+      static_cast<uint8_t>(popCount(east & zone) + popCount(west & zone));
+
+  bitboard_field knights = white ? m_white_knight : m_black_knight;
+  for (bitboard_field bit = takeBit(knights); bit; bit = takeBit(knights)) {
+    add(Figure::kKnight,
+        processKnight(Position(static_cast<uint8_t>(log2_64(bit)))));
+  }
+  bitboard_field bishops = white ? m_white_bishop : m_black_bishop;
+  for (bitboard_field bit = takeBit(bishops); bit; bit = takeBit(bishops)) {
+    add(Figure::kBishop,
+        processBishop(Position(static_cast<uint8_t>(log2_64(bit))), all));
+  }
+  bitboard_field rooks = white ? m_white_rook : m_black_rook;
+  for (bitboard_field bit = takeBit(rooks); bit; bit = takeBit(rooks)) {
+    add(Figure::kRook,
+        processRook(Position(static_cast<uint8_t>(log2_64(bit))), all));
+  }
+  bitboard_field queens = white ? m_white_queen : m_black_queen;
+  for (bitboard_field bit = takeBit(queens); bit; bit = takeBit(queens)) {
+    const auto position = Position(static_cast<uint8_t>(log2_64(bit)));
+    add(Figure::kQueen,
+        processRook(position, all) | processBishop(position, all));
+  }
+
+  const bitboard_field king = white ? m_white_king : m_black_king;
+  if (king != 0) {
+    result.figures[5] = static_cast<uint8_t>(
+        popCount(processKing(Position(static_cast<uint8_t>(log2_64(king))))
+                 & ~own & ~attacks(white ? Color::kBlack : Color::kWhite)));
+  }
+  return result;
+}
+
+void BitBoard::computeChecks(bitboard_field& checkers,
+                             bitboard_field& pinned) const noexcept
+{
+  checkers = 0;
+  pinned = 0;
+  const bool white = side() == Color::kWhite;
+  const bitboard_field king = white ? m_white_king : m_black_king;
+  if (king == 0) {
+    return;
+  }
+  const bitboard_field own = white ? whites() : blacks();
+  const bitboard_field enemies = white ? blacks() : whites();
+  const bitboard_field all = own | enemies;
+  const auto king_position = Position(static_cast<uint8_t>(log2_64(king)));
+  checkers = attackersTo(king_position, all) & enemies;
+
+  // sliders seen from the king through the own figures pin the only figure
+  // between
+  const bitboard_field straight =
+      white ? m_black_rook | m_black_queen : m_white_rook | m_white_queen;
+  const bitboard_field diagonal =
+      white ? m_black_bishop | m_black_queen : m_white_bishop | m_white_queen;
+  bitboard_field snipers = (processRook(king_position, enemies) & straight)
+      | (processBishop(king_position, enemies) & diagonal);
+  for (bitboard_field bit = takeBit(snipers); bit; bit = takeBit(snipers)) {
+    const bitboard_field blockers =
+        processWay(king_position, Position(static_cast<uint8_t>(log2_64(bit))))
+        & all;
+    if ((blockers & (blockers - 1)) == 0 && (blockers & own) != 0) {
+      pinned |= blockers;
+    }
+  }
+}
+
+#ifdef BITBOARD_ATTACK_CACHE
+
+bitboard_field BitBoard::attacks(Color color) const noexcept
+{
+  const bool white = color == Color::kWhite;
+  const uint8_t bit =
+      white ? AttackCache::kWhiteAttacks : AttackCache::kBlackAttacks;
+  if ((m_cache.valid & bit) == 0) {
+    m_cache.attacks[white ? 0 : 1] = computeAttacks(color);
+    m_cache.valid |= bit;
+  }
+  return m_cache.attacks[white ? 0 : 1];
+}
+
+bitboard_field BitBoard::checkers() const noexcept
+{
+  if ((m_cache.valid & AttackCache::kChecks) == 0) {
+    computeChecks(m_cache.checkers, m_cache.pinned);
+    m_cache.valid |= AttackCache::kChecks;
+  }
+  return m_cache.checkers;
+}
+
+bitboard_field BitBoard::pinned() const noexcept
+{
+  static_cast<void>(checkers());
+  return m_cache.pinned;
+}
+
+#else
+
+bitboard_field BitBoard::attacks(Color color) const noexcept
+{
+  return computeAttacks(color);
+}
+
+bitboard_field BitBoard::checkers() const noexcept
+{
+  bitboard_field result = 0;
+  bitboard_field pins = 0;
+  computeChecks(result, pins);
+  return result;
+}
+
+bitboard_field BitBoard::pinned() const noexcept
+{
+  bitboard_field checks = 0;
+  bitboard_field result = 0;
+  computeChecks(checks, result);
+  return result;
+}
+
+#endif
+
+bitboard_field BitBoard::Restrictions::allowed(
+    bitboard_field from_mask) const noexcept
+{
+  if ((from_mask & pinned) != 0) {
+    return target
+        & processLine(king, Position(static_cast<uint8_t>(log2_64(from_mask))));
+  }
+  return target;
+}
+
+BitBoard::Restrictions BitBoard::restrictions() const noexcept
+{
+  Restrictions result;
+  const bitboard_field king =
+      side() == Color::kWhite ? m_white_king : m_black_king;
+  if (king == 0) {
+    return result;
+  }
+  result.king = Position(static_cast<uint8_t>(log2_64(king)));
+#ifdef BITBOARD_ATTACK_CACHE
+  result.checkers = checkers();
+  result.pinned = m_cache.pinned;
+#else
+  computeChecks(result.checkers, result.pinned);
+#endif
+  if ((result.checkers & (result.checkers - 1)) != 0) {
+    result.target = 0;
+  } else if (result.checkers != 0) {
+    result.target = result.checkers
+        | processWay(result.king,
+                     Position(static_cast<uint8_t>(log2_64(result.checkers))));
+  }
+  return result;
+}
+
+bool BitBoard::hasLegalMove() const noexcept
+{
+  const bool white = side() == Color::kWhite;
+  const bitboard_field own = white ? whites() : blacks();
+  const bitboard_field enemies = white ? blacks() : whites();
+  const bitboard_field all = own | enemies;
+  const bitboard_field king = white ? m_white_king : m_black_king;
+
+  // the king first, it is the only figure that can answer a double check;
+  // castling is never needed: when it is legal, so is the step towards the
+  // rook
+  if (king != 0
+      && (processKing(Position(static_cast<uint8_t>(log2_64(king)))) & ~own
+          & ~attacks(white ? Color::kBlack : Color::kWhite))
+          != 0)
+  {
+    return true;
+  }
+
+  const Restrictions restricted = restrictions();
+  if (restricted.target == 0) {
+    return false;
+  }
+  const auto movable = [&](Position from, bitboard_field targets)
+  { return (targets & ~own & restricted.allowed(positionToMask(from))) != 0; };
+
+  bitboard_field knights = white ? m_white_knight : m_black_knight;
+  for (bitboard_field bit = takeBit(knights); bit; bit = takeBit(knights)) {
+    const auto from = Position(static_cast<uint8_t>(log2_64(bit)));
+    if (movable(from, processKnight(from))) {
+      return true;
+    }
+  }
+
+  const Position el_passant = elPassant();
+  bitboard_field pawns = white ? m_white_pawn : m_black_pawn;
+  for (bitboard_field bit = takeBit(pawns); bit; bit = takeBit(pawns)) {
+    const auto from = Position(static_cast<uint8_t>(log2_64(bit)));
+    const bitboard_field from_mask = positionToMask(from);
+    const bitboard_field push =
+        (white ? from_mask >> 8U : from_mask << 8U) & ~all;
+    const bitboard_field double_push =
+        (from_mask & (white ? line_2 : line_7)) != 0
+        ? (white ? push >> 8U : push << 8U) & ~all
+        : 0;
+    const bitboard_field attacks = pawnAttacks(from_mask, white);
+    if (movable(from, push | double_push | (attacks & enemies))) {
+      return true;
+    }
+    if (el_passant.valid() && (attacks & positionToMask(el_passant)) != 0
+        && kingSafeAfter(
+            Turn::unsafeConstruct(from, el_passant, TurnKind::kElPassant)))
+    {
+      return true;
+    }
+  }
+
+  bitboard_field bishops = white ? m_white_bishop | m_white_queen
+                                 : m_black_bishop | m_black_queen;
+  for (bitboard_field bit = takeBit(bishops); bit; bit = takeBit(bishops)) {
+    const auto from = Position(static_cast<uint8_t>(log2_64(bit)));
+    if (movable(from, processBishop(from, all))) {
+      return true;
+    }
+  }
+  bitboard_field rooks =
+      white ? m_white_rook | m_white_queen : m_black_rook | m_black_queen;
+  for (bitboard_field bit = takeBit(rooks); bit; bit = takeBit(rooks)) {
+    const auto from = Position(static_cast<uint8_t>(log2_64(bit)));
+    if (movable(from, processRook(from, all))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BitBoard::isCheckmate() const noexcept
+{
+  return checkers() != 0 && !hasLegalMove();
+}
+
+bool BitBoard::isStalemate() const noexcept
+{
+  return checkers() == 0 && !hasLegalMove();
+}
+
+BitBoard::CheckInfo BitBoard::checkInfo() const noexcept
+{
+  CheckInfo info;
+  const bool white = side() == Color::kWhite;
+  const bitboard_field king = white ? m_black_king : m_white_king;
+  if (king == 0) {
+    return info;
+  }
+  const bitboard_field own = white ? whites() : blacks();
+  const bitboard_field all = occupancy();
+  info.king = Position(static_cast<uint8_t>(log2_64(king)));
+
+  const bitboard_field bishop = processBishop(info.king, all);
+  const bitboard_field rook = processRook(info.king, all);
+  // own pawns checking the king stand where enemy pawns would attack from it
+  info.squares[0] = pawnAttacks(king, !white);
+  info.squares[1] = processKnight(info.king);
+  info.squares[2] = bishop;
+  info.squares[3] = rook;
+  info.squares[4] = bishop | rook;
+
+  const bitboard_field straight =
+      white ? m_white_rook | m_white_queen : m_black_rook | m_black_queen;
+  const bitboard_field diagonal =
+      white ? m_white_bishop | m_white_queen : m_black_bishop | m_black_queen;
+  bitboard_field snipers = (processRook(info.king, 0) & straight)
+      | (processBishop(info.king, 0) & diagonal);
+  for (bitboard_field bit = takeBit(snipers); bit; bit = takeBit(snipers)) {
+    const auto sniper = Position(static_cast<uint8_t>(log2_64(bit)));
+    const bitboard_field ray = processWay(info.king, sniper);
+    const bitboard_field blockers = ray & all;
+    if (blockers != 0 && (blockers & (blockers - 1)) == 0
+        && (blockers & own) != 0)
+    {
+      info.discovered |= blockers;
+      info.rays[info.count++] = ray | positionToMask(sniper);
+    }
+  }
+  return info;
+}
+
+bool BitBoard::givesCheck(Turn turn) const noexcept
+{
+  return givesCheck(turn, checkInfo());
+}
+
+bool BitBoard::givesCheck(Turn turn, const CheckInfo& info) const noexcept
+{
+  if (!info.king.valid() || !turn.valid()) {
+    return false;
+  }
+  turn = classify(turn);
+  const bool white = side() == Color::kWhite;
+  const Position from = turn.from();
+  const Position to = turn.to();
+  const bitboard_field from_mask = positionToMask(from);
+  const bitboard_field to_mask = positionToMask(to);
+  const bitboard_field king = positionToMask(info.king);
+
+  // the sliders behind the el passant pawn or the castling rook are traced
+  // with the occupancy after the turn
+  if (turn.kind() == TurnKind::kElPassant || turn.kind() == TurnKind::kCastling)
+  {
+    bitboard_field straight =
+        white ? m_white_rook | m_white_queen : m_black_rook | m_black_queen;
+    const bitboard_field diagonal =
+        white ? m_white_bishop | m_white_queen : m_black_bishop | m_black_queen;
+    bitboard_field all = occupancy() ^ from_mask ^ to_mask;
+    if (turn.kind() == TurnKind::kElPassant) {
+      all ^= positionToMask(Position(to.x(), from.y()));
+      if ((pawnAttacks(to_mask, white) & king) != 0) {
+        return true;
+      }
+    } else {
+      const bool king_side = to.x() > from.x();
+      const bitboard_field rook =
+          positionToMask(Position(static_cast<uint8_t>(king_side ? 7 : 0),
+                                  from.y()))
+          | positionToMask(Position(static_cast<uint8_t>(king_side ? 5 : 3),
+                                    from.y()));
+      all ^= rook;
+      straight ^= rook;
+    }
+    return ((processRook(info.king, all) & straight)
+            | (processBishop(info.king, all) & diagonal))
+        != 0;
+  }
+
+  if (turn.promotion()) {
+    const bitboard_field all = (occupancy() & ~from_mask) | to_mask;
+    bitboard_field attacks = 0;
+    switch (turn.figure()) {
+      case Figure::kKnight:
+        attacks = processKnight(to);
+        break;
+      case Figure::kBishop:
+        attacks = processBishop(to, all);
+        break;
+      case Figure::kRook:
+        attacks = processRook(to, all);
+        break;
+      default:
+        attacks = processRook(to, all) | processBishop(to, all);
+        break;
+    }
+    if ((attacks & king) != 0) {
+      return true;
+    }
+  } else {
+    const auto moved = static_cast<int8_t>(get(from));
+    const auto figure = static_cast<std::size_t>(moved > 0 ? moved : -moved);
+    if (figure != 0 && (info.squares[figure - 1] & to_mask) != 0) {
+      return true;
+    }
+  }
+
+  if ((info.discovered & from_mask) != 0) {
+    for (std::size_t i = 0; i < info.count; ++i) {
+      if ((info.rays[i] & from_mask) != 0 && (info.rays[i] & to_mask) == 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bitboard_field BitBoard::leastValuable(bitboard_field attackers,
+                                       bool white,
+                                       Figure& figure) const noexcept
+{
+  const bitboard_field sets[] = {
+      white ? m_white_pawn : m_black_pawn,
+      white ? m_white_knight : m_black_knight,
+      white ? m_white_bishop : m_black_bishop,
+      white ? m_white_rook : m_black_rook,
+      white ? m_white_queen : m_black_queen,
+      white ? m_white_king : m_black_king,
+  };
+  for (std::size_t i = 0; i < std::size(sets); ++i) {
+    const bitboard_field set = attackers & sets[i];
+    if (set != 0) {
+      figure = static_cast<Figure>(i + 1);
+      return set & (~set + 1);
+    }
+  }
+  figure = Figure::kEmpty;
+  return 0;
+}
+
+BitBoard::Exchange BitBoard::startExchange(Turn turn) const noexcept
+{
+  const Position from = turn.from();
+  Exchange exchange;
+  exchange.board = this;
+  exchange.to = turn.to();
+  exchange.white_figures = whites();
+  exchange.black_figures = blacks();
+  exchange.attacker = figureValue(get(from));
+  exchange.gain = figureValue(get(exchange.to));
+  exchange.all = (exchange.white_figures | exchange.black_figures)
+      ^ positionToMask(from);
+  if (turn.kind() == TurnKind::kElPassant) {
+    exchange.gain = figureValue(Figure::kPawn);
+    exchange.all ^= positionToMask(Position(exchange.to.x(), from.y()));
+  }
+  if (turn.promotion()) {
+    exchange.attacker = figureValue(turn.figure());
+    exchange.gain += exchange.attacker - figureValue(Figure::kPawn);
+  }
+  exchange.attackers = attackersTo(exchange.to, exchange.all) & exchange.all;
+  exchange.white = side() != Color::kWhite;
+  return exchange;
+}
+
+bitboard_field BitBoard::Exchange::next(Figure& figure) const noexcept
+{
+  return board->leastValuable(
+      attackers & (white ? white_figures : black_figures), white, figure);
+}
+
+bool BitBoard::Exchange::defended(bitboard_field bit) const noexcept
+{
+  return (attackers & ~bit & (white ? black_figures : white_figures)) != 0;
+}
+
+void BitBoard::Exchange::capture(bitboard_field bit) noexcept
+{
+  const bitboard_field straight = board->m_white_rook | board->m_white_queen
+      | board->m_black_rook | board->m_black_queen;
+  const bitboard_field diagonal = board->m_white_bishop | board->m_white_queen
+      | board->m_black_bishop | board->m_black_queen;
+  all ^= bit;
+  attackers |= (processRook(to, all) & straight)
+      | (processBishop(to, all) & diagonal);
+  attackers &= all;
+  white = !white;
+}
+
+int BitBoard::see(Turn turn) const noexcept
+{
+  turn = classify(turn);
+  if (!turn.valid() || turn.kind() == TurnKind::kCastling) {
+    return 0;
+  }
+  Exchange exchange = startExchange(turn);
+
+  // gains[i] is the balance of the side making the i-th capture if the
+  // exchange stopped right after it
+  int gains[32];
+  int depth = 0;
+  int attacker = exchange.attacker;
+  gains[0] = exchange.gain;
+  while (depth < 31) {
+    Figure figure = Figure::kEmpty;
+    const bitboard_field bit = exchange.next(figure);
+    if (bit == 0) {
+      break;
+    }
+    // the king can't capture into a defended square
+    if (figure == Figure::kKing && exchange.defended(bit)) {
+      break;
+    }
+    depth++;
+    gains[depth] = attacker - gains[depth - 1];
+    attacker = figureValue(figure);
+    exchange.capture(bit);
+  }
+  while (depth > 0) {
+    gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+    depth--;
+  }
+  return gains[0];
+}
+
+bool BitBoard::seeGE(Turn turn, int threshold) const noexcept
+{
+  turn = classify(turn);
+  if (!turn.valid() || turn.kind() == TurnKind::kCastling) {
+    return threshold <= 0;
+  }
+  Exchange exchange = startExchange(turn);
+
+  // `swap` is the balance relative to the threshold that the side to move
+  // of the exchange has to beat, `result` whether the mover is ahead
+  int swap = exchange.gain - threshold;
+  if (swap < 0) {
+    return false;
+  }
+  swap = exchange.attacker - swap;
+  if (swap <= 0) {
+    return true;
+  }
+
+  bool result = true;
+  while (true) {
+    Figure figure = Figure::kEmpty;
+    const bitboard_field bit = exchange.next(figure);
+    if (bit == 0) {
+      break;
+    }
+    if (figure == Figure::kKing) {
+      // the king captures only when the other side has no attacker left
+      return exchange.defended(bit) ? result : !result;
+    }
+    result = !result;
+    swap = figureValue(figure) - swap;
+    if (swap < static_cast<int>(result)) {
+      break;
+    }
+    exchange.capture(bit);
+  }
+  return result;
+}
+
+namespace
+{
+
+// The emitters take the turns generate() finds. It hands over whole target
+// sets: the targets of one figure, or pawn targets that are all the same
+// shift away from their pawns; el passant and castling come one at a time.
+
+// Writes the turns, for getTurns() and getPseudoTurns().
+struct TurnEmitter
+{
+  TurnEmitter(const BitBoard& board, Turn* turns) noexcept
+      : out(turns)
+      , white(board.side() == Color::kWhite)
+      , enemies(white ? board.blacks() : board.whites())
+  {
+  }
+
+  void targets(Position from, bitboard_field targets) noexcept
+  {
+    for (bitboard_field bit = takeBit(targets); bit; bit = takeBit(targets)) {
+      const auto to = Position(static_cast<uint8_t>(log2_64(bit)));
+      out[count++] = Turn::unsafeConstruct(
+          from,
+          to,
+          (positionToMask(to) & enemies) != 0 ? TurnKind::kCapture
+                                              : TurnKind::kQuiet);
+    }
+  }
+
+  // `targets` of the pawns `shift` squares behind
+  void pawns(bitboard_field targets, unsigned shift) noexcept
+  {
+    const bitboard_field last = white ? line_8 : line_1;
+    for (bitboard_field bit = takeBit(targets); bit; bit = takeBit(targets)) {
+      const auto index = static_cast<unsigned>(log2_64(bit));
+      const auto from =
+          Position(static_cast<uint8_t>(white ? index + shift : index - shift));
+      const auto to = Position(static_cast<uint8_t>(index));
+      const bitboard_field to_mask = positionToMask(to);
+      const bool capture = (to_mask & enemies) != 0;
+      if ((to_mask & last) == 0) {
+        out[count++] = Turn::unsafeConstruct(
+            from,
+            to,
+            shift == 16 ? TurnKind::kDoublePush
+                : capture ? TurnKind::kCapture
+                          : TurnKind::kQuiet);
+        continue;
+      }
+      for (const Figure figure :
+           {Figure::kQueen, Figure::kRook, Figure::kBishop, Figure::kKnight})
+      {
+        out[count++] =
+            Turn::unsafeConstruct(from, to, promotionKind(figure, capture));
+      }
+    }
+  }
+
+  void turn(Turn turn) noexcept { out[count++] = turn; }
+
+  Turn* out;
+  bool white;
+  bitboard_field enemies;
+  std::size_t count = 0;
+};
+
+// ORs the targets into masks per from-square, for getTargets().
+struct TargetEmitter
+{
+  explicit TargetEmitter(const BitBoard& board) noexcept
+      : white(board.side() == Color::kWhite)
+  {
+  }
+
+  void targets(Position from, bitboard_field targets) noexcept
+  {
+    result.targets[from.index()] |= targets;
+  }
+
+  void pawns(bitboard_field targets, unsigned shift) noexcept
+  {
+    const bitboard_field last = white ? line_8 : line_1;
+    for (bitboard_field bit = takeBit(targets); bit; bit = takeBit(targets)) {
+      const auto index = static_cast<unsigned>(log2_64(bit));
+      const auto from =
+          Position(static_cast<uint8_t>(white ? index + shift : index - shift));
+      const bitboard_field to_mask =
+          positionToMask(Position(static_cast<uint8_t>(index)));
+      result.targets[from.index()] |= to_mask;
+      if ((to_mask & last) != 0) {
+        result.promotions |= positionToMask(from);
+      }
+    }
+  }
+
+  void turn(Turn turn) noexcept
+  {
+    result.targets[turn.from().index()] |= positionToMask(turn.to());
+  }
+
+  bool white;
+  TurnTargets result;
+};
+
+}  // namespace
+
+std::size_t BitBoard::getTurns(Turn* out) const noexcept
+{
+  TurnEmitter emit(*this, out);
+  generate<true>(emit);
+  return emit.count;
+}
+
+std::size_t BitBoard::getPseudoTurns(Turn* out) const noexcept
+{
+  TurnEmitter emit(*this, out);
+  generate<false>(emit);
+  return emit.count;
+}
+
+TurnTargets BitBoard::getTargets() const noexcept
+{
+  TargetEmitter emit(*this);
+  generate<true>(emit);
+  return emit.result;
+}
+
+template<bool kLegal, typename Emitter>
+void BitBoard::generate(Emitter& emit) const noexcept
+{
+  const bool white = side() == Color::kWhite;
+  const bitboard_field own = white ? whites() : blacks();
+  const bitboard_field enemies = white ? blacks() : whites();
+  const bitboard_field all = own | enemies;
+  const bitboard_field king = white ? m_white_king : m_black_king;
+
+  const Restrictions restricted = kLegal ? restrictions() : Restrictions {};
+  const auto allowed = [&](bitboard_field from_mask)
+  { return restricted.allowed(from_mask) & ~own; };
+
+  {  // pawns, shifted as whole sets
+    const bitboard_field third = white ? line_3 : line_6;
+    const bitboard_field pawns = white ? m_white_pawn : m_black_pawn;
+
+    const auto addPawns = [&](bitboard_field set, bitboard_field mask)
+    {
+      const bitboard_field push = pawnsShift<8>(set, white) & ~all;
+      emit.pawns(push & mask, 8);
+      emit.pawns(pawnsShift<8>(push & third, white) & ~all & mask, 16);
+      emit.pawns(pawnsShift<9>(set, white) & enemies & mask, 9);
+      emit.pawns(pawnsShift<7>(set, white) & enemies & mask, 7);
+    };
+
+    // a pinned pawn keeps to the line through its king
+    addPawns(pawns & ~restricted.pinned, restricted.target);
+    bitboard_field pinned_pawns = pawns & restricted.pinned;
+    for (bitboard_field bit = takeBit(pinned_pawns); bit;
+         bit = takeBit(pinned_pawns))
+    {
+      const bitboard_field pawn =
+          positionToMask(Position(static_cast<uint8_t>(log2_64(bit))));
+      addPawns(pawn, restricted.allowed(pawn));
+    }
+
+    // the captured pawn isn't on the target square, test the king directly
+    const Position el_passant = elPassant();
+    if (el_passant.valid()) {
+      bitboard_field capturers =
+          pawnAttacks(positionToMask(el_passant), !white) & pawns;
+      for (bitboard_field bit = takeBit(capturers); bit;
+           bit = takeBit(capturers))
+      {
+        const Turn turn = Turn::unsafeConstruct(
+            Position(static_cast<uint8_t>(log2_64(bit))),
+            el_passant,
+            TurnKind::kElPassant);
+        if (!kLegal || kingSafeAfter(turn)) {
+          emit.turn(turn);
+        }
+      }
+    }
+  }
+
+  {  // knights, bishops, rooks and queens
+    bitboard_field knights = white ? m_white_knight : m_black_knight;
+    for (bitboard_field bit = takeBit(knights); bit; bit = takeBit(knights)) {
+      const auto from = Position(static_cast<uint8_t>(log2_64(bit)));
+      emit.targets(from, processKnight(from) & allowed(positionToMask(from)));
+    }
+    bitboard_field bishops = white ? m_white_bishop | m_white_queen
+                                   : m_black_bishop | m_black_queen;
+    for (bitboard_field bit = takeBit(bishops); bit; bit = takeBit(bishops)) {
+      const auto from = Position(static_cast<uint8_t>(log2_64(bit)));
+      emit.targets(from,
+                   processBishop(from, all) & allowed(positionToMask(from)));
+    }
+    bitboard_field rooks = white ? m_white_rook | m_white_queen
+                                 : m_black_rook | m_black_queen;
+    for (bitboard_field bit = takeBit(rooks); bit; bit = takeBit(rooks)) {
+      const auto from = Position(static_cast<uint8_t>(log2_64(bit)));
+      emit.targets(from,
+                   processRook(from, all) & allowed(positionToMask(from)));
+    }
+  }
+
+  if (king != 0) {
+    const auto from = Position(static_cast<uint8_t>(log2_64(king)));
+    bitboard_field targets = processKing(from) & ~own;
+    if constexpr (kLegal) {
+      targets &= ~attacks(white ? Color::kBlack : Color::kWhite);
+    }
+    emit.targets(from, targets);
+
+    const uint8_t rights = white
+        ? static_cast<uint8_t>(Flags::kFlagsWhiteOo)
+            | static_cast<uint8_t>(Flags::kFlagsWhiteOoo)
+        : static_cast<uint8_t>(Flags::kFlagsBlackOo)
+            | static_cast<uint8_t>(Flags::kFlagsBlackOoo);
+    if ((static_cast<uint8_t>(m_flags) & rights) != 0
+        && restricted.checkers == 0)
+    {
+      for (const Position to : {Position(6, from.y()), Position(2, from.y())})
+      {
+        if (castlingAllowed(to)) {
+          emit.turn(Turn::unsafeConstruct(from, to, TurnKind::kCastling));
+        }
+      }
+    }
+  }
+}
+
+Turn BitBoard::classify(Turn turn) const noexcept
+{
+  // a promotion parsed from UCI has no capture flag yet
+  if (turn.kind() != TurnKind::kUnknown
+      && turn.kind() != TurnKind::kPromotion)
+  {
+    return turn;
+  }
+  const Position from = turn.from();
+  const Position to = turn.to();
+  const Figure figure = get(from);
+  const bool capture = get(to) != Figure::kEmpty;
+  TurnKind kind = capture ? TurnKind::kCapture : TurnKind::kQuiet;
+
+  switch (figure) {
+    case Figure::kWPawn:
+    case Figure::kBPawn:
+      if (to.y() == 0 || to.y() == 7) {
+        kind = promotionKind(turn.promotion() ? turn.figure() : Figure::kQueen,
+                             capture);
+      } else if (to == elPassant() && from.x() != to.x()) {
+        kind = TurnKind::kElPassant;
+      } else if (ce_abs(to.index() - from.index()) == 2 * kBoardSize) {
+        kind = TurnKind::kDoublePush;
+      }
+      break;
+    case Figure::kWKing:
+    case Figure::kBKing:
+      if (ce_abs(to.x() - from.x()) == 2) {
+        kind = TurnKind::kCastling;
+      }
+      break;
+    case Figure::kEmpty:
+      return turn;
+    default:
+      break;
+  }
+  return Turn::unsafeConstruct(from, to, kind);
+}
+
+std::size_t BitBoard::turnChanges(Turn turn, FigureChange* out) const noexcept
+{
+  std::size_t count = 0;
+  turn = classify(turn);
+  const Position from = turn.from();
+  const Position to = turn.to();
+  const Figure figure = get(from);
+  const auto sign = static_cast<int8_t>(side() == Color::kWhite ? 1 : -1);
+  const auto add = [&](Figure changed, Position position, int8_t change)
+  { out[count++] = {changed, position, change}; };
+
+  if (!applicable(turn)) {
+    return count;
+  }
+  switch (turn.kind()) {
+    case TurnKind::kCapture:
+    case TurnKind::kPromotionCapture:
+      add(get(to), to, -1);
+      break;
+    case TurnKind::kElPassant:
+      add(static_cast<Figure>(-sign), Position(to.x(), from.y()), -1);
+      break;
+    case TurnKind::kCastling: {
+      const bool king_side = to.x() > from.x();
+      const auto rook = static_cast<Figure>(
+          sign * static_cast<int8_t>(Figure::kRook));
+      const auto rook_from = static_cast<uint8_t>(king_side ? 7 : 0);
+      const auto rook_to = static_cast<uint8_t>(king_side ? 5 : 3);
+      add(rook, Position(rook_from, from.y()), -1);
+      add(rook, Position(rook_to, from.y()), 1);
+      break;
+    }
+    case TurnKind::kQuiet:
+    case TurnKind::kDoublePush:
+    case TurnKind::kPromotion:
+      break;
+    case TurnKind::kUnknown:
+    default:
+      return count;
+  }
+  add(figure, from, -1);
+  add(turn.promotion()
+          ? static_cast<Figure>(sign * static_cast<int8_t>(turn.figure()))
+          : figure,
+      to,
+      1);
+  return count;
+}
+
+bitboard_field& BitBoard::field(Figure figure) noexcept
+{
+  static constexpr bitboard_field BitBoard::*kFields[12] = {
+      &BitBoard::m_black_king,
+      &BitBoard::m_black_queen,
+      &BitBoard::m_black_rook,
+      &BitBoard::m_black_bishop,
+      &BitBoard::m_black_knight,
+      &BitBoard::m_black_pawn,
+      &BitBoard::m_white_pawn,
+      &BitBoard::m_white_knight,
+      &BitBoard::m_white_bishop,
+      &BitBoard::m_white_rook,
+      &BitBoard::m_white_queen,
+      &BitBoard::m_white_king,
+  };
+  const int8_t index = static_cast<int8_t>(figure);
+  return this->*kFields[index + (index > 0 ? 5 : 6)];
+}
+
+bool BitBoard::applicable(Turn turn) const noexcept
+{
+  const Position from = turn.from();
+  const Position to = turn.to();
+  const bool white = side() == Color::kWhite;
+  const bitboard_field own = white ? whites() : blacks();
+  const bitboard_field opponent = white ? blacks() : whites();
+  const bitboard_field pawns = white ? m_white_pawn : m_black_pawn;
+  const bitboard_field from_mask = positionToMask(from);
+  const bitboard_field to_mask = positionToMask(to);
+  const bool empty = ((own | opponent) & to_mask) == 0;
+  if ((own & from_mask) == 0) {
+    return false;
+  }
+
+  switch (turn.kind()) {
+    case TurnKind::kQuiet:
+      return empty;
+    case TurnKind::kCapture:
+      return (opponent & to_mask) != 0;
+    case TurnKind::kDoublePush:
+    case TurnKind::kPromotion:
+      return (pawns & from_mask) != 0 && empty;
+    case TurnKind::kPromotionCapture:
+      return (pawns & from_mask) != 0 && (opponent & to_mask) != 0;
+    case TurnKind::kElPassant:
+      return (pawns & from_mask) != 0 && empty
+          && ((white ? m_black_pawn : m_white_pawn)
+              & positionToMask(Position(to.x(), from.y())))
+          != 0;
+    case TurnKind::kCastling: {
+      const bool king_side = to.x() > from.x();
+      const auto rook_from =
+          Position(static_cast<uint8_t>(king_side ? 7 : 0), from.y());
+      const auto rook_to =
+          Position(static_cast<uint8_t>(king_side ? 5 : 3), from.y());
+      return ((white ? m_white_king : m_black_king) & from_mask) != 0 && empty
+          && ((white ? m_white_rook : m_black_rook) & positionToMask(rook_from))
+          != 0
+          && ((own | opponent) & positionToMask(rook_to)) == 0;
+    }
+    case TurnKind::kUnknown:
+    default:
+      return false;
+  }
+}
+
+void BitBoard::executeTurn(Turn turn)
+{
+  invalidate();
+  turn = classify(turn);
+
+  const Position from = turn.from();
+  const Position to = turn.to();
+  const bitboard_field from_mask = positionToMask(from);
+  const bitboard_field to_mask = positionToMask(to);
+  const bool white = side() == Color::kWhite;
+  const Figure figure = get(from);
+  const auto sign = static_cast<int8_t>(white ? 1 : -1);
+  // a classified turn of another position, e.g. a killer or hash move, may
+  // not fit this one; it is dropped like an unknown one
+  if (!applicable(turn)) {
+    return;
+  }
+  bitboard_field& moved = field(figure);
+
+  switch (turn.kind()) {
+    case TurnKind::kCapture:
+      field(get(to)) &= ~to_mask;
+      moved ^= from_mask | to_mask;
+      break;
+    case TurnKind::kQuiet:
+    case TurnKind::kDoublePush:
+      moved ^= from_mask | to_mask;
+      break;
+    case TurnKind::kElPassant:
+      moved ^= from_mask | to_mask;
+      field(static_cast<Figure>(-sign))
+          &= ~positionToMask(Position(to.x(), from.y()));
+      break;
+    case TurnKind::kCastling: {
+      const bool king_side = to.x() > from.x();
+      const auto rook_from =
+          Position(static_cast<uint8_t>(king_side ? 7 : 0), from.y());
+      const auto rook_to =
+          Position(static_cast<uint8_t>(king_side ? 5 : 3), from.y());
+      moved ^= from_mask | to_mask;
+      field(static_cast<Figure>(sign * static_cast<int8_t>(Figure::kRook)))
+          ^= positionToMask(rook_from) | positionToMask(rook_to);
+      break;
+    }
+    case TurnKind::kPromotionCapture:
+      field(get(to)) &= ~to_mask;
+      [[fallthrough]];
+    case TurnKind::kPromotion:
+      moved &= ~from_mask;
+      field(static_cast<Figure>(sign * static_cast<int8_t>(turn.figure())))
+          |= to_mask;
+      break;
+    case TurnKind::kUnknown:
+    default:
+      return;
+  }
+
+  auto flags = static_cast<uint8_t>(
+      static_cast<uint8_t>(m_flags) & g_castling_keep[from.index()]
+      & g_castling_keep[to.index()]
+      & ~static_cast<uint8_t>(Flags::kFlagsElPassant));
+  if (turn.kind() == TurnKind::kDoublePush) {
+    flags |= static_cast<uint8_t>(Flags::kFlagsElPassant);
+  }
+  flags ^= static_cast<uint8_t>(Flags::kFlagsColor);
+  m_flags = static_cast<Flags>(flags);
+
+  const bool pawn = figure == Figure::kWPawn || figure == Figure::kBPawn;
+  m_halfmove_clock = (pawn || turn.capture())
+      ? 0
+      : static_cast<uint16_t>(m_halfmove_clock + 1);
+  if (!white) {
+    m_fullmove_number++;
+  }
+  m_prev_turn = turn;
+}
+
+}  // namespace bitboard
 
-// #include "bitboard/bitboard.hpp"
-
-// #include "bitboard/bitutils.hpp"
-// #include "bitboard/fen.hpp"
-// #include "magic.hpp"
-
-// const char* const bit_board::kStartPosition =
-//     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
-// const bit_board bit_board::kStartBitBoard {bit_board::kStartPosition};
-
-// bit_board::bit_board()
-//     : bit_board(kStartBitBoard)
-// {
-// }
-
-// bit_board::bit_board(std::string_view fen)
-// {
-//   size_t index = 0;
-//   boardFromFen(fen, *this, index);
-// }
-
-// std::string bit_board::fen() const
-// {
-//   return boardToFen(*this);
-// }
 
 // template<BitBoard::Flags flags>
 // class BitBoardHelper
@@ -818,144 +2400,6 @@
 //   }
 // };
 
-// bit_board bit_board::set(Position position, Figure figure) const
-// {
-//   bit_board copy(*this);
-//   bitboard mask = positionToMask(position);
-
-//   switch (figure) {
-//     case Figure::Empty:
-//       copy.removeFigure(~mask);
-//       break;
-//     case Figure::WPawn:
-//       copy.removeFigure(~mask);
-//       copy.m_w_p |= mask;
-//       break;
-//     case Figure::WKnight:
-//       copy.removeFigure(~mask);
-//       copy.m_w_n |= mask;
-//       break;
-//     case Figure::WBishop:
-//       copy.removeFigure(~mask);
-//       copy.m_w_b |= mask;
-//       break;
-//     case Figure::WRook:
-//       copy.removeFigure(~mask);
-//       copy.m_w_r |= mask;
-//       break;
-//     case Figure::WQueen:
-//       copy.removeFigure(~mask);
-//       copy.m_w_q |= mask;
-//       break;
-//     case Figure::WKing:
-//       copy.removeFigure(~mask);
-//       copy.m_w_k |= mask;
-//       break;
-//     case Figure::BPawn:
-//       copy.removeFigure(~mask);
-//       copy.m_b_p |= mask;
-//       break;
-//     case Figure::BKnight:
-//       copy.removeFigure(~mask);
-//       copy.m_b_n |= mask;
-//       break;
-//     case Figure::BBishop:
-//       copy.removeFigure(~mask);
-//       copy.m_b_b |= mask;
-//       break;
-//     case Figure::BRook:
-//       copy.removeFigure(~mask);
-//       copy.m_b_r |= mask;
-//       break;
-//     case Figure::BQueen:
-//       copy.removeFigure(~mask);
-//       copy.m_b_q |= mask;
-//       break;
-//     case Figure::BKing:
-//       copy.removeFigure(~mask);
-//       copy.m_b_k |= mask;
-//       break;
-//   }
-
-//   return copy;
-// }
-
-// bit_board bit_board::setFlags(Flags flags) const
-// {
-//   bit_board board(*this);
-//   board.m_flags = flags;
-//   return board;
-// }
-
-// bit_board bit_board::setTurn(Turn turn) const
-// {
-//   bit_board board(*this);
-//   board.m_turn = turn;
-//   return board;
-// }
-
-// bit_board bit_board::swap(Position p1, Position p2) const
-// {
-//   if (p1 == p2) {
-//     return *this;
-//   }
-//   auto figure1 = get(p1);
-//   auto figure2 = get(p2);
-//   return set(p2, figure1).set(p1, figure2);
-// }
-
-// Figure bit_board::get(Position position) const noexcept
-// {
-//   bitboard mask = positionToMask(position);
-//   if (mask & m_w_p) {
-//     return Figure::WPawn;
-//   }
-//   if (mask & m_w_n) {
-//     return Figure::WKnight;
-//   }
-//   if (mask & m_w_b) {
-//     return Figure::WBishop;
-//   }
-//   if (mask & m_w_r) {
-//     return Figure::WRook;
-//   }
-//   if (mask & m_w_q) {
-//     return Figure::WQueen;
-//   }
-//   if (mask & m_w_k) {
-//     return Figure::WKing;
-//   }
-//   if (mask & m_b_p) {
-//     return Figure::BPawn;
-//   }
-//   if (mask & m_b_n) {
-//     return Figure::BKnight;
-//   }
-//   if (mask & m_b_b) {
-//     return Figure::BBishop;
-//   }
-//   if (mask & m_b_r) {
-//     return Figure::BRook;
-//   }
-//   if (mask & m_b_q) {
-//     return Figure::BQueen;
-//   }
-//   if (mask & m_b_k) {
-//     return Figure::BKing;
-//   }
-//   return Figure::Empty;
-// }
-
-// bit_board::Flags bit_board::getFlags() const noexcept
-// {
-//   return m_flags;
-// }
-
-// Color bit_board::side() const noexcept
-// {
-//   return (m_flags & Flags::flags_color) ? Color::Black : Color::White;
-// }
-
 // template<bit_board::Flags flags>
 // constexpr int generateTemplate(const bit_board& board,
 //                                Turn* storage,
@@ -996,150 +2440,6 @@
 //   // return BitBoardHelper<Flags::flags_default>(*this, out).generate();
 // }
 
-// bit_board bit_board::executeTurn(Color color, Turn turn) const
-// {
-//   bit_board copy(*this);
-
-//   bitboard from = positionToMask(turn.from());
-//   bitboard to = positionToMask(turn.to());
-
-//   if (from & 10448351135499550865ull) {
-//     if (from & 1224979098644774912)  // white king and left rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_white_ooo);
-//     }
-//     if (from & 10376293541461622784ull)  // white king and right rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_white_oo);
-//     }
-//     if (from & 17)  // black king and left rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_black_ooo);
-//     }
-//     if (from & 144)  // black king and right rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_black_oo);
-//     }
-//   }
-//   if (to & 9295429630892703873ull) {
-//     if (to & 72057594037927936)  // white left rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_white_ooo);
-//     }
-//     if (to & 9223372036854775808ull)  // white right rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_white_oo);
-//     }
-//     if (to & 1)  // black left rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_black_ooo);
-//     }
-//     if (to & 128)  // black right rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_black_oo);
-//     }
-//   }
-
-//   if (to & 9295429630892703873ull) {
-//     if (to & 72057594037927936)  // white left rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_white_ooo);
-//     }
-//     if (to & 9223372036854775808ull)  // white right rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_white_oo);
-//     }
-//     if (to & 1)  // black left rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_black_ooo);
-//     }
-//     if (to & 128)  // black right rook
-//     {
-//       copy.m_flags = (Flags)(copy.m_flags & ~flags_black_oo);
-//     }
-//   }
-
-//   copy.m_flags = (Flags)(copy.m_flags & ~flags_el_passant);
-//   if (color == Color::White) {
-//     if ((from & m_w_p & line_2) && (to & line_4)) {
-//       copy.m_flags = (Flags)(copy.m_flags | flags_el_passant);
-//     }
-//   } else {
-//     if ((from & m_b_p & line_7) && (to & line_5)) {
-//       copy.m_flags = (Flags)(copy.m_flags | flags_el_passant);
-//     }
-//   }
-
-//   if (color != Color::White) {
-//     copy.m_flags = (Flags)(copy.m_flags & ~flags_color);
-//   } else {
-//     copy.m_flags = (Flags)(copy.m_flags | flags_color);
-//   }
-
-//   bitboard el_passant =
-//       positionToMask((m_turn.from().index() + m_turn.to().index()) / 2);
-
-//   if (color == Color::White) {
-//     copy.moveFromToWhite(from, to);
-//     copy.removeBlackFigure(~to);
-
-//     // for promotion
-//     if (from & m_w_p & line_7) {
-//       copy.removeWhiteFigure(~to);
-//       copy.promoteWhiteFigure(to, turn.figure());
-//     }
-
-//     // for el_passant
-//     if ((m_flags & flags_el_passant) && (el_passant & to)
-//         && (positionToMask(m_turn.to()) & m_b_p) && (from & m_w_p & line_5)
-//         && (to & ((from >> 9) | (from >> 7))))
-//     {
-//       if (to & ~copy.getBlacks()) {
-//         copy.m_b_p &= ~(to << 8);
-//       }
-//     }
-
-//     // rook moving for castling
-//     if (from & "e1"_bm) {
-//       if ((m_flags & flags_white_oo) && (to & "g1"_bm)) {
-//         copy.moveFromToWhite("h1"_bm, "f1"_bm);
-//       } else if ((m_flags & flags_white_ooo) && (to & "c1"_bm)) {
-//         copy.moveFromToWhite("a1"_bm, "d1"_bm);
-//       }
-//     }
-//   } else {
-//     copy.moveFromToBlack(from, to);
-//     copy.removeWhiteFigure(~to);
-
-//     // for promotion
-//     if (from & m_b_p & line_2) {
-//       copy.removeBlackFigure(~to);
-//       copy.promoteBlackFigure(to, turn.figure());
-//     }
-
-//     // for el_passant
-//     if ((m_flags & flags_el_passant) && (el_passant & to)
-//         && (positionToMask(m_turn.to()) & m_w_p) && (from & m_b_p & line_4)
-//         && (to & ((from << 9) | (from << 7))))
-//     {
-//       if (to & ~copy.getWhites()) {
-//         copy.m_w_p &= ~(to >> 8);
-//       }
-//     }
-
-//     // rook moving for castling
-//     if (from & "e8"_bm) {
-//       if ((m_flags & flags_black_oo) && (to & "g8"_bm)) {
-//         copy.moveFromToBlack("h8"_bm, "f8"_bm);
-//       } else if ((m_flags & flags_black_ooo) && (to & "c8"_bm)) {
-//         copy.moveFromToBlack("a8"_bm, "d8"_bm);
-//       }
-//     }
-//   }
-//   copy.m_turn = turn;
-//   return copy;
-// }
-
 // bool bit_board::testTurn(Turn turn) const
 // {
 //   Turn turns[bit_board::MaxTurns];
@@ -1151,14 +2451,3 @@
 //   std::end(turns);
 // }
 
-// bit_board_hash bit_board::getHash() const
-// {
-//   return m_hash;
-// }
-
-// Turn bit_board::getTurn() const
-// {
-//   return m_turn;
-// }
-
-// bit_board::bit_board(std::nullptr_t) {}
@@ -0,0 +1,82 @@
+#include <algorithm>
+
+#include "bitboard/utils/bitboard_batch.hpp"
+
+#include "bitboard/bitboard.hpp"
+#include "bitboard/utils/bit_utils.hpp"
+#include "kernels.hpp"
+
+namespace bitboard
+{
+
+static_assert(BitBoardBatch::kLanes == kBatchLanes,
+              "BitBoardBatch lanes must match the kernels!");
+
+void BitBoardBatch::add(const BitBoard& board)
+{
+  const std::size_t lane = m_size % kBatchLanes;
+  if (lane == 0) {
+    m_blocks.resize(m_blocks.size() + (kBatchPlanes * kBatchLanes));
+  }
+  bitboard_field* block =
+      m_blocks.data() + ((m_size / kBatchLanes) * kBatchPlanes * kBatchLanes);
+
+  for (std::size_t i = 0; i < 6; ++i) {
+    const auto figure = static_cast<int8_t>(i + 1);
+    block[((kBatchWhitePawn + i) * kBatchLanes) + lane] =
+        board.pieces(static_cast<Figure>(figure));
+    block[((kBatchBlackPawn + i) * kBatchLanes) + lane] =
+        board.pieces(static_cast<Figure>(-figure));
+  }
+  block[(kBatchFlags * kBatchLanes) + lane] =
+      static_cast<uint8_t>(board.flags());
+  const Position el_passant = board.elPassant();
+  block[(kBatchElPassant * kBatchLanes) + lane] =
+      el_passant.valid() ? positionToMask(el_passant) : 0;
+  m_size++;
+}
+
+void BitBoardBatch::clear() noexcept
+{
+  m_blocks.clear();
+  m_size = 0;
+}
+
+void BitBoardBatch::reserve(std::size_t size)
+{
+  m_blocks.reserve(((size + kBatchLanes - 1) / kBatchLanes) * kBatchPlanes
+                   * kBatchLanes);
+}
+
+std::size_t BitBoardBatch::size() const noexcept
+{
+  return m_size;
+}
+
+bool BitBoardBatch::empty() const noexcept
+{
+  return m_size == 0;
+}
+
+void BitBoardBatch::attacks(Color color,
+                            std::span<bitboard_field> out) const noexcept
+{
+  kernels().batch_attacks(m_blocks.data(),
+                          std::min(m_size, out.size()),
+                          color == Color::kWhite,
+                          out.data());
+}
+
+void BitBoardBatch::checkers(std::span<bitboard_field> out) const noexcept
+{
+  kernels().batch_checkers(
+      m_blocks.data(), std::min(m_size, out.size()), out.data());
+}
+
+void BitBoardBatch::legalTurnCounts(std::span<uint8_t> out) const noexcept
+{
+  kernels().batch_legal_counts(
+      m_blocks.data(), std::min(m_size, out.size()), out.data());
+}
+
+}  // namespace bitboard
@@ -0,0 +1,553 @@
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#endif
+
+#include "bitboard/utils/cpu.hpp"
+
+#include "batch_kernels.hpp"
+#include "kernels.hpp"
+#include "magic.hpp"
+
+#if defined(__GNUC__)
+// GCC reports the vectors of the inlined batch kernels at the end of the
+// file, past the pop of batch_kernels.hpp
+#  pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace bitboard
+{
+
+namespace
+{
+
+BITBOARD_KERNEL_BODY bitboard_field sliderAttacks(
+    bitboard_field rooks,
+    bitboard_field bishops,
+    bitboard_field occupancy) noexcept
+{
+  bitboard_field result = 0;
+  for (bitboard_field bit = takeBit(rooks); bit; bit = takeBit(rooks)) {
+    result |=
+        processRook(Position(static_cast<uint8_t>(log2_64(bit))), occupancy);
+  }
+  for (bitboard_field bit = takeBit(bishops); bit; bit = takeBit(bishops)) {
+    result |=
+        processBishop(Position(static_cast<uint8_t>(log2_64(bit))), occupancy);
+  }
+  return result;
+}
+
+// A rank at a time: the byte times kBytes copies it to every byte, the
+// diagonal keeps bit i in byte i and the add carries it to the top bit.
+BITBOARD_KERNEL_BODY void expandBytes(const bitboard_field* planes,
+                                      std::size_t count,
+                                      uint8_t* out) noexcept
+{
+  constexpr bitboard_field kBytes = 0x0101010101010101ULL;
+  constexpr bitboard_field kDiagonal = 0x8040201008040201ULL;
+  constexpr bitboard_field kLow = 0x7F7F7F7F7F7F7F7FULL;
+  for (std::size_t plane = 0; plane < count; ++plane) {
+    for (unsigned rank = 0; rank < 8; ++rank) {
+      const bitboard_field bits =
+          (((planes[plane] >> (rank * 8U)) & 0xFFU) * kBytes) & kDiagonal;
+      const bitboard_field bytes = (((bits + kLow) | bits) >> 7U) & kBytes;
+      if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(out, &bytes, sizeof(bytes));
+        out += sizeof(bytes);
+      } else {
+        for (unsigned file = 0; file < 8; ++file) {
+          *out++ = static_cast<uint8_t>(bytes >> (file * 8U));
+        }
+      }
+    }
+  }
+}
+
+BITBOARD_KERNEL_BODY void expandFloats(const bitboard_field* planes,
+                                       std::size_t count,
+                                       float* out) noexcept
+{
+  for (std::size_t plane = 0; plane < count; ++plane) {
+    for (unsigned square = 0; square < 64; ++square) {
+      *out++ = static_cast<float>((planes[plane] >> square) & 1U);
+    }
+  }
+}
+
+bitboard_field sliderAttacksBaseline(bitboard_field rooks,
+                                     bitboard_field bishops,
+                                     bitboard_field occupancy) noexcept
+{
+  return sliderAttacks(rooks, bishops, occupancy);
+}
+
+void batchAttacksBaseline(const bitboard_field* blocks,
+                          std::size_t size,
+                          bool white,
+                          bitboard_field* out) noexcept
+{
+  batchAttacks(blocks, size, white, out);
+}
+
+void batchCheckersBaseline(const bitboard_field* blocks,
+                           std::size_t size,
+                           bitboard_field* out) noexcept
+{
+  batchCheckers(blocks, size, out);
+}
+
+void batchLegalCountsBaseline(const bitboard_field* blocks,
+                              std::size_t size,
+                              uint8_t* out) noexcept
+{
+  batchLegalCounts(blocks, size, out);
+}
+
+void expandBytesBaseline(const bitboard_field* planes,
+                         std::size_t count,
+                         uint8_t* out) noexcept
+{
+  expandBytes(planes, count, out);
+}
+
+void expandFloatsBaseline(const bitboard_field* planes,
+                          std::size_t count,
+                          float* out) noexcept
+{
+  expandFloats(planes, count, out);
+}
+
+constexpr Kernels kBaselineKernels {
+    CpuLevel::kCpuBaseline,
+    &sliderAttacksBaseline,
+    &batchAttacksBaseline,
+    &batchCheckersBaseline,
+    &batchLegalCountsBaseline,
+    &expandBytesBaseline,
+    &expandFloatsBaseline,
+};
+
+#ifdef BITBOARD_CPU_DISPATCH
+
+template<bool kLeft>
+BITBOARD_TARGET_V3 BITBOARD_KERNEL_BODY __m256i shiftLanes(
+    __m256i value, __m256i amount) noexcept
+{
+  if constexpr (kLeft) {
+    return _mm256_sllv_epi64(value, amount);
+  } else {
+    return _mm256_srlv_epi64(value, amount);
+  }
+}
+
+// Occluded Kogge-Stone fill of the sliders towards higher (kLeft) or lower
+// indices, each lane runs its own direction. Returns the attacks: the fill
+// moved one more step, including the blockers.
+template<bool kLeft>
+BITBOARD_TARGET_V3 BITBOARD_KERNEL_BODY __m256i koggeStoneFill(
+    __m256i sliders,
+    __m256i empty,
+    __m256i shifts,
+    __m256i masks) noexcept
+{
+  const __m256i shifts2 = _mm256_add_epi64(shifts, shifts);
+  const __m256i shifts4 = _mm256_add_epi64(shifts2, shifts2);
+
+  // the mask drops the squares that wrap around the board
+  __m256i propagate = _mm256_and_si256(empty, masks);
+  __m256i fill = sliders;
+  fill = _mm256_or_si256(
+      fill, _mm256_and_si256(propagate, shiftLanes<kLeft>(fill, shifts)));
+  propagate = _mm256_and_si256(propagate, shiftLanes<kLeft>(propagate, shifts));
+  fill = _mm256_or_si256(
+      fill, _mm256_and_si256(propagate, shiftLanes<kLeft>(fill, shifts2)));
+  propagate =
+      _mm256_and_si256(propagate, shiftLanes<kLeft>(propagate, shifts2));
+  fill = _mm256_or_si256(
+      fill, _mm256_and_si256(propagate, shiftLanes<kLeft>(fill, shifts4)));
+  return _mm256_and_si256(shiftLanes<kLeft>(fill, shifts), masks);
+}
+
+// All eight directions of the sliders in two registers, a fixed number of
+// instructions whatever the number of figures.
+BITBOARD_TARGET_V3 BITBOARD_KERNEL_BODY bitboard_field koggeStoneAttacks(
+    bitboard_field rooks,
+    bitboard_field bishops,
+    bitboard_field occupancy) noexcept
+{
+  constexpr auto kNotA = static_cast<long long>(~row_a);
+  constexpr auto kNotH = static_cast<long long>(~row_h);
+  constexpr auto kAll = static_cast<long long>(~bitboard_field {0});
+
+  const auto rook_lanes = static_cast<long long>(rooks);
+  const auto bishop_lanes = static_cast<long long>(bishops);
+  const __m256i sliders =
+      _mm256_set_epi64x(bishop_lanes, bishop_lanes, rook_lanes, rook_lanes);
+  const __m256i empty =
+      _mm256_set1_epi64x(static_cast<long long>(~occupancy));
+
+  const __m256i shifts = _mm256_set_epi64x(7, 9, 8, 1);
+
+  // to higher indices: east, south, south-east, south-west
+  const __m256i left_masks = _mm256_set_epi64x(kNotH, kNotA, kAll, kNotA);
+  const __m256i left = koggeStoneFill<true>(sliders, empty, shifts, left_masks);
+  // to lower indices: west, north, north-west, north-east
+  const __m256i right_masks = _mm256_set_epi64x(kNotA, kNotH, kAll, kNotH);
+  const __m256i right =
+      koggeStoneFill<false>(sliders, empty, shifts, right_masks);
+
+  const __m256i lanes = _mm256_or_si256(left, right);
+  __m128i half = _mm_or_si128(_mm256_castsi256_si128(lanes),
+                              _mm256_extracti128_si256(lanes, 1));
+  half = _mm_or_si128(half, _mm_unpackhi_epi64(half, half));
+  return static_cast<bitboard_field>(_mm_cvtsi128_si64(half));
+}
+
+// Bytes of 32 bits: every byte of the result picks the byte of its bit and
+// keeps only that bit.
+BITBOARD_TARGET_V3 BITBOARD_KERNEL_BODY void expandBytesAvx2(
+    const bitboard_field* planes, std::size_t count, uint8_t* out) noexcept
+{
+  const __m256i spread = _mm256_setr_epi64x(0x0000000000000000LL,
+                                            0x0101010101010101LL,
+                                            0x0202020202020202LL,
+                                            0x0303030303030303LL);
+  const __m256i bits =
+      _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ULL));
+  const __m256i ones = _mm256_set1_epi8(1);
+  for (std::size_t plane = 0; plane < count; ++plane) {
+    for (unsigned half = 0; half < 2; ++half) {
+      const auto value = static_cast<int>(
+          static_cast<uint32_t>(planes[plane] >> (half * 32U)));
+      __m256i bytes = _mm256_shuffle_epi8(_mm256_set1_epi32(value), spread);
+      bytes = _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bits), bits);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                          _mm256_and_si256(bytes, ones));
+      out += 32;
+    }
+  }
+}
+
+// Floats of 8 bits, one compare against the bit of every lane.
+BITBOARD_TARGET_V3 BITBOARD_KERNEL_BODY void expandFloatsAvx2(
+    const bitboard_field* planes, std::size_t count, float* out) noexcept
+{
+  const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  const __m256 ones = _mm256_set1_ps(1.0F);
+  for (std::size_t plane = 0; plane < count; ++plane) {
+    for (unsigned rank = 0; rank < 8; ++rank) {
+      const auto value =
+          static_cast<int>((planes[plane] >> (rank * 8U)) & 0xFFU);
+      const __m256i set = _mm256_cmpeq_epi32(
+          _mm256_and_si256(_mm256_set1_epi32(value), bits), bits);
+      _mm256_storeu_ps(out, _mm256_and_ps(_mm256_castsi256_ps(set), ones));
+      out += 8;
+    }
+  }
+}
+
+// The bitboard is the mask of a masked move, 64 bytes or 16 floats at once.
+BITBOARD_TARGET_V4 BITBOARD_KERNEL_BODY void expandBytesAvx512(
+    const bitboard_field* planes, std::size_t count, uint8_t* out) noexcept
+{
+  const __m512i ones = _mm512_set1_epi8(1);
+  for (std::size_t plane = 0; plane < count; ++plane) {
+    _mm512_storeu_si512(out, _mm512_maskz_mov_epi8(planes[plane], ones));
+    out += 64;
+  }
+}
+
+BITBOARD_TARGET_V4 BITBOARD_KERNEL_BODY void expandFloatsAvx512(
+    const bitboard_field* planes, std::size_t count, float* out) noexcept
+{
+  const __m512 ones = _mm512_set1_ps(1.0F);
+  for (std::size_t plane = 0; plane < count; ++plane) {
+    for (unsigned quarter = 0; quarter < 4; ++quarter) {
+      const auto mask =
+          static_cast<__mmask16>(planes[plane] >> (quarter * 16U));
+      _mm512_storeu_ps(out, _mm512_maskz_mov_ps(mask, ones));
+      out += 16;
+    }
+  }
+}
+
+BITBOARD_TARGET_V2 bitboard_field sliderAttacksV2(
+    bitboard_field rooks,
+    bitboard_field bishops,
+    bitboard_field occupancy) noexcept
+{
+  return sliderAttacks(rooks, bishops, occupancy);
+}
+
+BITBOARD_TARGET_V3 bitboard_field sliderAttacksV3(
+    bitboard_field rooks,
+    bitboard_field bishops,
+    bitboard_field occupancy) noexcept
+{
+  return koggeStoneAttacks(rooks, bishops, occupancy);
+}
+
+BITBOARD_TARGET_V4 bitboard_field sliderAttacksV4(
+    bitboard_field rooks,
+    bitboard_field bishops,
+    bitboard_field occupancy) noexcept
+{
+  return koggeStoneAttacks(rooks, bishops, occupancy);
+}
+
+BITBOARD_TARGET_V2 void batchAttacksV2(const bitboard_field* blocks,
+                                       std::size_t size,
+                                       bool white,
+                                       bitboard_field* out) noexcept
+{
+  batchAttacks(blocks, size, white, out);
+}
+
+BITBOARD_TARGET_V2 void batchCheckersV2(const bitboard_field* blocks,
+                                        std::size_t size,
+                                        bitboard_field* out) noexcept
+{
+  batchCheckers(blocks, size, out);
+}
+
+BITBOARD_TARGET_V2 void batchLegalCountsV2(const bitboard_field* blocks,
+                                           std::size_t size,
+                                           uint8_t* out) noexcept
+{
+  batchLegalCounts(blocks, size, out);
+}
+
+BITBOARD_TARGET_V3 void batchAttacksV3(const bitboard_field* blocks,
+                                       std::size_t size,
+                                       bool white,
+                                       bitboard_field* out) noexcept
+{
+  batchAttacks(blocks, size, white, out);
+}
+
+BITBOARD_TARGET_V3 void batchCheckersV3(const bitboard_field* blocks,
+                                        std::size_t size,
+                                        bitboard_field* out) noexcept
+{
+  batchCheckers(blocks, size, out);
+}
+
+BITBOARD_TARGET_V3 void batchLegalCountsV3(const bitboard_field* blocks,
+                                           std::size_t size,
+                                           uint8_t* out) noexcept
+{
+  batchLegalCounts(blocks, size, out);
+}
+
+BITBOARD_TARGET_V4 void batchAttacksV4(const bitboard_field* blocks,
+                                       std::size_t size,
+                                       bool white,
+                                       bitboard_field* out) noexcept
+{
+  batchAttacks(blocks, size, white, out);
+}
+
+BITBOARD_TARGET_V4 void batchCheckersV4(const bitboard_field* blocks,
+                                        std::size_t size,
+                                        bitboard_field* out) noexcept
+{
+  batchCheckers(blocks, size, out);
+}
+
+BITBOARD_TARGET_V4 void batchLegalCountsV4(const bitboard_field* blocks,
+                                           std::size_t size,
+                                           uint8_t* out) noexcept
+{
+  batchLegalCounts(blocks, size, out);
+}
+
+BITBOARD_TARGET_V2 void expandBytesV2(const bitboard_field* planes,
+                                      std::size_t count,
+                                      uint8_t* out) noexcept
+{
+  expandBytes(planes, count, out);
+}
+
+BITBOARD_TARGET_V2 void expandFloatsV2(const bitboard_field* planes,
+                                       std::size_t count,
+                                       float* out) noexcept
+{
+  expandFloats(planes, count, out);
+}
+
+BITBOARD_TARGET_V3 void expandBytesV3(const bitboard_field* planes,
+                                      std::size_t count,
+                                      uint8_t* out) noexcept
+{
+  expandBytesAvx2(planes, count, out);
+}
+
+BITBOARD_TARGET_V3 void expandFloatsV3(const bitboard_field* planes,
+                                       std::size_t count,
+                                       float* out) noexcept
+{
+  expandFloatsAvx2(planes, count, out);
+}
+
+BITBOARD_TARGET_V4 void expandBytesV4(const bitboard_field* planes,
+                                      std::size_t count,
+                                      uint8_t* out) noexcept
+{
+  expandBytesAvx512(planes, count, out);
+}
+
+BITBOARD_TARGET_V4 void expandFloatsV4(const bitboard_field* planes,
+                                       std::size_t count,
+                                       float* out) noexcept
+{
+  expandFloatsAvx512(planes, count, out);
+}
+
+constexpr Kernels kV2Kernels {
+    CpuLevel::kCpuV2,
+    &sliderAttacksV2,
+    &batchAttacksV2,
+    &batchCheckersV2,
+    &batchLegalCountsV2,
+    &expandBytesV2,
+    &expandFloatsV2,
+};
+
+constexpr Kernels kV3Kernels {
+    CpuLevel::kCpuV3,
+    &sliderAttacksV3,
+    &batchAttacksV3,
+    &batchCheckersV3,
+    &batchLegalCountsV3,
+    &expandBytesV3,
+    &expandFloatsV3,
+};
+
+constexpr Kernels kV4Kernels {
+    CpuLevel::kCpuV4,
+    &sliderAttacksV4,
+    &batchAttacksV4,
+    &batchCheckersV4,
+    &batchLegalCountsV4,
+    &expandBytesV4,
+    &expandFloatsV4,
+};
+
+CpuLevel detectLevel() noexcept
+{
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("popcnt") == 0
+      || __builtin_cpu_supports("sse4.2") == 0)
+  {
+    return CpuLevel::kCpuBaseline;
+  }
+  if (__builtin_cpu_supports("avx2") == 0 || __builtin_cpu_supports("bmi") == 0
+      || __builtin_cpu_supports("bmi2") == 0
+      || __builtin_cpu_supports("fma") == 0)
+  {
+    return CpuLevel::kCpuV2;
+  }
+  if (__builtin_cpu_supports("avx512f") == 0
+      || __builtin_cpu_supports("avx512bw") == 0
+      || __builtin_cpu_supports("avx512dq") == 0
+      || __builtin_cpu_supports("avx512vl") == 0)
+  {
+    return CpuLevel::kCpuV3;
+  }
+  return CpuLevel::kCpuV4;
+}
+
+// Applies the BITBOARD_CPU_LEVEL limit, unknown names are ignored.
+CpuLevel limitLevel(CpuLevel level) noexcept
+{
+  const char* limit = std::getenv("BITBOARD_CPU_LEVEL");
+  if (limit == nullptr) {
+    return level;
+  }
+  for (const CpuLevel lower : {CpuLevel::kCpuBaseline,
+                               CpuLevel::kCpuV2,
+                               CpuLevel::kCpuV3,
+                               CpuLevel::kCpuV4})
+  {
+    if (std::string_view(limit) == cpuLevelName(lower)) {
+      return lower < level ? lower : level;
+    }
+  }
+  return level;
+}
+
+#endif
+
+const Kernels& selectKernels() noexcept
+{
+#ifdef BITBOARD_CPU_DISPATCH
+  switch (limitLevel(detectLevel())) {
+    case CpuLevel::kCpuV4:
+      return kV4Kernels;
+    case CpuLevel::kCpuV3:
+      return kV3Kernels;
+    case CpuLevel::kCpuV2:
+      return kV2Kernels;
+    case CpuLevel::kCpuBaseline:
+    default:
+      break;
+  }
+#endif
+  return kBaselineKernels;
+}
+
+}  // namespace
+
+const Kernels& kernels() noexcept
+{
+  static const Kernels& result = selectKernels();
+  return result;
+}
+
+const Kernels* kernels(CpuLevel level) noexcept
+{
+#ifdef BITBOARD_CPU_DISPATCH
+  if (level > detectLevel()) {
+    return nullptr;
+  }
+  switch (level) {
+    case CpuLevel::kCpuV4:
+      return &kV4Kernels;
+    case CpuLevel::kCpuV3:
+      return &kV3Kernels;
+    case CpuLevel::kCpuV2:
+      return &kV2Kernels;
+    case CpuLevel::kCpuBaseline:
+    default:
+      break;
+  }
+#endif
+  return level == CpuLevel::kCpuBaseline ? &kBaselineKernels : nullptr;
+}
+
+CpuLevel cpuLevel() noexcept
+{
+  return kernels().level;
+}
+
+const char* cpuLevelName(CpuLevel level) noexcept
+{
+  switch (level) {
+    case CpuLevel::kCpuV2:
+      return "x86-64-v2";
+    case CpuLevel::kCpuV3:
+      return "x86-64-v3";
+    case CpuLevel::kCpuV4:
+      return "x86-64-v4";
+    case CpuLevel::kCpuBaseline:
+    default:
+      return "x86-64";
+  }
+}
+
+}  // namespace bitboard
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bitboard/utils/epd_reader.hpp"
+
+#include "bitboard/utils/fen_parser.hpp"
+#include "mapped_file.hpp"
+
+namespace bitboard
+{
+
+namespace
+{
+
+// Returns the offset of the first line that starts inside the chunk
+// beginning at `offset`.
+std::size_t alignToLine(std::string_view data, std::size_t offset)
+{
+  if (offset == 0 || data[offset - 1] == '\n') {
+    return offset;
+  }
+  const auto* newline = static_cast<const char*>(
+      std::memchr(data.data() + offset, '\n', data.size() - offset));
+  return newline == nullptr
+      ? data.size()
+      : static_cast<std::size_t>(newline - data.data()) + 1;
+}
+
+}  // namespace
+
+EpdReader::EpdReader(const char* path)
+{
+  m_valid = mapFile(path, m_mapping, m_mapping_size);
+  if (m_mapping != nullptr) {
+    m_data =
+        std::string_view(static_cast<const char*>(m_mapping), m_mapping_size);
+  }
+}
+
+EpdReader::EpdReader(std::string_view data) noexcept
+    : m_data(data)
+    , m_valid(true)
+{
+}
+
+EpdReader::~EpdReader()
+{
+  if (m_mapping != nullptr) {
+    unmapFile(m_mapping, m_mapping_size);
+  }
+}
+
+bool EpdReader::valid() const noexcept
+{
+  return m_valid;
+}
+
+std::string_view EpdReader::data() const noexcept
+{
+  return m_data;
+}
+
+std::size_t EpdReader::read(const Callback& callback,
+                            unsigned threads,
+                            bool ordered,
+                            std::size_t chunk_size) const
+{
+  if (m_data.empty()) {
+    return 0;
+  }
+
+  chunk_size = std::max<std::size_t>(chunk_size, 1);
+  const std::size_t chunks = ((m_data.size() - 1) / chunk_size) + 1;
+
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  threads = static_cast<unsigned>(
+      std::min<std::size_t>(threads, chunks));
+
+  std::atomic<std::size_t> next_chunk {0};
+  std::atomic<std::size_t> total {0};
+  std::mutex turn_mutex;
+  std::condition_variable turn_changed;
+  std::size_t turn = 0;
+
+  const auto worker = [&]
+  {
+    const auto batch = std::make_unique<BitBoard[]>(kEpdBatchSize);
+
+    for (std::size_t chunk = next_chunk++; chunk < chunks;
+         chunk = next_chunk++)
+    {
+      std::unique_lock<std::mutex> lock(turn_mutex, std::defer_lock);
+
+      const auto flush = [&](std::size_t count)
+      {
+        if (count == 0) {
+          return;
+        }
+        if (ordered && !lock.owns_lock()) {
+          lock.lock();
+          turn_changed.wait(lock, [&] { return turn == chunk; });
+        }
+        callback(std::span<const BitBoard>(batch.get(), count), chunk);
+        total += count;
+      };
+
+      const std::size_t end =
+          std::min(m_data.size(), (chunk + 1) * chunk_size);
+      std::size_t line_begin = alignToLine(m_data, chunk * chunk_size);
+      std::size_t count = 0;
+
+      while (line_begin < end) {
+        const auto* newline = static_cast<const char*>(std::memchr(
+            m_data.data() + line_begin, '\n', m_data.size() - line_begin));
+        const std::size_t line_end = newline == nullptr
+            ? m_data.size()
+            : static_cast<std::size_t>(newline - m_data.data());
+
+        if (boardFromFen(
+                m_data.substr(line_begin, line_end - line_begin), batch[count])
+            == FenStatus::kFenOk)
+        {
+          if (++count == kEpdBatchSize) {
+            flush(count);
+            count = 0;
+          }
+        }
+        line_begin = line_end + 1;
+      }
+      flush(count);
+
+      if (ordered) {
+        if (!lock.owns_lock()) {
+          lock.lock();
+          turn_changed.wait(lock, [&] { return turn == chunk; });
+        }
+        turn++;
+        lock.unlock();
+        turn_changed.notify_all();
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (unsigned i = 1; i < threads; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : workers) {
+    thread.join();
+  }
+
+  return total;
+}
+
+}  // namespace bitboard
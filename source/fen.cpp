@@ -1,255 +1,319 @@
-// include <algorithm>
-// #include <array>
-// #include <map>
-
-// #include "bitboard/fen.hpp"
-
-// #include "bitboard/bitboard.hpp"
-
-// constexpr static std::array<char, 3> separators {' ', '\n', '\t'};
-
-// constexpr const std::string_view start_string = "startpos";
-
-// void skipSeperators(std ::string_view data, size_t& index)
-// {
-//   while (index < data.size()
-//          && std::find(separators.begin(), separators.end(), data[index])
-//              != separators.end())
-//   {
-//     index++;
-//   }
-// }
-
-// std::string_view readStringPart(std::string_view data, size_t& index)
-// {
-//   skipSeperators(data, index);
-//   auto begin = index;
-//   while (index < data.size()
-//          && std::find(separators.begin(), separators.end(), data[index])
-//              == separators.end())
-//   {
-//     index++;
-//   }
-//   auto end = index;
-//   skipSeperators(data, index);
-//   return data.substr(begin, end - begin);
-// }
-
-// void boardFromFen(std::string_view fen, bit_board& board, size_t& index)
-// {
-//   board = bit_board {nullptr};
-
-//   const static std::map<char, Figure> s_to_f {{' ', Figure::Empty},
-//                                               {'p', Figure::BPawn},
-//                                               {'n', Figure::BKnight},
-//                                               {'b', Figure::BBishop},
-//                                               {'r', Figure::BRook},
-//                                               {'q', Figure::BQueen},
-//                                               {'k', Figure::BKing},
-//                                               {'P', Figure::WPawn},
-//                                               {'N', Figure::WKnight},
-//                                               {'B', Figure::WBishop},
-//                                               {'R', Figure::WRook},
-//                                               {'Q', Figure::WQueen},
-//                                               {'K', Figure::WKing}};
-
-//   skipSeperators(fen, index);
-
-//   if (fen.substr(index).starts_with(start_string)) {
-//     board = bit_board {};
-//     index += start_string.size();
-//     return;
-//   }
-
-//   size_t position = 0;
-//   for (; index < fen.size() && position != 64; ++index) {
-//     const char character = fen.at(index);
-
-//     if (character == ' ')
-//       ;
-//     else if (s_to_f.contains(character)) {
-//       board = board.set(Position(position), s_to_f.at(character));
-//       position++;
-//     } else if (std::isdigit(character)) {
-//       if (int digit = character - '0'; digit > 0 && digit < 9) {
-//         position += digit;
-//       }
-//     } else if (character == '/') {
-//       position = ((position - 1) / 8) * 8 + 8;
-//     } else {
-//       throw FenError("invalid character");
-//     }
-//   }
-//   ++index;
-
-//   if (position != 64) {
-//     throw FenError("incompleted fen board");
-//   }
-
-//   std::string current_move, rooking, pawn;
-//   std::string static_move, move_counter;
-
-//   current_move = readStringPart(fen, index);
-
-//   if (index == fen.size()) {
-//     throw FenError("incompleted fen");
-//   }
-
-//   rooking = readStringPart(fen, index);
-
-//   if (index == fen.size()) {
-//     throw FenError("incompleted fen");
-//   }
-
-//   pawn = readStringPart(fen, index);
-
-//   if (index == fen.size()) {
-//     throw FenError("incompleted fen");
-//   }
-
-//   static_move = readStringPart(fen, index);
-
-//   if (index == fen.size()) {
-//     throw FenError("incompleted fen");
-//   }
-
-//   move_counter = readStringPart(fen, index);
-
-//   bit_board::Flags flags = bit_board::flags_default;
-
-//   if (current_move.front() == 'w')
-//     ;
-//   else if (current_move == "b") {
-//     flags = (bit_board::Flags)(flags | bit_board::flags_color);
-//   } else {
-//     throw FenError("incorrect current side");
-//   }
-
-//   if (pawn.size() == 2) {
-//     auto position = Position(pawn);
-//     if (!position.isValid()) {
-//       throw FenError("incorrect el passant");
-//     }
-//     if ((flags & bit_board::flags_color) == 0) {
-//       board = board.setTurn(
-//           Turn(Position(pawn).index() - 8, Position(pawn).index() + 8));
-//     } else {
-//       board = board.setTurn(
-//           Turn(Position(pawn).index() + 8, Position(pawn).index() - 8));
-//     }
-//     flags = (bit_board::Flags)(flags | bit_board::flags_el_passant);
-//   }
-
-//   for (char x : rooking) {
-//     switch (x) {
-//       case 'K':
-//         flags = (bit_board::Flags)(flags | bit_board::flags_white_oo);
-//         break;
-//       case 'Q':
-//         flags = (bit_board::Flags)(flags | bit_board::flags_white_ooo);
-//         break;
-//       case 'k':
-//         flags = (bit_board::Flags)(flags | bit_board::flags_black_oo);
-//         break;
-//       case 'q':
-//         flags = (bit_board::Flags)(flags | bit_board::flags_black_ooo);
-//         break;
-//       case '-':
-//         break;
-//       default:
-//         throw FenError("incorrect castling");
-//     }
-//   }
-//   board = board.setFlags(flags);
-// }
-
-// std::string boardToFen(const bit_board& board)
-// {
-//   const static std::map<Figure, char> f_to_s = {{Figure::Empty, ' '},
-//                                                 {Figure::BPawn, 'p'},
-//                                                 {Figure::BKnight, 'n'},
-//                                                 {Figure::BBishop, 'b'},
-//                                                 {Figure::BRook, 'r'},
-//                                                 {Figure::BQueen, 'q'},
-//                                                 {Figure::BKing, 'k'},
-//                                                 {Figure::WPawn, 'P'},
-//                                                 {Figure::WKnight, 'N'},
-//                                                 {Figure::WBishop, 'B'},
-//                                                 {Figure::WRook, 'R'},
-//                                                 {Figure::WQueen, 'Q'},
-//                                                 {Figure::WKing, 'K'}};
-//   char buffer[128] = {0};
-//   size_t position = 0;
-//   size_t bypass_counter = 0;
-//   for (size_t i = 0; i < 64; i++) {
-//     if (i % 8 == 0 && i != 0) {
-//       if (bypass_counter != 0) {
-//         buffer[position] = '0' + bypass_counter;
-//         position++;
-//         bypass_counter = 0;
-//       }
-
-//       buffer[position] = '/';
-//       position++;
-//     }
-//     if (board.get(i).isEmpty()) {
-//       bypass_counter++;
-//     } else {
-//       if (bypass_counter != 0) {
-//         buffer[position] = '0' + bypass_counter;
-//         position++;
-//         bypass_counter = 0;
-//       }
-//       buffer[position] = f_to_s.at(board.get(i));
-//       position++;
-//     }
-//   }
-
-//   if (bypass_counter != 0) {
-//     buffer[position] = '0' + bypass_counter;
-//     position++;
-//   }
-
-//   auto rooking_flags = board.getFlags();
-//   std::string string(buffer);
-//   string += ' ';
-//   string.push_back(rooking_flags & bit_board::flags_color ? 'b' : 'w');
-//   string += ' ';
-//   if ((rooking_flags
-//        & (bit_board::flags_black_oo | bit_board::flags_black_ooo
-//           | bit_board::flags_white_oo | bit_board::flags_white_ooo))
-//       == 0)
-//   {
-//     string.push_back('-');
-//   } else {
-//     if (rooking_flags & bit_board::flags_white_oo) {
-//       string += 'K';
-//     }
-//     if (rooking_flags & bit_board::flags_white_ooo) {
-//       string += 'Q';
-//     }
-//     if (rooking_flags & bit_board::flags_black_oo) {
-//       string += 'k';
-//     }
-//     if (rooking_flags & bit_board::flags_black_ooo) {
-//       string += 'q';
-//     }
-//   }
-//   string += ' ';
-
-//   if (rooking_flags & bit_board::flags_el_passant) {
-//     string +=
-//         Position((board.getTurn().from().index() +
-//         board.getTurn().to().index())
-//                  / 2)
-//             .toString();
-//   } else {
-//     string += '-';
-//   }
-
-//   string += ' ';
-//   string += std::to_string(0);
-//   string += ' ';
-//   string += std::to_string(0);
-//   return string;
-// }
+#include <array>
+
+#include "bitboard/utils/fen_parser.hpp"
+
+#include "bitboard/bitboard.hpp"
+#include "bitboard/utils/bit_utils.hpp"
+
+namespace bitboard
+{
+
+namespace
+{
+
+// Character classes of the piece placement field. Pieces map to the index of
+// their bitboard (white pawn .. black king), digits carry the number of
+// skipped squares in the low bits.
+constexpr uint8_t kCharPieceLast = 11;
+constexpr uint8_t kCharDigit = 0x10;
+constexpr uint8_t kCharSlash = 0x20;
+constexpr uint8_t kCharSeparator = 0x40;
+constexpr uint8_t kCharInvalid = 0x80;
+
+constexpr std::string_view kPieceChars = "PNBRQKpnbrqk";
+constexpr std::string_view kStartString = "startpos";
+
+constexpr std::array<uint8_t, 256> generateCharTable()
+{
+  std::array<uint8_t, 256> result {};
+  for (auto& value : result) {
+    value = kCharInvalid;
+  }
+  for (uint8_t i = 0; i < kPieceChars.size(); ++i) {
+    result[static_cast<uint8_t>(kPieceChars[i])] = i;
+  }
+  for (uint8_t digit = 1; digit <= 8; ++digit) {
+    result['0' + digit] = kCharDigit | digit;
+  }
+  result['/'] = kCharSlash;
+  result[' '] = kCharSeparator;
+  result['\t'] = kCharSeparator;
+  result['\n'] = kCharSeparator;
+  result['\r'] = kCharSeparator;
+  return result;
+}
+
+constexpr std::array<uint8_t, 256> generateCastlingTable()
+{
+  std::array<uint8_t, 256> result {};
+  for (auto& value : result) {
+    value = kCharInvalid;
+  }
+  result['K'] = static_cast<uint8_t>(BitBoard::Flags::kFlagsWhiteOo);
+  result['Q'] = static_cast<uint8_t>(BitBoard::Flags::kFlagsWhiteOoo);
+  result['k'] = static_cast<uint8_t>(BitBoard::Flags::kFlagsBlackOo);
+  result['q'] = static_cast<uint8_t>(BitBoard::Flags::kFlagsBlackOoo);
+  return result;
+}
+
+constexpr auto g_fen_chars = generateCharTable();
+constexpr auto g_castling_chars = generateCastlingTable();
+
+constexpr bool isSeparator(char character)
+{
+  return g_fen_chars[static_cast<uint8_t>(character)] == kCharSeparator;
+}
+
+constexpr bool isDigit(char character)
+{
+  return character >= '0' && character <= '9';
+}
+
+std::string_view readField(std::string_view data, std::size_t& index)
+{
+  while (index < data.size() && isSeparator(data[index])) {
+    index++;
+  }
+  const std::size_t begin = index;
+  while (index < data.size() && !isSeparator(data[index])) {
+    index++;
+  }
+  return data.substr(begin, index - begin);
+}
+
+bool readCounter(std::string_view field, uint16_t& counter)
+{
+  uint32_t value = 0;
+  for (const char character : field) {
+    if (!isDigit(character)) {
+      return false;
+    }
+    value = (value * 10) + static_cast<uint32_t>(character - '0');
+    if (value > UINT16_MAX) {
+      return false;
+    }
+  }
+  counter = static_cast<uint16_t>(value);
+  return true;
+}
+
+}  // namespace
+
+FenStatus boardFromFen(std::string_view fen,
+                       BitBoard& board,
+                       std::size_t& index) noexcept
+{
+  if (index > fen.size()) {
+    return FenStatus::kFenIncomplete;
+  }
+  while (index < fen.size() && isSeparator(fen[index])) {
+    index++;
+  }
+
+  // the word alone, "startposition" is no start position
+  const std::string_view rest = fen.substr(index);
+  if (rest.starts_with(kStartString)
+      && (rest.size() == kStartString.size()
+          || isSeparator(rest[kStartString.size()])))
+  {
+    board = kStartBitBoard;
+    index += kStartString.size();
+    return FenStatus::kFenOk;
+  }
+
+  bitboard_field fields[12] = {};
+  std::size_t cursor = index;
+  uint8_t square = 0;
+  uint8_t file = 0;
+
+  for (; cursor < fen.size(); ++cursor) {
+    const uint8_t code = g_fen_chars[static_cast<uint8_t>(fen[cursor])];
+    if (code <= kCharPieceLast) {
+      if (file == kBoardSize) {
+        return FenStatus::kFenInvalidBoard;
+      }
+      fields[code] |= getBitBoardOne() << square;
+      square++;
+      file++;
+    } else if ((code & kCharDigit) != 0) {
+      const uint8_t skip = code & 0x0F;
+      file += skip;
+      square += skip;
+      if (file > kBoardSize) {
+        return FenStatus::kFenInvalidBoard;
+      }
+    } else if (code == kCharSlash) {
+      if (file != kBoardSize || square == kPositionInvalid) {
+        return FenStatus::kFenInvalidBoard;
+      }
+      file = 0;
+    } else if (code == kCharSeparator) {
+      break;
+    } else {
+      return FenStatus::kFenInvalidCharacter;
+    }
+  }
+
+  if (square != kPositionInvalid || file != kBoardSize) {
+    return FenStatus::kFenInvalidBoard;
+  }
+
+  uint8_t flags = static_cast<uint8_t>(BitBoard::Flags::kFlagsDefault);
+
+  const auto side = readField(fen, cursor);
+  if (side.empty()) {
+    return FenStatus::kFenIncomplete;
+  }
+  if (side == "b") {
+    flags |= static_cast<uint8_t>(BitBoard::Flags::kFlagsColor);
+  } else if (side != "w") {
+    return FenStatus::kFenInvalidSide;
+  }
+
+  const auto castling = readField(fen, cursor);
+  if (castling.empty()) {
+    return FenStatus::kFenIncomplete;
+  }
+  if (castling != "-") {
+    for (const char character : castling) {
+      const uint8_t code = g_castling_chars[static_cast<uint8_t>(character)];
+      if (code == kCharInvalid) {
+        return FenStatus::kFenInvalidCastling;
+      }
+      flags |= code;
+    }
+  }
+
+  const auto el_passant = readField(fen, cursor);
+  if (el_passant.empty()) {
+    return FenStatus::kFenIncomplete;
+  }
+  Turn prev_turn;
+  if (el_passant != "-") {
+    const auto position = Position(el_passant);
+    const bool white_side =
+        (flags & static_cast<uint8_t>(BitBoard::Flags::kFlagsColor)) == 0;
+    // the square behind a pawn that has just made a double move
+    if (!position.valid() || position.y() != (white_side ? 2 : 5)) {
+      return FenStatus::kFenInvalidElPassant;
+    }
+    const auto up = Position(position.index() - kBoardSize);
+    const auto down = Position(position.index() + kBoardSize);
+    prev_turn = white_side ? Turn(up, down) : Turn(down, up);
+    flags |= static_cast<uint8_t>(BitBoard::Flags::kFlagsElPassant);
+  }
+
+  // counters are optional, EPD lines continue with operations instead
+  uint16_t halfmove_clock = 0;
+  uint16_t fullmove_number = 1;
+  std::size_t counters_end = cursor;
+  for (uint16_t* counter : {&halfmove_clock, &fullmove_number}) {
+    std::size_t next = counters_end;
+    const auto field = readField(fen, next);
+    if (field.empty() || !isDigit(field.front())) {
+      break;
+    }
+    if (!readCounter(field, *counter)) {
+      return FenStatus::kFenInvalidCounter;
+    }
+    counters_end = next;
+  }
+
+  board.setPieces(fields);
+  board.m_prev_turn = prev_turn;
+  board.m_halfmove_clock = halfmove_clock;
+  board.m_fullmove_number = fullmove_number;
+  board.m_flags = static_cast<BitBoard::Flags>(flags);
+
+  index = counters_end;
+  return FenStatus::kFenOk;
+}
+
+FenStatus boardFromFen(std::string_view fen, BitBoard& board) noexcept
+{
+  std::size_t index = 0;
+  return boardFromFen(fen, board, index);
+}
+
+std::size_t boardToFen(const BitBoard& board, char* out) noexcept
+{
+  constexpr std::string_view kFigureChars = "kqrbnp PNBRQK";
+
+  std::size_t position = 0;
+  uint8_t bypass_counter = 0;
+  for (uint8_t i = 0; i < 64; i++) {
+    if (i % kBoardSize == 0 && i != 0) {
+      if (bypass_counter != 0) {
+        out[position++] = static_cast<char>('0' + bypass_counter);
+        bypass_counter = 0;
+      }
+      out[position++] = '/';
+    }
+    const auto figure = board.get(Position(i));
+    if (figure == Figure::kEmpty) {
+      bypass_counter++;
+    } else {
+      if (bypass_counter != 0) {
+        out[position++] = static_cast<char>('0' + bypass_counter);
+        bypass_counter = 0;
+      }
+      out[position++] = kFigureChars[static_cast<std::size_t>(
+          static_cast<int8_t>(figure) + static_cast<int8_t>(Figure::kKing))];
+    }
+  }
+  if (bypass_counter != 0) {
+    out[position++] = static_cast<char>('0' + bypass_counter);
+  }
+
+  const auto flags = static_cast<uint8_t>(board.flags());
+  const auto has = [flags](BitBoard::Flags flag)
+  { return (flags & static_cast<uint8_t>(flag)) != 0; };
+
+  out[position++] = ' ';
+  out[position++] = has(BitBoard::Flags::kFlagsColor) ? 'b' : 'w';
+  out[position++] = ' ';
+
+  const std::size_t castling_begin = position;
+  if (has(BitBoard::Flags::kFlagsWhiteOo)) {
+    out[position++] = 'K';
+  }
+  if (has(BitBoard::Flags::kFlagsWhiteOoo)) {
+    out[position++] = 'Q';
+  }
+  if (has(BitBoard::Flags::kFlagsBlackOo)) {
+    out[position++] = 'k';
+  }
+  if (has(BitBoard::Flags::kFlagsBlackOoo)) {
+    out[position++] = 'q';
+  }
+  if (position == castling_begin) {
+    out[position++] = '-';
+  }
+  out[position++] = ' ';
+
+  if (const auto square = board.elPassant(); square.valid()) {
+    out[position++] = static_cast<char>('a' + square.x());
+    out[position++] = static_cast<char>('8' - square.y());
+  } else {
+    out[position++] = '-';
+  }
+
+  for (const uint16_t counter : {board.halfmoveClock(), board.fullmoveNumber()})
+  {
+    out[position++] = ' ';
+    char digits[5];
+    std::size_t count = 0;
+    uint16_t value = counter;
+    do {
+      digits[count++] = static_cast<char>('0' + (value % 10));
+      value /= 10;
+    } while (value != 0);
+    while (count != 0) {
+      out[position++] = digits[--count];
+    }
+  }
+
+  return position;
+}
+
+}  // namespace bitboard
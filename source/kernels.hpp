@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bitboard/utils/bit_const.hpp"
+#include "bitboard/utils/cpu.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define BITBOARD_CPU_DISPATCH
+#  define BITBOARD_KERNEL_BODY [[gnu::always_inline]] inline
+#  define BITBOARD_TARGET_V2 __attribute__((target("popcnt,sse4.2")))
+#  define BITBOARD_TARGET_V3 \
+    __attribute__((target("popcnt,sse4.2,avx2,bmi,bmi2,lzcnt,fma")))
+#  define BITBOARD_TARGET_V4 \
+    __attribute__((target( \
+        "popcnt,sse4.2,avx2,bmi,bmi2,lzcnt,fma,avx512f,avx512bw,avx512dq," \
+        "avx512vl")))
+#else
+#  define BITBOARD_KERNEL_BODY inline
+#endif
+
+namespace bitboard
+{
+
+/**
+ * @brief Layout of a BitBoardBatch block: kBatchPlanes planes of kBatchLanes
+ * positions each, a plane holds one bitboard of every lane.
+ *
+ * The figure planes follow Figure, white pawn to king then black; a figure
+ * plane is the color base plus the figure offset.
+ */
+constexpr std::size_t kBatchLanes = 8;
+constexpr std::size_t kBatchWhitePawn = 0;
+constexpr std::size_t kBatchBlackPawn = 6;
+constexpr std::size_t kBatchBlackKing = 11;
+constexpr std::size_t kBatchPawn = 0;
+constexpr std::size_t kBatchKnight = 1;
+constexpr std::size_t kBatchBishop = 2;
+constexpr std::size_t kBatchRook = 3;
+constexpr std::size_t kBatchQueen = 4;
+constexpr std::size_t kBatchKing = 5;
+constexpr std::size_t kBatchFlags = 12;  // BitBoard::Flags
+constexpr std::size_t kBatchElPassant = 13;  // mask of the el passant square
+constexpr std::size_t kBatchPlanes = 14;
+
+/**
+ * @brief Hot functions compiled once per CpuLevel.
+ *
+ * Each level is a separate clone of the same code, so the inlined intrinsics
+ * (tzcnt, blsr, popcnt) match the level. The table of the level in use is
+ * picked on the first call of kernels().
+ */
+struct Kernels
+{
+  CpuLevel level;
+  // squares attacked by the sliders, queens belong to both sets
+  bitboard_field (*slider_attacks)(bitboard_field rooks,
+                                   bitboard_field bishops,
+                                   bitboard_field occupancy) noexcept;
+  // per position of the batch blocks, `size` is the number of positions
+  void (*batch_attacks)(const bitboard_field* blocks,
+                        std::size_t size,
+                        bool white,
+                        bitboard_field* out) noexcept;
+  void (*batch_checkers)(const bitboard_field* blocks,
+                         std::size_t size,
+                         bitboard_field* out) noexcept;
+  void (*batch_legal_counts)(const bitboard_field* blocks,
+                             std::size_t size,
+                             uint8_t* out) noexcept;
+  // one byte or float per bit, 0 or 1, the squares of a bitboard in order
+  void (*expand_bytes)(const bitboard_field* planes,
+                       std::size_t count,
+                       uint8_t* out) noexcept;
+  void (*expand_floats)(const bitboard_field* planes,
+                        std::size_t count,
+                        float* out) noexcept;
+};
+
+/**
+ * @brief Returns the kernels of the active level.
+ */
+const Kernels& kernels() noexcept;
+
+/**
+ * @brief Returns the kernels of `level`, or nullptr when the level isn't
+ * built or the processor lacks it. BITBOARD_CPU_LEVEL is ignored, so the
+ * tests reach every level the host runs.
+ */
+BITBOARD_EXPORT const Kernels* kernels(CpuLevel level) noexcept;
+
+}  // namespace bitboard
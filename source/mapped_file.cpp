@@ -0,0 +1,77 @@
+#include "mapped_file.hpp"
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace bitboard
+{
+
+bool mapFile(const char* path, void*& view, std::size_t& size)
+{
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(path,
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER file_size {};
+  bool result = GetFileSizeEx(file, &file_size) != 0;
+  if (result && file_size.QuadPart > 0) {
+    size = static_cast<std::size_t>(file_size.QuadPart);
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping != nullptr) {
+      view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      // the view keeps the mapping alive
+      CloseHandle(mapping);
+    }
+    result = view != nullptr;
+  }
+  CloseHandle(file);
+  return result;
+#else
+  const int file = open(path, O_RDONLY);
+  if (file < 0) {
+    return false;
+  }
+  struct stat info {};
+  bool result = fstat(file, &info) == 0;
+  if (result && info.st_size > 0) {
+    size = static_cast<std::size_t>(info.st_size);
+    view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (view == MAP_FAILED) {
+      view = nullptr;
+    } else {
+      madvise(view, size, MADV_SEQUENTIAL);
+    }
+    result = view != nullptr;
+  }
+  close(file);
+  return result;
+#endif
+}
+
+void unmapFile(void* view, std::size_t size)
+{
+#if defined(_WIN32)
+  static_cast<void>(size);
+  UnmapViewOfFile(view);
+#else
+  munmap(view, size);
+#endif
+}
+
+}  // namespace bitboard
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+namespace bitboard
+{
+
+/**
+ * @brief Maps the whole file read-only for sequential access.
+ *
+ * Returns false if the file can't be opened or mapped. Empty files can't be
+ * mapped, they are reported as a success with a null view.
+ */
+bool mapFile(const char* path, void*& view, std::size_t& size);
+
+/**
+ * @brief Releases a view returned by mapFile.
+ */
+void unmapFile(void* view, std::size_t size);
+
+}  // namespace bitboard
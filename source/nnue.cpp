@@ -0,0 +1,97 @@
+#include <algorithm>
+
+#include "bitboard/utils/nnue.hpp"
+
+#include "bitboard/bitboard.hpp"
+#include "bitboard/utils/bit_utils.hpp"
+
+namespace bitboard
+{
+
+namespace
+{
+
+constexpr Color kPerspectives[2] = {Color::kWhite, Color::kBlack};
+
+bool isKing(Figure figure) noexcept
+{
+  return figure == Figure::kWKing || figure == Figure::kBKing;
+}
+
+}  // namespace
+
+std::size_t nnueFeatures(const BitBoard& board,
+                         Color perspective,
+                         NnueFeatureSet set,
+                         std::span<uint32_t> out) noexcept
+{
+  const bitboard_field king = board.pieces(
+      perspective == Color::kWhite ? Figure::kWKing : Figure::kBKing);
+  if (king == 0) {
+    return 0;
+  }
+  const auto king_position = Position(static_cast<uint8_t>(log2_64(king)));
+  const int8_t last = set == NnueFeatureSet::kHalfKP ? 5 : 6;
+
+  std::size_t count = 0;
+  for (int8_t type = 1; type <= last; ++type) {
+    for (const int8_t sign : {int8_t {1}, int8_t {-1}}) {
+      const auto figure = static_cast<Figure>(type * sign);
+      bitboard_field pieces = board.pieces(figure);
+      for (bitboard_field bit = takeBit(pieces); bit; bit = takeBit(pieces)) {
+        if (count == out.size()) {
+          return count;
+        }
+        const Position square(static_cast<uint8_t>(log2_64(bit)));
+        out[count++] =
+            nnueFeature(set, perspective, king_position, figure, square);
+      }
+    }
+  }
+  return count;
+}
+
+NnueDelta nnueDelta(const BitBoard& board,
+                    Turn turn,
+                    NnueFeatureSet set) noexcept
+{
+  NnueDelta result;
+  FigureChange changes[kTurnMaxChanges];
+  const std::size_t count = board.turnChanges(turn, changes);
+
+  for (std::size_t side = 0; side < 2; ++side) {
+    const Figure own_king = side == 0 ? Figure::kWKing : Figure::kBKing;
+    const bitboard_field king = board.pieces(own_king);
+    if (king == 0) {
+      continue;
+    }
+    // all features of a perspective change with its king
+    if (std::any_of(changes,
+                    changes + count,
+                    [own_king](const FigureChange& change)
+                    { return change.figure == own_king; }))
+    {
+      result.refresh[side] = true;
+      continue;
+    }
+    const auto king_position = Position(static_cast<uint8_t>(log2_64(king)));
+    for (const FigureChange& change : std::span(changes, count)) {
+      if (set == NnueFeatureSet::kHalfKP && isKing(change.figure)) {
+        continue;
+      }
+      const uint32_t feature = nnueFeature(set,
+                                           kPerspectives[side],
+                                           king_position,
+                                           change.figure,
+                                           change.position);
+      if (change.count > 0) {
+        result.added[side][result.added_count[side]++] = feature;
+      } else {
+        result.removed[side][result.removed_count[side]++] = feature;
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace bitboard
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <cstring>
+
+#include "bitboard/utils/packed_board.hpp"
+
+#include "bitboard/bitboard.hpp"
+#include "bitboard/utils/bit_utils.hpp"
+
+namespace bitboard
+{
+
+namespace
+{
+
+constexpr Figure kCodeFigures[12] = {Figure::kWPawn,
+                                     Figure::kWKnight,
+                                     Figure::kWBishop,
+                                     Figure::kWRook,
+                                     Figure::kWQueen,
+                                     Figure::kWKing,
+                                     Figure::kBPawn,
+                                     Figure::kBKnight,
+                                     Figure::kBBishop,
+                                     Figure::kBRook,
+                                     Figure::kBQueen,
+                                     Figure::kBKing};
+
+constexpr uint8_t kCodeLast = 11;
+constexpr uint8_t kNoElPassant = kPositionInvalid;
+constexpr uint8_t kStateSide = 1;
+constexpr uint8_t kStateCastling = 0x1E;
+
+constexpr uint8_t kCastlingMask =
+    static_cast<uint8_t>(BitBoard::Flags::kFlagsWhiteOo)
+    | static_cast<uint8_t>(BitBoard::Flags::kFlagsWhiteOoo)
+    | static_cast<uint8_t>(BitBoard::Flags::kFlagsBlackOo)
+    | static_cast<uint8_t>(BitBoard::Flags::kFlagsBlackOoo);
+
+// The state that follows the pieces in both encodings.
+struct State
+{
+  uint8_t side_castling;
+  uint8_t el_passant;
+};
+
+void storeOccupancy(bitboard_field occupancy, uint8_t* out)
+{
+  for (unsigned i = 0; i < 8; ++i) {
+    out[i] = static_cast<uint8_t>(occupancy >> (i * 8));
+  }
+}
+
+bitboard_field loadOccupancy(const uint8_t* data)
+{
+  bitboard_field occupancy = 0;
+  for (unsigned i = 0; i < 8; ++i) {
+    occupancy |= static_cast<bitboard_field>(data[i]) << (i * 8);
+  }
+  return occupancy;
+}
+
+// Writes the nibble of every figure at the rank of its square among the
+// occupied squares; `out` must be zeroed.
+void storeFigures(const BitBoard& board,
+                  bitboard_field occupancy,
+                  uint8_t* out)
+{
+  for (uint8_t code = 0; code <= kCodeLast; ++code) {
+    bitboard_field figures = board.pieces(kCodeFigures[code]);
+    for (bitboard_field bit = takeBit(figures); bit; bit = takeBit(figures)) {
+      const auto index = static_cast<unsigned>(
+          popCount(occupancy & ((getBitBoardOne() << log2_64(bit)) - 1)));
+      out[index / 2] |= static_cast<uint8_t>(code << ((index % 2) * 4));
+    }
+  }
+}
+
+bool loadFigures(bitboard_field occupancy,
+                 const uint8_t* data,
+                 bitboard_field (&fields)[12])
+{
+  unsigned index = 0;
+  for (bitboard_field bit = takeBit(occupancy); bit;
+       bit = takeBit(occupancy), ++index)
+  {
+    const uint8_t code = (data[index / 2] >> ((index % 2) * 4)) & 0x0F;
+    if (code > kCodeLast) {
+      return false;
+    }
+    fields[code] |= getBitBoardOne() << log2_64(bit);
+  }
+  return true;
+}
+
+State storeState(const BitBoard& board)
+{
+  const auto flags = static_cast<uint8_t>(board.flags());
+  const auto el_passant = board.elPassant();
+  return {static_cast<uint8_t>(
+              (flags & static_cast<uint8_t>(BitBoard::Flags::kFlagsColor))
+              | ((flags & kCastlingMask) >> 1)),
+          el_passant.valid() ? el_passant.index() : kNoElPassant};
+}
+
+// Converts the state back to the flags and the double pawn move that enables
+// el passant; returns false for invalid values.
+bool loadState(State state, BitBoard::Flags& flags, Turn& prev_turn)
+{
+  if ((state.side_castling & ~(kStateSide | kStateCastling)) != 0) {
+    return false;
+  }
+  const bool white_side = (state.side_castling & kStateSide) == 0;
+  auto value = static_cast<uint8_t>((state.side_castling & kStateSide)
+                                    | ((state.side_castling & kStateCastling)
+                                       << 1));
+  prev_turn = {};
+  if (state.el_passant != kNoElPassant) {
+    const auto square = Position(state.el_passant);
+    if (!square.valid() || square.y() != (white_side ? 2 : 5)) {
+      return false;
+    }
+    const auto up = Position(square.index() - kBoardSize);
+    const auto down = Position(square.index() + kBoardSize);
+    prev_turn = white_side ? Turn(up, down) : Turn(down, up);
+    value |= static_cast<uint8_t>(BitBoard::Flags::kFlagsElPassant);
+  }
+  flags = static_cast<BitBoard::Flags>(value);
+  return true;
+}
+
+std::size_t storeVarint(uint16_t value, uint8_t* out)
+{
+  std::size_t size = 0;
+  while (value >= 0x80) {
+    out[size++] = static_cast<uint8_t>(value | 0x80);
+    value = static_cast<uint16_t>(value >> 7);
+  }
+  out[size++] = static_cast<uint8_t>(value);
+  return size;
+}
+
+// Returns the number of consumed bytes or zero on error.
+std::size_t loadVarint(std::span<const uint8_t> data, uint16_t& value)
+{
+  uint32_t result = 0;
+  for (std::size_t i = 0; i < data.size() && i < 3; ++i) {
+    result |= static_cast<uint32_t>(data[i] & 0x7F) << (i * 7);
+    if ((data[i] & 0x80) == 0) {
+      if (result > UINT16_MAX) {
+        return 0;
+      }
+      value = static_cast<uint16_t>(result);
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+bool packBoard(const BitBoard& board, PackedBoard& packed) noexcept
+{
+  const bitboard_field occupancy = board.occupancy();
+  if (popCount(occupancy) > 32) {
+    return false;
+  }
+
+  std::memset(packed.data, 0, sizeof(packed.data));
+  storeOccupancy(occupancy, packed.data);
+  storeFigures(board, occupancy, packed.data + 8);
+
+  const auto state = storeState(board);
+  packed.data[24] = state.side_castling;
+  packed.data[25] = state.el_passant;
+  packed.data[26] = static_cast<uint8_t>(board.halfmoveClock());
+  packed.data[27] = static_cast<uint8_t>(board.halfmoveClock() >> 8);
+  packed.data[28] = static_cast<uint8_t>(board.fullmoveNumber());
+  packed.data[29] = static_cast<uint8_t>(board.fullmoveNumber() >> 8);
+  return true;
+}
+
+bool unpackBoard(const PackedBoard& packed, BitBoard& board) noexcept
+{
+  const bitboard_field occupancy = loadOccupancy(packed.data);
+  bitboard_field fields[12] = {};
+  BitBoard::Flags flags {};
+  Turn prev_turn;
+
+  if (popCount(occupancy) > 32 || packed.data[30] != 0 || packed.data[31] != 0
+      || !loadFigures(occupancy, packed.data + 8, fields)
+      || !loadState({packed.data[24], packed.data[25]}, flags, prev_turn))
+  {
+    return false;
+  }
+
+  board.setPieces(fields);
+  board.m_prev_turn = prev_turn;
+  board.m_halfmove_clock =
+      static_cast<uint16_t>(packed.data[26] | (packed.data[27] << 8));
+  board.m_fullmove_number =
+      static_cast<uint16_t>(packed.data[28] | (packed.data[29] << 8));
+  board.m_flags = flags;
+  return true;
+}
+
+std::size_t packBoard(const BitBoard& board, uint8_t* out) noexcept
+{
+  const bitboard_field occupancy = board.occupancy();
+  const auto figures_size =
+      static_cast<std::size_t>((popCount(occupancy) + 1) / 2);
+
+  std::memset(out + 8, 0, figures_size);
+  storeOccupancy(occupancy, out);
+  storeFigures(board, occupancy, out + 8);
+
+  std::size_t size = 8 + figures_size;
+  const auto state = storeState(board);
+  out[size++] = state.side_castling;
+  out[size++] = state.el_passant;
+  size += storeVarint(board.halfmoveClock(), out + size);
+  size += storeVarint(board.fullmoveNumber(), out + size);
+  return size;
+}
+
+std::size_t unpackBoard(std::span<const uint8_t> data,
+                        BitBoard& board) noexcept
+{
+  if (data.size() < 8) {
+    return 0;
+  }
+  const bitboard_field occupancy = loadOccupancy(data.data());
+  const auto figures_size =
+      static_cast<std::size_t>((popCount(occupancy) + 1) / 2);
+  std::size_t size = 8 + figures_size;
+  if (data.size() < size + 2) {
+    return 0;
+  }
+
+  bitboard_field fields[12] = {};
+  BitBoard::Flags flags {};
+  Turn prev_turn;
+  if (!loadFigures(occupancy, data.data() + 8, fields)
+      || !loadState({data[size], data[size + 1]}, flags, prev_turn))
+  {
+    return 0;
+  }
+  size += 2;
+
+  uint16_t halfmove_clock = 0;
+  uint16_t fullmove_number = 0;
+  const std::size_t halfmove_size =
+      loadVarint(data.subspan(size), halfmove_clock);
+  if (halfmove_size == 0) {
+    return 0;
+  }
+  size += halfmove_size;
+  const std::size_t fullmove_size =
+      loadVarint(data.subspan(size), fullmove_number);
+  if (fullmove_size == 0) {
+    return 0;
+  }
+  size += fullmove_size;
+
+  board.setPieces(fields);
+  board.m_prev_turn = prev_turn;
+  board.m_halfmove_clock = halfmove_clock;
+  board.m_fullmove_number = fullmove_number;
+  board.m_flags = flags;
+  return size;
+}
+
+std::size_t packBoards(std::span<const BitBoard> boards,
+                       std::span<PackedBoard> packed) noexcept
+{
+  const std::size_t count = std::min(boards.size(), packed.size());
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!packBoard(boards[i], packed[i])) {
+      return i;
+    }
+  }
+  return count;
+}
+
+std::size_t unpackBoards(std::span<const PackedBoard> packed,
+                         std::span<BitBoard> boards) noexcept
+{
+  const std::size_t count = std::min(boards.size(), packed.size());
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!unpackBoard(packed[i], boards[i])) {
+      return i;
+    }
+  }
+  return count;
+}
+
+}  // namespace bitboard
@@ -0,0 +1,413 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "bitboard/utils/pgn_reader.hpp"
+
+#include "bitboard/utils/fen_parser.hpp"
+#include "bitboard/utils/san.hpp"
+#include "mapped_file.hpp"
+
+namespace bitboard
+{
+
+namespace
+{
+
+constexpr std::size_t kPgnTurnsReserve = 512;
+
+constexpr bool isSpace(char symbol)
+{
+  return symbol == ' ' || symbol == '\t' || symbol == '\n' || symbol == '\r';
+}
+
+constexpr bool isDigit(char symbol)
+{
+  return symbol >= '0' && symbol <= '9';
+}
+
+constexpr bool isDelimiter(char symbol)
+{
+  return isSpace(symbol) || symbol == '{' || symbol == '}' || symbol == '('
+      || symbol == ')' || symbol == ';';
+}
+
+std::size_t lineEnd(std::string_view data, std::size_t offset)
+{
+  const auto* newline = static_cast<const char*>(
+      std::memchr(data.data() + offset, '\n', data.size() - offset));
+  return newline == nullptr ? data.size()
+                            : static_cast<std::size_t>(newline - data.data());
+}
+
+constexpr bool isLetter(char symbol)
+{
+  return (symbol >= 'a' && symbol <= 'z') || (symbol >= 'A' && symbol <= 'Z');
+}
+
+// A tag line starts with `[Name "`, the name begins with a letter; lines of
+// a comment such as `[%clk 0:01:02] }` don't.
+bool isTag(std::string_view data, std::size_t offset)
+{
+  if (offset + 1 >= data.size() || data[offset] != '['
+      || !isLetter(data[offset + 1]))
+  {
+    return false;
+  }
+  std::size_t index = offset + 2;
+  while (index < data.size()
+         && (isLetter(data[index]) || isDigit(data[index])
+             || data[index] == '_'))
+  {
+    index++;
+  }
+  while (index < data.size() && (data[index] == ' ' || data[index] == '\t')) {
+    index++;
+  }
+  return index < data.size() && data[index] == '"';
+}
+
+// A game starts with a tag line whose previous non-blank line isn't a tag.
+bool isGameStart(std::string_view data, std::size_t offset)
+{
+  if (!isTag(data, offset)) {
+    return false;
+  }
+  std::size_t end = offset;
+  while (end > 0 && isSpace(data[end - 1])) {
+    end--;
+  }
+  if (end == 0) {
+    return true;
+  }
+  const std::size_t newline = data.rfind('\n', end - 1);
+  const std::size_t begin = newline == std::string_view::npos ? 0 : newline + 1;
+  return !isTag(data, begin);
+}
+
+// Returns the offset of the first game that starts at or after `offset`; the
+// beginning of the data starts a game even without tags.
+std::size_t alignToGame(std::string_view data, std::size_t offset)
+{
+  if (offset == 0) {
+    return 0;
+  }
+  std::size_t line =
+      data[offset - 1] == '\n' ? offset : lineEnd(data, offset) + 1;
+  while (line < data.size() && !isGameStart(data, line)) {
+    line = lineEnd(data, line) + 1;
+  }
+  return std::min(line, data.size());
+}
+
+// Returns the offset past the variation that starts at `offset`.
+std::size_t skipVariation(std::string_view text, std::size_t offset)
+{
+  std::size_t depth = 0;
+  while (offset < text.size()) {
+    switch (text[offset]) {
+      case '(':
+        depth++;
+        break;
+      case ')':
+        if (--depth == 0) {
+          return offset + 1;
+        }
+        break;
+      case '{':
+        offset = std::min(text.find('}', offset), text.size());
+        break;
+      case ';':
+        offset = lineEnd(text, offset);
+        break;
+      default:
+        break;
+    }
+    offset++;
+  }
+  return text.size();
+}
+
+bool isResult(std::string_view token)
+{
+  return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+// Drops the move number (`12.`, `12...`) glued to the move, bare numbers
+// become empty.
+std::string_view stripMoveNumber(std::string_view token)
+{
+  std::size_t digits = 0;
+  while (digits < token.size() && isDigit(token[digits])) {
+    digits++;
+  }
+  if (digits == token.size()) {
+    return {};
+  }
+  if (digits == 0 || token[digits] != '.') {
+    return token;
+  }
+  while (digits < token.size() && token[digits] == '.') {
+    digits++;
+  }
+  return token.substr(digits);
+}
+
+// Decodes the game appending its turns to `turns`.
+PgnStatus appendPgnGame(std::string_view text,
+                        PgnGame& game,
+                        std::vector<Turn>& turns)
+{
+  const std::size_t first_turn = turns.size();
+  game.result = {};
+  game.status = PgnStatus::kPgnOk;
+
+  std::size_t index = 0;
+  while (index < text.size() && isSpace(text[index])) {
+    index++;
+  }
+  const std::size_t tags_begin = index;
+  std::size_t tags_end = index;
+  while (index < text.size() && text[index] == '[') {
+    tags_end = lineEnd(text, index);
+    index = tags_end + 1;
+    while (index < text.size() && isSpace(text[index])) {
+      index++;
+    }
+  }
+  game.tags = text.substr(tags_begin, tags_end - tags_begin);
+
+  const std::string_view fen = game.tag("FEN");
+  if (fen.empty()) {
+    game.start = kStartBitBoard;
+  } else if (boardFromFen(fen, game.start) != FenStatus::kFenOk) {
+    game.status = PgnStatus::kPgnInvalidFen;
+    const BitBoard empty;
+    game.start = empty;
+  }
+  game.board = game.start;
+
+  while (index < text.size()) {
+    const char symbol = text[index];
+    if (isSpace(symbol) || symbol == ')' || symbol == '}') {
+      index++;
+      continue;
+    }
+    if (symbol == '{') {
+      index = std::min(text.find('}', index), text.size()) + 1;
+      continue;
+    }
+    if (symbol == ';') {
+      index = lineEnd(text, index) + 1;
+      continue;
+    }
+    if (symbol == '(') {
+      index = skipVariation(text, index);
+      continue;
+    }
+    if (symbol == '$') {
+      index++;
+      while (index < text.size() && isDigit(text[index])) {
+        index++;
+      }
+      continue;
+    }
+
+    const std::size_t begin = index;
+    while (index < text.size() && !isDelimiter(text[index])) {
+      index++;
+    }
+    const std::string_view token = text.substr(begin, index - begin);
+    if (isResult(token)) {
+      game.result = token;
+      break;
+    }
+    const std::string_view san = stripMoveNumber(token);
+    if (san.empty() || game.status != PgnStatus::kPgnOk) {
+      continue;
+    }
+
+    const Turn turn = turnFromSan(game.board, san);
+    if (!turn.valid()) {
+      game.status = PgnStatus::kPgnInvalidMove;
+      continue;
+    }
+    BitBoard next(game.board);
+    next.executeTurn(turn);
+    if (next.kingAttacked(game.board.side())) {
+      game.status = PgnStatus::kPgnIllegalMove;
+      continue;
+    }
+    game.board = next;
+    turns.push_back(turn);
+  }
+
+  game.turns = std::span<const Turn>(turns).subspan(first_turn);
+  return game.status;
+}
+
+}  // namespace
+
+std::string_view PgnGame::tag(std::string_view name) const noexcept
+{
+  std::size_t line = 0;
+  while (line < tags.size()) {
+    const std::size_t end = lineEnd(tags, line);
+    const std::string_view text = tags.substr(line, end - line);
+    line = end + 1;
+
+    if (text.size() < name.size() + 2 || text[0] != '['
+        || text.substr(1, name.size()) != name
+        || !isSpace(text[name.size() + 1]))
+    {
+      continue;
+    }
+    const std::size_t open = text.find('"');
+    const std::size_t close = text.rfind('"');
+    if (open == std::string_view::npos || close == open) {
+      return {};
+    }
+    return text.substr(open + 1, close - open - 1);
+  }
+  return {};
+}
+
+PgnStatus readPgnGame(std::string_view text,
+                      PgnGame& game,
+                      std::vector<Turn>& turns)
+{
+  turns.clear();
+  return appendPgnGame(text, game, turns);
+}
+
+PgnReader::PgnReader(const char* path)
+{
+  m_valid = mapFile(path, m_mapping, m_mapping_size);
+  if (m_mapping != nullptr) {
+    m_data =
+        std::string_view(static_cast<const char*>(m_mapping), m_mapping_size);
+  }
+}
+
+PgnReader::PgnReader(std::string_view data) noexcept
+    : m_data(data)
+    , m_valid(true)
+{
+}
+
+PgnReader::~PgnReader()
+{
+  if (m_mapping != nullptr) {
+    unmapFile(m_mapping, m_mapping_size);
+  }
+}
+
+bool PgnReader::valid() const noexcept
+{
+  return m_valid;
+}
+
+std::string_view PgnReader::data() const noexcept
+{
+  return m_data;
+}
+
+std::size_t PgnReader::read(const Callback& callback,
+                            unsigned threads,
+                            bool ordered,
+                            std::size_t chunk_size) const
+{
+  if (m_data.empty()) {
+    return 0;
+  }
+
+  chunk_size = std::max<std::size_t>(chunk_size, 1);
+  const std::size_t chunks = ((m_data.size() - 1) / chunk_size) + 1;
+
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  threads = static_cast<unsigned>(std::min<std::size_t>(threads, chunks));
+
+  std::atomic<std::size_t> next_chunk {0};
+  std::atomic<std::size_t> total {0};
+  std::mutex turn_mutex;
+  std::condition_variable turn_changed;
+  std::size_t turn = 0;
+
+  const auto worker = [&]
+  {
+    // in ordered mode the games of a chunk are decoded before waiting for
+    // the turn of the chunk, their turns share one buffer
+    std::vector<PgnGame> games(1);
+    std::vector<std::size_t> first_turns;
+    std::vector<Turn> turns;
+    turns.reserve(kPgnTurnsReserve);
+
+    for (std::size_t chunk = next_chunk++; chunk < chunks;
+         chunk = next_chunk++)
+    {
+      const std::size_t end = alignToGame(
+          m_data, std::min(m_data.size(), (chunk + 1) * chunk_size));
+      std::size_t game_begin = alignToGame(m_data, chunk * chunk_size);
+      std::size_t count = 0;
+      turns.clear();
+      first_turns.clear();
+
+      while (game_begin < end) {
+        const std::size_t game_end =
+            std::min(alignToGame(m_data, game_begin + 1), end);
+        const std::string_view text =
+            m_data.substr(game_begin, game_end - game_begin);
+        game_begin = game_end;
+
+        if (std::all_of(text.begin(), text.end(), isSpace)) {
+          continue;
+        }
+        if (!ordered) {
+          readPgnGame(text, games.front(), turns);
+          callback(games.front(), chunk);
+          total++;
+          continue;
+        }
+        if (count == games.size()) {
+          games.emplace_back();
+        }
+        first_turns.push_back(turns.size());
+        appendPgnGame(text, games[count++], turns);
+      }
+
+      if (ordered) {
+        std::unique_lock<std::mutex> lock(turn_mutex);
+        turn_changed.wait(lock, [&] { return turn == chunk; });
+        for (std::size_t i = 0; i < count; ++i) {
+          // the buffer may have moved while the later games were decoded
+          games[i].turns = std::span<const Turn>(turns).subspan(
+              first_turns[i], games[i].turns.size());
+          callback(games[i], chunk);
+        }
+        total += count;
+        turn++;
+        lock.unlock();
+        turn_changed.notify_all();
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (unsigned i = 1; i < threads; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : workers) {
+    thread.join();
+  }
+
+  return total;
+}
+
+}  // namespace bitboard
@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <array>
+
+#include "bitboard/utils/policy.hpp"
+
+#include "bitboard/bitboard.hpp"
+
+namespace bitboard
+{
+
+namespace
+{
+
+// Squares below are seen from the side to move with a1 = 0, files and ranks
+// as 0 .. 7 and the rank growing towards the enemy.
+
+struct Step
+{
+  int8_t file;
+  int8_t rank;
+};
+
+constexpr Step kQueenSteps[8] = {
+    {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}};
+
+constexpr Step kKnightSteps[8] = {
+    {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+
+constexpr uint8_t kNoPlane = 0xFF;
+constexpr std::size_t kQueenPlanes = 56;
+constexpr std::size_t kKnightPlanes = 8;
+
+constexpr std::size_t deltaIndex(int file, int rank) noexcept
+{
+  return static_cast<std::size_t>(((file + 7) * 15) + rank + 7);
+}
+
+// AlphaZero plane of a move without underpromotion by its file and rank delta.
+constexpr auto kAlphaZeroPlanes = []
+{
+  std::array<uint8_t, 15 * 15> result {};
+  result.fill(kNoPlane);
+  for (std::size_t dir = 0; dir < 8; ++dir) {
+    for (int distance = 1; distance <= 7; ++distance) {
+      result[deltaIndex(kQueenSteps[dir].file * distance,
+                        kQueenSteps[dir].rank * distance)] =
+          static_cast<uint8_t>((dir * 7) + static_cast<std::size_t>(distance)
+                               - 1);
+    }
+    result[deltaIndex(kKnightSteps[dir].file, kKnightSteps[dir].rank)] =
+        static_cast<uint8_t>(kQueenPlanes + dir);
+  }
+  return result;
+}();
+
+struct CompactMove
+{
+  uint8_t from = 0;
+  uint8_t to = 0;
+  Figure figure = Figure::kEmpty;
+};
+
+constexpr bool reachable(int from, int to) noexcept
+{
+  const int file = (to % 8) - (from % 8);
+  const int rank = (to / 8) - (from / 8);
+  return from != to
+      && kAlphaZeroPlanes[deltaIndex(file, rank)] != kNoPlane;
+}
+
+constexpr std::size_t kCompactPromotions = 22 * 3;
+constexpr Figure kCompactFigures[3] = {
+    Figure::kQueen, Figure::kRook, Figure::kBishop};
+
+struct CompactTables
+{
+  std::array<CompactMove, kCompactPolicySize> moves {};
+  // index of the move by from * 64 + to
+  std::array<uint16_t, 64 * 64> indices {};
+  // first index of the promotions by from-file * 3 + file delta + 1
+  std::array<uint16_t, 8 * 3> promotions {};
+  // queen and knight moves, the promotions follow them
+  std::size_t plain = 0;
+  std::size_t count = 0;
+};
+
+constexpr auto kCompact = []
+{
+  CompactTables result;
+  result.indices.fill(kNoPolicyIndex);
+  result.promotions.fill(kNoPolicyIndex);
+  std::size_t count = 0;
+  for (int from = 0; from < 64; ++from) {
+    for (int to = 0; to < 64; ++to) {
+      if (reachable(from, to)) {
+        result.indices[static_cast<std::size_t>((from * 64) + to)] =
+            static_cast<uint16_t>(count);
+        result.moves[count++] = {static_cast<uint8_t>(from),
+                                 static_cast<uint8_t>(to)};
+      }
+    }
+  }
+  result.plain = count;
+  for (int from = 48; from < 56; ++from) {
+    for (int to = std::max(56, from + 7); to <= std::min(63, from + 9); ++to) {
+      result.promotions[static_cast<std::size_t>(((from % 8) * 3) + to - from
+                                                 - 7)] =
+          static_cast<uint16_t>(count);
+      for (const Figure figure : kCompactFigures) {
+        result.moves[count++] = {static_cast<uint8_t>(from),
+                                 static_cast<uint8_t>(to),
+                                 figure};
+      }
+    }
+  }
+  result.count = count;
+  return result;
+}();
+
+static_assert(kCompact.plain == 1792,
+              "Compact policy must hold every queen and knight move!");
+static_assert(kCompact.count - kCompact.plain == kCompactPromotions
+                  && kCompact.count == kCompactPolicySize,
+              "Compact policy must hold exactly 1858 moves!");
+
+// Position of the side to move to the a1 = 0 square and back.
+constexpr unsigned relative(Position position, bool black) noexcept
+{
+  return black ? position.index() : position.index() ^ 56U;
+}
+
+constexpr Position absolute(unsigned square, bool black) noexcept
+{
+  return Position(static_cast<uint8_t>(black ? square : square ^ 56U));
+}
+
+uint16_t alphaZeroIndex(unsigned from, unsigned to, Figure figure) noexcept
+{
+  const int file = static_cast<int>(to % 8) - static_cast<int>(from % 8);
+  const int rank = static_cast<int>(to / 8) - static_cast<int>(from / 8);
+  std::size_t plane = kAlphaZeroPlanes[deltaIndex(file, rank)];
+  if (figure >= Figure::kKnight && figure <= Figure::kRook) {
+    if (from / 8 != 6 || rank != 1 || file < -1 || file > 1) {
+      return kNoPolicyIndex;
+    }
+    plane = kQueenPlanes + kKnightPlanes
+        + (static_cast<std::size_t>(static_cast<int8_t>(figure)
+                                    - static_cast<int8_t>(Figure::kKnight))
+           * 3)
+        + static_cast<std::size_t>(file + 1);
+  }
+  if (plane == kNoPlane) {
+    return kNoPolicyIndex;
+  }
+  return static_cast<uint16_t>((plane * 64) + (from ^ 56U));
+}
+
+uint16_t compactIndex(unsigned from, unsigned to, Figure figure) noexcept
+{
+  if (figure == Figure::kEmpty || figure == Figure::kKnight) {
+    return kCompact.indices[(from * 64) + to];
+  }
+  const int file = static_cast<int>(to % 8) - static_cast<int>(from % 8);
+  if (from / 8 != 6 || to / 8 != 7 || file < -1 || file > 1) {
+    return kNoPolicyIndex;
+  }
+  const uint16_t first =
+      kCompact.promotions[((from % 8) * 3) + static_cast<unsigned>(file + 1)];
+  switch (figure) {
+    case Figure::kQueen:
+      return first;
+    case Figure::kRook:
+      return static_cast<uint16_t>(first + 1);
+    default:
+      return static_cast<uint16_t>(first + 2);
+  }
+}
+
+}  // namespace
+
+uint16_t policyIndex(PolicyEncoding encoding,
+                     Color side,
+                     Turn turn) noexcept
+{
+  if (!turn.valid()) {
+    return kNoPolicyIndex;
+  }
+  const bool black = side == Color::kBlack;
+  const unsigned from = relative(turn.from(), black);
+  const unsigned to = relative(turn.to(), black);
+  return encoding == PolicyEncoding::kAlphaZero
+      ? alphaZeroIndex(from, to, turn.figure())
+      : compactIndex(from, to, turn.figure());
+}
+
+void policyIndices(PolicyEncoding encoding,
+                   Color side,
+                   std::span<const Turn> turns,
+                   std::span<uint16_t> out) noexcept
+{
+  const std::size_t count = std::min(turns.size(), out.size());
+  for (std::size_t i = 0; i < count; ++i) {
+    out[i] = policyIndex(encoding, side, turns[i]);
+  }
+}
+
+Turn policyTurn(const BitBoard& board,
+                PolicyEncoding encoding,
+                uint16_t index) noexcept
+{
+  if (index >= policySize(encoding)) {
+    return {};
+  }
+  const bool black = board.side() == Color::kBlack;
+  unsigned from = 0;
+  int to = 0;
+  Figure figure = Figure::kEmpty;
+  if (encoding == PolicyEncoding::kAlphaZero) {
+    const std::size_t plane = index / 64U;
+    from = (index % 64U) ^ 56U;
+    Step step {};
+    if (plane < kQueenPlanes) {
+      const auto distance = static_cast<int8_t>((plane % 7) + 1);
+      step = kQueenSteps[plane / 7];
+      step = {static_cast<int8_t>(step.file * distance),
+              static_cast<int8_t>(step.rank * distance)};
+    } else if (plane < kQueenPlanes + kKnightPlanes) {
+      step = kKnightSteps[plane - kQueenPlanes];
+    } else {
+      const std::size_t promotion = plane - kQueenPlanes - kKnightPlanes;
+      if (from / 8 != 6) {
+        return {};
+      }
+      step = {static_cast<int8_t>(static_cast<int>(promotion % 3) - 1), 1};
+      figure = static_cast<Figure>(static_cast<std::size_t>(Figure::kKnight)
+                                   + (promotion / 3));
+    }
+    const int file = static_cast<int>(from % 8) + step.file;
+    const int rank = static_cast<int>(from / 8) + step.rank;
+    if (file < 0 || file > 7 || rank < 0 || rank > 7) {
+      return {};
+    }
+    to = (rank * 8) + file;
+  } else {
+    const CompactMove& move = kCompact.moves[index];
+    from = move.from;
+    to = move.to;
+    figure = move.figure;
+  }
+
+  const Position from_position = absolute(from, black);
+  const Position to_position = absolute(static_cast<unsigned>(to), black);
+  const Figure pawn = black ? Figure::kBPawn : Figure::kWPawn;
+  if (figure == Figure::kEmpty && to / 8 == 7
+      && board.get(from_position) == pawn)
+  {
+    figure = encoding == PolicyEncoding::kAlphaZero ? Figure::kQueen
+                                                    : Figure::kKnight;
+  }
+  return figure == Figure::kEmpty ? Turn(from_position, to_position)
+                                  : Turn(from_position, to_position, figure);
+}
+
+std::size_t policyMask(const BitBoard& board,
+                       PolicyEncoding encoding,
+                       std::span<uint64_t> mask) noexcept
+{
+  std::fill_n(
+      mask.begin(), std::min(mask.size(), policyWords(encoding)), uint64_t {0});
+  Turn turns[kChessMaxTurns];
+  const std::size_t count = board.getTurns(turns);
+  for (std::size_t i = 0; i < count; ++i) {
+    const uint16_t index = policyIndex(encoding, board.side(), turns[i]);
+    if (index / 64U < mask.size()) {
+      mask[index / 64U] |= uint64_t {1} << (index % 64U);
+    }
+  }
+  return count;
+}
+
+}  // namespace bitboard
@@ -0,0 +1,336 @@
+#include "bitboard/utils/san.hpp"
+
+#include "bitboard/bitboard.hpp"
+#include "bitboard/utils/bit_utils.hpp"
+#include "magic.hpp"
+
+namespace bitboard
+{
+
+namespace
+{
+
+constexpr Figure colored(Figure figure, bool white)
+{
+  return white ? figure : static_cast<Figure>(-static_cast<int8_t>(figure));
+}
+
+constexpr Figure sanFigure(char symbol)
+{
+  switch (symbol) {
+    case 'N':
+      return Figure::kKnight;
+    case 'B':
+      return Figure::kBishop;
+    case 'R':
+      return Figure::kRook;
+    case 'Q':
+      return Figure::kQueen;
+    case 'K':
+      return Figure::kKing;
+    default:
+      return Figure::kEmpty;
+  }
+}
+
+constexpr bool isFile(char symbol)
+{
+  return symbol >= 'a' && symbol <= 'h';
+}
+
+constexpr bool isRank(char symbol)
+{
+  return symbol >= '1' && symbol <= '8';
+}
+
+Turn castlingFromSan(const BitBoard& board, bool long_castling)
+{
+  const bool white = board.side() == Color::kWhite;
+  const auto flags = static_cast<uint8_t>(board.flags());
+  const auto right = static_cast<uint8_t>(
+      white ? (long_castling ? BitBoard::Flags::kFlagsWhiteOoo
+                             : BitBoard::Flags::kFlagsWhiteOo)
+            : (long_castling ? BitBoard::Flags::kFlagsBlackOoo
+                             : BitBoard::Flags::kFlagsBlackOo));
+  const Position king = white ? "e1"_p : "e8"_p;
+  if ((flags & right) == 0 || board.get(king) != colored(Figure::kKing, white))
+  {
+    return {};
+  }
+  // the king is never in check after castling when it passed through an
+  // attacked square, so the rook, the path and the squares are tested here
+  const Turn turn(king,
+                  Position(static_cast<uint8_t>(long_castling ? 2 : 6),
+                           king.y()),
+                  TurnKind::kCastling);
+  return board.isLegal(turn) ? turn : Turn {};
+}
+
+// Own pawns that can reach the target, by a capture if `capture` is set.
+bitboard_field pawnCandidates(const BitBoard& board,
+                              Position target,
+                              bool capture,
+                              bool white)
+{
+  const bitboard_field mask = positionToMask(target);
+  const bitboard_field pawns =
+      board.pieces(colored(Figure::kPawn, white));
+
+  if (capture) {
+    const bitboard_field sources = white
+        ? (((mask << 9) & ~row_a) | ((mask << 7) & ~row_h))
+        : (((mask >> 9) & ~row_h) | ((mask >> 7) & ~row_a));
+    const bool target_enemy = (mask & (white ? board.blacks() : board.whites()))
+        != 0;
+    return (target_enemy || target == board.elPassant()) ? sources & pawns
+                                                         : 0;
+  }
+
+  const bitboard_field empty = ~board.occupancy();
+  if ((mask & empty) == 0) {
+    return 0;
+  }
+  const bitboard_field single = white ? mask << 8 : mask >> 8;
+  if (single & pawns) {
+    return single & pawns;
+  }
+  const bitboard_field double_rank = white ? line_4 : line_5;
+  if ((mask & double_rank) && (single & empty)) {
+    return (white ? mask << 16 : mask >> 16) & pawns;
+  }
+  return 0;
+}
+
+bitboard_field figureCandidates(const BitBoard& board,
+                                Position target,
+                                Figure figure,
+                                bool white)
+{
+  const bitboard_field own = board.pieces(colored(figure, white));
+  const bitboard_field occupancy = board.occupancy();
+
+  switch (figure) {
+    case Figure::kKnight:
+      return processKnight(target) & own;
+    case Figure::kBishop:
+      return processBishop(target, occupancy) & own;
+    case Figure::kRook:
+      return processRook(target, occupancy) & own;
+    case Figure::kQueen:
+      return (processBishop(target, occupancy)
+              | processRook(target, occupancy))
+          & own;
+    case Figure::kKing:
+      return processKing(target) & own;
+    default:
+      return 0;
+  }
+}
+
+// Figures among `sources` that can move to the target without exposing
+// their king.
+bitboard_field legalSources(const BitBoard& board,
+                            bitboard_field sources,
+                            Position target)
+{
+  bitboard_field result = 0;
+  for (bitboard_field bit = takeBit(sources); bit; bit = takeBit(sources)) {
+    const auto source = Position(static_cast<uint8_t>(log2_64(bit)));
+    if (board.isLegal(board.classify(Turn(source, target)))) {
+      result |= positionToMask(source);
+    }
+  }
+  return result;
+}
+
+char sanSymbol(Figure figure)
+{
+  switch (figure) {
+    case Figure::kKnight:
+      return 'N';
+    case Figure::kBishop:
+      return 'B';
+    case Figure::kRook:
+      return 'R';
+    case Figure::kQueen:
+      return 'Q';
+    case Figure::kKing:
+      return 'K';
+    default:
+      return '?';
+  }
+}
+
+}  // namespace
+
+Turn turnFromSan(const BitBoard& board, std::string_view san) noexcept
+{
+  while (!san.empty()
+         && (san.back() == '+' || san.back() == '#' || san.back() == '!'
+             || san.back() == '?'))
+  {
+    san.remove_suffix(1);
+  }
+
+  if (san == "O-O" || san == "0-0") {
+    return castlingFromSan(board, false);
+  }
+  if (san == "O-O-O" || san == "0-0-0") {
+    return castlingFromSan(board, true);
+  }
+
+  Figure figure = Figure::kPawn;
+  if (!san.empty() && sanFigure(san.front()) != Figure::kEmpty) {
+    figure = sanFigure(san.front());
+    san.remove_prefix(1);
+  }
+
+  Figure promotion = Figure::kEmpty;
+  if (!san.empty() && sanFigure(san.back()) != Figure::kEmpty) {
+    promotion = sanFigure(san.back());
+    san.remove_suffix(1);
+    if (!san.empty() && san.back() == '=') {
+      san.remove_suffix(1);
+    }
+    if (figure != Figure::kPawn || promotion == Figure::kKing) {
+      return {};
+    }
+  }
+
+  if (san.size() < 2 || !isFile(san[san.size() - 2]) || !isRank(san.back())) {
+    return {};
+  }
+  const Position target = Position(san.substr(san.size() - 2));
+  san.remove_suffix(2);
+
+  bool capture = false;
+  if (!san.empty() && (san.back() == 'x' || san.back() == ':')) {
+    capture = true;
+    san.remove_suffix(1);
+  }
+
+  bitboard_field filter = ~bitboard_field {0};
+  if (!san.empty() && isRank(san.back())) {
+    filter &= line_8 << (static_cast<unsigned>('8' - san.back()) * 8U);
+    san.remove_suffix(1);
+  }
+  if (!san.empty() && isFile(san.back())) {
+    filter &= row_a << static_cast<unsigned>(san.back() - 'a');
+    san.remove_suffix(1);
+  }
+  if (!san.empty()) {
+    return {};
+  }
+
+  const bool white = board.side() == Color::kWhite;
+  const bitboard_field own = white ? board.whites() : board.blacks();
+  if (positionToMask(target) & own) {
+    return {};
+  }
+
+  bitboard_field candidates = 0;
+  if (figure == Figure::kPawn) {
+    // a file disambiguation of a pawn means a capture even without the `x`
+    capture = capture || filter != ~bitboard_field {0};
+    candidates = pawnCandidates(board, target, capture, white);
+    const bool last_rank = target.y() == (white ? 0 : 7);
+    if (last_rank != (promotion != Figure::kEmpty)) {
+      return {};
+    }
+  } else {
+    candidates = figureCandidates(board, target, figure, white);
+  }
+  candidates &= filter;
+
+  if (candidates == 0) {
+    return {};
+  }
+
+  const auto makeTurn = [&](bitboard_field from)
+  {
+    const auto from_position = Position(static_cast<uint8_t>(log2_64(from)));
+    return board.classify(promotion == Figure::kEmpty
+                              ? Turn(from_position, target)
+                              : Turn(from_position, target, promotion));
+  };
+
+  if ((candidates & (candidates - 1)) == 0) {
+    return makeTurn(candidates);
+  }
+
+  // several figures reach the target, the pinned ones are dropped
+  candidates = legalSources(board, candidates, target);
+  if (candidates == 0 || (candidates & (candidates - 1)) != 0) {
+    return {};
+  }
+  return makeTurn(candidates);
+}
+
+std::size_t turnToSan(const BitBoard& board, Turn turn, char* out) noexcept
+{
+  const Position from = turn.from();
+  const Position to = turn.to();
+  const bool white = board.side() == Color::kWhite;
+  const auto moved = static_cast<int8_t>(board.get(from));
+  if (!turn.valid() || moved == 0 || (moved > 0) != white) {
+    return 0;
+  }
+  const auto figure = static_cast<Figure>(moved > 0 ? moved : -moved);
+  const bool capture = board.get(to) != Figure::kEmpty;
+
+  std::size_t size = 0;
+  const auto writeSquare = [&](Position position)
+  {
+    out[size++] = static_cast<char>('a' + position.x());
+    out[size++] = static_cast<char>('8' - position.y());
+  };
+
+  if (figure == Figure::kKing && ce_abs(to.x() - from.x()) == 2) {
+    const char* const castling = to.x() > from.x() ? "O-O" : "O-O-O";
+    for (const char* symbol = castling; *symbol != '\0'; ++symbol) {
+      out[size++] = *symbol;
+    }
+  } else if (figure == Figure::kPawn) {
+    if (from.x() != to.x()) {
+      out[size++] = static_cast<char>('a' + from.x());
+      out[size++] = 'x';
+    }
+    writeSquare(to);
+    if (to.y() == 0 || to.y() == 7) {
+      out[size++] = '=';
+      out[size++] =
+          sanSymbol(turn.promotion() ? turn.figure() : Figure::kQueen);
+    }
+  } else {
+    out[size++] = sanSymbol(figure);
+    bitboard_field others = figureCandidates(board, to, figure, white)
+        & ~positionToMask(from);
+    if (others != 0) {
+      others = legalSources(board, others, to);
+    }
+    if (others != 0) {
+      const bitboard_field file = row_a << from.x();
+      const bitboard_field rank = line_8 << (from.y() * 8U);
+      if ((others & file) == 0) {
+        out[size++] = static_cast<char>('a' + from.x());
+      } else if ((others & rank) == 0) {
+        out[size++] = static_cast<char>('8' - from.y());
+      } else {
+        writeSquare(from);
+      }
+    }
+    if (capture) {
+      out[size++] = 'x';
+    }
+    writeSquare(to);
+  }
+
+  BitBoard copy(board);
+  copy.executeTurn(turn);
+  if (copy.kingAttacked(copy.side())) {
+    out[size++] = copy.hasLegalMove() ? '+' : '#';
+  }
+  return size;
+}
+
+}  // namespace bitboard
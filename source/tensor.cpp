@@ -0,0 +1,73 @@
+#include <algorithm>
+
+#include "bitboard/utils/tensor.hpp"
+
+#include "bitboard/bitboard.hpp"
+#include "bitboard/utils/bit_utils.hpp"
+#include "kernels.hpp"
+
+namespace bitboard
+{
+
+namespace
+{
+
+constexpr bitboard_field kFull = ~bitboard_field {0};
+
+// Boards gathered per kernel call, keeps the planes on the stack.
+constexpr std::size_t kTensorChunk = 16;
+
+bitboard_field fill(BitBoard::Flags flags, BitBoard::Flags flag) noexcept
+{
+  return (static_cast<uint8_t>(flags) & static_cast<uint8_t>(flag)) != 0
+      ? kFull
+      : 0;
+}
+
+void gather(const BitBoard& board, bitboard_field* planes) noexcept
+{
+  for (std::size_t i = 0; i < 6; ++i) {
+    const auto figure = static_cast<int8_t>(i + 1);
+    planes[i] = board.pieces(static_cast<Figure>(figure));
+    planes[i + 6] = board.pieces(static_cast<Figure>(-figure));
+  }
+  using Flags = BitBoard::Flags;
+  const Flags flags = board.flags();
+  planes[kTensorSidePlane] = board.side() == Color::kBlack ? kFull : 0;
+  planes[kTensorCastlingPlane] = fill(flags, Flags::kFlagsWhiteOo);
+  planes[kTensorCastlingPlane + 1] = fill(flags, Flags::kFlagsWhiteOoo);
+  planes[kTensorCastlingPlane + 2] = fill(flags, Flags::kFlagsBlackOo);
+  planes[kTensorCastlingPlane + 3] = fill(flags, Flags::kFlagsBlackOoo);
+  const Position el_passant = board.elPassant();
+  planes[kTensorElPassantPlane] =
+      el_passant.valid() ? positionToMask(el_passant) : 0;
+}
+
+template<typename Value, typename Expand>
+void toTensor(std::span<const BitBoard> boards,
+              Value* out,
+              Expand expand) noexcept
+{
+  bitboard_field planes[kTensorChunk * kTensorPlanes];
+  for (std::size_t first = 0; first < boards.size(); first += kTensorChunk) {
+    const std::size_t count = std::min(kTensorChunk, boards.size() - first);
+    for (std::size_t i = 0; i < count; ++i) {
+      gather(boards[first + i], planes + (i * kTensorPlanes));
+    }
+    expand(planes, count * kTensorPlanes, out + (first * kTensorBoardSize));
+  }
+}
+
+}  // namespace
+
+void boardsToTensor(std::span<const BitBoard> boards, uint8_t* out) noexcept
+{
+  toTensor(boards, out, kernels().expand_bytes);
+}
+
+void boardsToTensor(std::span<const BitBoard> boards, float* out) noexcept
+{
+  toTensor(boards, out, kernels().expand_floats);
+}
+
+}  // namespace bitboard
@@ -0,0 +1,98 @@
+#include "bitboard/utils/uci.hpp"
+
+#include "bitboard/bitboard.hpp"
+#include "bitboard/utils/fen_parser.hpp"
+
+namespace bitboard
+{
+
+namespace
+{
+
+constexpr bool isSpace(char symbol)
+{
+  return symbol == ' ' || symbol == '\t' || symbol == '\n' || symbol == '\r';
+}
+
+std::string_view readToken(std::string_view text, std::size_t& index)
+{
+  while (index < text.size() && isSpace(text[index])) {
+    index++;
+  }
+  const std::size_t begin = index;
+  while (index < text.size() && !isSpace(text[index])) {
+    index++;
+  }
+  return text.substr(begin, index - begin);
+}
+
+}  // namespace
+
+UciStatus turnsFromUci(std::string_view moves,
+                       std::span<Turn> turns,
+                       std::size_t& count) noexcept
+{
+  count = 0;
+  std::size_t index = 0;
+  for (auto token = readToken(moves, index); !token.empty();
+       token = readToken(moves, index))
+  {
+    if (count == turns.size()) {
+      return UciStatus::kUciTooManyTurns;
+    }
+    const Turn turn(token);
+    if (!turn.valid()) {
+      return UciStatus::kUciInvalidTurn;
+    }
+    turns[count++] = turn;
+  }
+  return UciStatus::kUciOk;
+}
+
+UciStatus positionFromUci(std::string_view command,
+                          BitBoard& board,
+                          std::span<Turn> turns,
+                          std::size_t& count) noexcept
+{
+  count = 0;
+  std::size_t index = 0;
+  std::size_t begin = 0;
+  auto token = readToken(command, index);
+  if (token == "position") {
+    begin = index;
+    token = readToken(command, index);
+  }
+
+  if (token == "fen") {
+    begin = index;
+  } else if (token != "startpos") {
+    return UciStatus::kUciInvalidPosition;
+  }
+  if (boardFromFen(command, board, begin) != FenStatus::kFenOk) {
+    return UciStatus::kUciInvalidPosition;
+  }
+
+  index = begin;
+  token = readToken(command, index);
+  if (token.empty()) {
+    return UciStatus::kUciOk;
+  }
+  if (token != "moves") {
+    return UciStatus::kUciInvalidTurn;
+  }
+  return turnsFromUci(command.substr(index), turns, count);
+}
+
+std::size_t turnsToUci(std::span<const Turn> turns, char* out) noexcept
+{
+  std::size_t size = 0;
+  for (const auto turn : turns) {
+    if (size != 0) {
+      out[size++] = ' ';
+    }
+    size += turn.toChars(out + size);
+  }
+  return size;
+}
+
+}  // namespace bitboard
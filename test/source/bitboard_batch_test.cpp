@@ -0,0 +1,143 @@
+#include <cstdint>
+#include <vector>
+
+#include <bitboard/bitboard.hpp>
+#include <bitboard/utils/bitboard_batch.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "playout.hpp"
+
+using bitboard::BitBoard;
+using bitboard::BitBoardBatch;
+using bitboard::bitboard_field;
+using bitboard::Color;
+using bitboard::Turn;
+
+namespace
+{
+
+// Positions of short games from the playout starts.
+std::vector<BitBoard> playouts(std::size_t plies)
+{
+  std::vector<BitBoard> result;
+  for (const char* fen : test::kPlayoutFens) {
+    for (std::size_t seed = 0; seed < 4; ++seed) {
+      test::playout(fen,
+                    seed,
+                    plies,
+                    [&result](const BitBoard& board, Turn /*turn*/)
+                    { result.push_back(board); });
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("BitBoardBatch", "[bitboard][batch]")
+{
+  // the last block is filled partly
+  std::vector<BitBoard> boards = playouts(40);
+  boards.pop_back();
+  BitBoardBatch batch;
+  batch.reserve(boards.size());
+  for (const auto& board : boards) {
+    batch.add(board);
+  }
+  REQUIRE(batch.size() == boards.size());
+  REQUIRE(boards.size() % BitBoardBatch::kLanes != 0);
+
+  std::vector<bitboard_field> white(boards.size());
+  std::vector<bitboard_field> black(boards.size());
+  std::vector<bitboard_field> checkers(boards.size());
+  std::vector<uint8_t> counts(boards.size());
+  batch.attacks(Color::kWhite, white);
+  batch.attacks(Color::kBlack, black);
+  batch.checkers(checkers);
+  batch.legalTurnCounts(counts);
+
+  for (std::size_t i = 0; i < boards.size(); ++i) {
+    INFO(boards[i].fen());
+    Turn turns[bitboard::kChessMaxTurns];
+    REQUIRE(white[i] == boards[i].attacks(Color::kWhite));
+    REQUIRE(black[i] == boards[i].attacks(Color::kBlack));
+    REQUIRE(checkers[i] == boards[i].checkers());
+    REQUIRE(counts[i] == boards[i].getTurns(turns));
+  }
+
+  SECTION("Positions the playouts may miss")
+  {
+    const char* fens[] = {
+        // el passant exposing the king along the rank, and a legal one
+        "8/8/8/K1pP3q/8/8/8/7k w - c6 0 2",
+        "8/8/8/2pP4/8/8/8/K6k w - c6 0 2",
+        // el passant capturing the checking pawn
+        "8/8/3k4/2pP4/8/8/8/K7 w - c6 0 2",
+        // castling through attacked squares and out of check
+        "r3k2r/8/8/8/8/8/8/R3K1r1 w KQkq - 0 1",
+        "r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1",
+        "r3k2r/8/8/8/4R3/8/8/4K3 b kq - 0 1",
+        // double check and pinned figures of every kind
+        "4k3/8/8/8/1b6/8/3N4/r3K2R w K - 0 1",
+        "4k3/4r3/8/b7/8/2P5/3PN3/4K3 w - - 0 1",
+        // black promotions
+        "4k3/8/8/8/8/8/p1p5/1N2K3 b - - 0 1",
+    };
+    BitBoardBatch extra;
+    for (const char* fen : fens) {
+      extra.add(BitBoard(fen));
+    }
+    std::vector<bitboard_field> extra_checkers(extra.size());
+    std::vector<uint8_t> extra_counts(extra.size());
+    extra.checkers(extra_checkers);
+    extra.legalTurnCounts(extra_counts);
+    for (std::size_t i = 0; i < extra.size(); ++i) {
+      const BitBoard board(fens[i]);
+      INFO(fens[i]);
+      Turn turns[bitboard::kChessMaxTurns];
+      REQUIRE(extra_checkers[i] == board.checkers());
+      REQUIRE(extra_counts[i] == board.getTurns(turns));
+    }
+  }
+
+  SECTION("Outputs are cut to the shorter length")
+  {
+    std::vector<uint8_t> short_counts(3, 0xFF);
+    batch.legalTurnCounts(std::span<uint8_t>(short_counts).first(2));
+    REQUIRE(short_counts[0] == counts[0]);
+    REQUIRE(short_counts[1] == counts[1]);
+    REQUIRE(short_counts[2] == 0xFF);
+
+    batch.clear();
+    REQUIRE(batch.empty());
+    batch.legalTurnCounts(short_counts);
+    REQUIRE(short_counts[0] == counts[0]);
+  }
+}
+
+TEST_CASE("BitBoardBatch benchmark", "[.][benchmark][batch]")
+{
+  const std::vector<BitBoard> boards = playouts(60);
+  BitBoardBatch batch;
+  for (const auto& board : boards) {
+    batch.add(board);
+  }
+  std::vector<uint8_t> counts(boards.size());
+
+  BENCHMARK("getTurns per board")
+  {
+    std::size_t result = 0;
+    Turn turns[bitboard::kChessMaxTurns];
+    for (const auto& board : boards) {
+      result += board.getTurns(turns);
+    }
+    return result;
+  };
+
+  BENCHMARK("legalTurnCounts of the batch")
+  {
+    batch.legalTurnCounts(counts);
+    return counts[0];
+  };
+}
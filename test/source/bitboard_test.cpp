@@ -1,358 +1,1315 @@
-// #include <bitboard.hpp>
+#include <initializer_list>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <bitboard/bitboard.hpp>
+#include <bitboard/utils/bit_utils.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
-// TEST_CASE("BitBoard tests", "[bitboard]")
-// {
-//   SECTION("Test of TestColor GetFigure GetColor")
-//   {
-//     BitBoard board;
-//     for (uint8_t i = 0; i < 64; i++) {
-//       for (uint8_t figure = 1; figure < 7; figure++) {
-//         for (int8_t color = -1; color <= 1; color += 2) {
-//           board = board.set(i, figure * color);
-
-//           REQUIRE(board.get(i) == figure * color);
-//         }
-//       }
-//     }
-//   }
-
-//   SECTION("Test of TestEmp")
-//   {
-//     BitBoard board;
-//     for (int i = 0; i < 64; i++) {
-//       board = board.set(i, Figure::Empty);
-//       REQUIRE(board.get(i) == Figure::Empty);
-//     }
-//   }
-
-//   SECTION("Test of Swap")
-//   {
-//     BitBoard board;
-//     for (size_t i = 0; i < 64; i++) {
-//       for (size_t j = 0; j < 64; j++) {
-//         if (i == j) {
-//           continue;
-//         }
-
-//         board = board.set(i, Figure::WPawn);
-//         board = board.set(j, Figure::BKnight);
-//         board = board.swap(i, j);
-//         REQUIRE(board.get(j) == Figure::WPawn);
-//         REQUIRE(board.get(i) == Figure::BKnight);
-//       }
-//     }
-//   }
-//   /*
-//   SECTION("Test of ExecuteTurn GenerateSubBoards TestTurn")
-//   {
-//       BitBoard board;
-//       auto subboards = board.generateSubBoards(Color::White);
-
-//       for (size_t i = 0; i < subboards.size(); i++) {
-//           BitBoard sub = board;
-//           sub = sub.executeTurn(subboards[i].getTurn());
-//           REQUIRE(sub.fen() == subboards[i].fen());
-//       }
-//   }
-//   SECTION("Test of el passant") {
-//     BitBoard board;
-//     REQUIRE(board.executeTurn(Turn(Position(51), Position(35))));
-//     REQUIRE(board.LastPawnMove() == Position(43));
-//     REQUIRE(board.executeTurn(Turn(Position(9), Position(17))));
-//     REQUIRE(board.LastPawnMove() == Position());
-//     board = BitBoard();
-//     board.SkipMove();
-//     REQUIRE(board.executeTurn(Turn(Position(9), Position(25))));
-//     REQUIRE(board.LastPawnMove() == Position(17));
-//     REQUIRE(board.executeTurn(Turn(Position(57), Position(42))));
-//     REQUIRE(board.LastPawnMove() == Position());
-//   }
-//   SECTION("Test of castling") {
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R w KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(60), Position(62))));
-//       REQUIRE(!board.RookingFlags().white_ooo);
-//       REQUIRE(!board.RookingFlags().white_oo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R w KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(60), Position(58))));
-//       REQUIRE(!board.RookingFlags().white_ooo);
-//       REQUIRE(!board.RookingFlags().white_oo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R w KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(60), Position(52))));
-//       REQUIRE(!board.RookingFlags().white_ooo);
-//       REQUIRE(!board.RookingFlags().white_oo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R w KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(56), Position(48))));
-//       REQUIRE(!board.RookingFlags().white_ooo);
-//       REQUIRE(board.RookingFlags().white_oo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R w KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(63), Position(55))));
-//       REQUIRE(board.RookingFlags().white_ooo);
-//       REQUIRE(!board.RookingFlags().white_oo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R w KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(56), Position(0))));
-//       REQUIRE(!board.RookingFlags().white_ooo);
-//       REQUIRE(!board.RookingFlags().black_ooo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R w KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(63), Position(7))));
-//       REQUIRE(!board.RookingFlags().black_oo);
-//       REQUIRE(!board.RookingFlags().white_oo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R b KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(4), Position(6))));
-//       REQUIRE(!board.RookingFlags().black_ooo);
-//       REQUIRE(!board.RookingFlags().black_oo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R b KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(4), Position(2))));
-//       REQUIRE(!board.RookingFlags().black_ooo);
-//       REQUIRE(!board.RookingFlags().black_oo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R b KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(4), Position(12))));
-//       REQUIRE(!board.RookingFlags().black_ooo);
-//       REQUIRE(!board.RookingFlags().black_oo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R b KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(0), Position(8))));
-//       REQUIRE(!board.RookingFlags().black_ooo);
-//       REQUIRE(board.RookingFlags().black_oo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R b KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(7), Position(15))));
-//       REQUIRE(board.RookingFlags().black_ooo);
-//       REQUIRE(!board.RookingFlags().black_oo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R b KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(0), Position(56))));
-//       REQUIRE(!board.RookingFlags().black_ooo);
-//       REQUIRE(!board.RookingFlags().white_ooo);
-//     }
-//     {
-//       BitBoard board("r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R b KQkq a6 0 1");
-//       REQUIRE(board.executeTurn(Turn(Position(7), Position(63))));
-//       REQUIRE(!board.RookingFlags().black_oo);
-//       REQUIRE(!board.RookingFlags().white_oo);
-//     }
-//   }
-// */
-// }
-
-// TEST_CASE("BitBoard fen tests", "[bitboard][fen]")
-// {
-//   REQUIRE(BitBoard("8/8/8/8/6pp/3P1ppP/1P3P2/8 w - - 0 0").fen()
-//           == "8/8/8/8/6pp/3P1ppP/1P3P2/8 w - - 0 0");
-//   REQUIRE(BitBoard("8/8/1p3P2/8/3B4/4p3/5p2/8 w - - 0 0").fen()
-//           == "8/8/1p3P2/8/3B4/4p3/5p2/8 w - - 0 0");
-//   REQUIRE(BitBoard("8/8/2p5/8/2R1P3/8/8/8 w - - 0 0").fen()
-//           == "8/8/2p5/8/2R1P3/8/8/8 w - - 0 0");
-//   REQUIRE(BitBoard("2q5/8/8/8/8/8/4P3/3K4 w - - 0 0").fen()
-//           == "2q5/8/8/8/8/8/4P3/3K4 w - - 0 0");
-//   REQUIRE(BitBoard("8/8/8/4pP2/8/8/8/8 w - e6 0 0").fen()
-//           == "8/8/8/4pP2/8/8/8/8 w - e6 0 0");
-//   REQUIRE(BitBoard("r6r/1b2k1bq/8/8/7B/8/8/R3K2R b KQ - 0 0").fen()
-//           == "r6r/1b2k1bq/8/8/7B/8/8/R3K2R b KQ - 0 0");
-//   REQUIRE(BitBoard("8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 0").fen()
-//           == "8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 0");
-//   REQUIRE(BitBoard("r1bqkbnr/pppppppp/n7/8/8/P7/1PPPPPPP/RNBQKBNR w KQkq - 0
-//   0")
-//               .fen()
-//           == "r1bqkbnr/pppppppp/n7/8/8/P7/1PPPPPPP/RNBQKBNR w KQkq - 0 0");
-//   REQUIRE(
-//       BitBoard(
-//           "r3k2r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQkq - 0
-//           0") .fen()
-//       == "r3k2r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQkq - 0
-//       0");
-//   REQUIRE(BitBoard(
-//               "2kr3r/p1ppqpb1/bn2Qnp1/3PN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQ - 0
-//               0") .fen()
-//           == "2kr3r/p1ppqpb1/bn2Qnp1/3PN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQ - 0
-//           0");
-//   REQUIRE(BitBoard("rnb2k1r/pp1Pbppp/2p5/q7/2B5/8/PPPQNnPP/RNB1K2R w KQ - 0
-//   0")
-//               .fen()
-//           == "rnb2k1r/pp1Pbppp/2p5/q7/2B5/8/PPPQNnPP/RNB1K2R w KQ - 0 0");
-//   REQUIRE(BitBoard("2r5/3pk3/8/2P5/8/2K5/8/8 w - - 5 4").fen()
-//           == "2r5/3pk3/8/2P5/8/2K5/8/8 w - - 0 0");
-//   REQUIRE(BitBoard("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 0
-//   0")
-//               .fen()
-//           == "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 0 0");
-//   REQUIRE(BitBoard("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/"
-//                    "R4RK1 w - - 0 10")
-//               .fen() ==
-//           "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w -
-//           - " "0 0");
-//   REQUIRE(BitBoard("3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1").fen()
-//           == "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 0");
-//   REQUIRE(BitBoard("8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1").fen()
-//           == "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 0");
-//   REQUIRE(BitBoard("8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1").fen()
-//           == "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 0");
-//   REQUIRE(BitBoard("5k2/8/8/8/8/8/8/4K2R w K - 0 1").fen()
-//           == "5k2/8/8/8/8/8/8/4K2R w K - 0 0");
-//   REQUIRE(BitBoard("3k4/8/8/8/8/8/8/R3K3 w Q - 0 1").fen()
-//           == "3k4/8/8/8/8/8/8/R3K3 w Q - 0 0");
-//   REQUIRE(BitBoard("r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1").fen()
-//           == "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 0");
-//   REQUIRE(BitBoard("r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1").fen()
-//           == "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 0");
-//   REQUIRE(BitBoard("2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1").fen()
-//           == "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 0");
-//   REQUIRE(BitBoard("8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1").fen()
-//           == "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 0");
-//   REQUIRE(BitBoard("4k3/1P6/8/8/8/8/K7/8 w - - 0 1").fen()
-//           == "4k3/1P6/8/8/8/8/K7/8 w - - 0 0");
-//   REQUIRE(BitBoard("8/P1k5/K7/8/8/8/8/8 w - - 0 1").fen()
-//           == "8/P1k5/K7/8/8/8/8/8 w - - 0 0");
-//   REQUIRE(BitBoard("K1k5/8/P7/8/8/8/8/8 w - - 0 1").fen()
-//           == "K1k5/8/P7/8/8/8/8/8 w - - 0 0");
-//   REQUIRE(BitBoard("8/k1P5/8/1K6/8/8/8/8 w - - 0 1").fen()
-//           == "8/k1P5/8/1K6/8/8/8/8 w - - 0 0");
-//   REQUIRE(BitBoard("8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1").fen()
-//           == "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 0");
-// }
-
-// static size_t Counter(BitBoard board, size_t depth)
-// {
-//   if (!depth) {
-//     return 1;
-//   }
-//   size_t counter = 0;
-//   Turn turns[216];
-//   bool is_mate;
-//   int count = board.getTurns(board.side(), turns, is_mate);
-//   for (int i = 0; i < count; i++) {
-//     counter += Counter(board.executeTurn(board.side(), turns[i]), depth - 1);
-//   }
-//   return counter;
-// }
-
-// static bool MateTest(BitBoard board)
-// {
-//   Turn turns[216];
-//   bool is_mate;
-//   int count = board.getTurns(board.side(), turns, is_mate);
-
-//   return is_mate && count == 0;
-// }
-
-// TEST_CASE("BitBoard generation tests", "[bitboard][generation]")
-// {
-//   REQUIRE(Counter(BitBoard(), 1) == 20);
-//   REQUIRE(Counter(BitBoard(), 2) == 400);
-//   REQUIRE(Counter(BitBoard(), 3) == 8902);
-//   REQUIRE(Counter(BitBoard(), 4) == 197281);
-//   REQUIRE(Counter(BitBoard(), 5) == 4865609);
-//   REQUIRE(Counter(BitBoard(), 6) == 119060324);
-//   // REQUIRE(Counter(BitBoard(), 7) == 3195901860);
-
-//   REQUIRE(MateTest(BitBoard {"Q3k3/Q7/8/8/8/8/8/3K4 b - - 1 1"}) == true);
-//   REQUIRE(MateTest(BitBoard {"4k3/Q7/8/8/8/8/8/3K3Q b - - 1 1"}) == false);
-// }
-
-// TEST_CASE("BitBoard generation advanced tests", "[bitboard][generation]")
-// {
-//   REQUIRE(
-//       Counter(
-//           BitBoard(
-//               "rnbqkbnr/pppppp1p/8/8/5PpP/7R/PPPPP1P1/RNBQKBN1 b Qkq f3 0
-//               1"),
-//           5)
-//       == 8581394);
-//   REQUIRE(
-//       Counter(BitBoard(
-//                   "rnbqkbnr/ppp2pp1/7p/3pP3/8/8/PPPKPPPP/RNBQ1BNR w kq d6 0
-//                   0"),
-//               5)
-//       == 21342522);
-//   // test from issue #6
-//   REQUIRE(Counter(BitBoard("8/1p2N3/p4p1k/1r1p2p1/8/P7/6PP/4R1KR w - - 0 0"),
-//   5)
-//           == 2670607);
-//   REQUIRE(Counter(BitBoard("r6r/1b2k1bq/8/8/7B/8/8/R3K2R b KQ - 3 2"), 1) ==
-//   8); REQUIRE(Counter(BitBoard("8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 3"), 1) ==
-//   8); REQUIRE(
-//       Counter(BitBoard(
-//                   "r1bqkbnr/pppppppp/n7/8/8/P7/1PPPPPPP/RNBQKBNR w KQkq - 2
-//                   2"),
-//               1)
-//       == 19);
-//   REQUIRE(
-//       Counter(
-//           BitBoard("r3k2r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/" "PPPBBPPP/R3K2R
-//           b "
-//                                                              "KQkq - 3 2"),
-//           1)
-//       == 5);
-
-//   REQUIRE(
-//       Counter(BitBoard(
-//                   "2kr3r/p1ppqpb1/bn2Qnp1/3PN3/1p2P3/2N5/PPPBBPPP/" "R3K2R b
-//                   "
-//                                                                     "KQ - 3
-//                                                                     2"),
-//               1)
-//       == 44);
-//   REQUIRE(
-//       Counter(
-//           BitBoard("rnb2k1r/pp1Pbppp/2p5/q7/2B5/8/PPPQNnPP/RNB1K2R w KQ - 3
-//           9"), 1)
-//       == 39);
-//   REQUIRE(Counter(BitBoard("2r5/3pk3/8/2P5/8/2K5/8/8 w - - 5 4"), 1) == 9);
-//   REQUIRE(
-//       Counter(
-//           BitBoard("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1
-//           8"), 3)
-//       == 62379);
-//   REQUIRE(
-//       Counter(BitBoard(
-//                   "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/"
-//                   "P1NP1N2/1PP1QPPP/"
-//                                                             "R4RK1 w - - 0
-//                                                             10"),
-//               3)
-//       == 89890);
-//   REQUIRE(Counter(BitBoard("3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1"), 6) ==
-//   1134888); REQUIRE(Counter(BitBoard("8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1"),
-//   6)
-//           == 1015133);
-//   REQUIRE(Counter(BitBoard("8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1"), 6)
-//           == 1440467);
-//   REQUIRE(Counter(BitBoard("5k2/8/8/8/8/8/8/4K2R w K - 0 1"), 6) == 661072);
-//   REQUIRE(Counter(BitBoard("3k4/8/8/8/8/8/8/R3K3 w Q - 0 1"), 6) == 803711);
-//   REQUIRE(Counter(BitBoard("r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1"), 4)
-//           == 1274206);
-//   REQUIRE(Counter(BitBoard("r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1"), 4)
-//           == 1720476);
-//   REQUIRE(Counter(BitBoard("2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1"), 6) ==
-//   3821001); REQUIRE(Counter(BitBoard("8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1"),
-//   5)
-//           == 1004658);
-//   REQUIRE(Counter(BitBoard("4k3/1P6/8/8/8/8/K7/8 w - - 0 1"), 6) == 217342);
-//   REQUIRE(Counter(BitBoard("8/P1k5/K7/8/8/8/8/8 w - - 0 1"), 6) == 92683);
-//   REQUIRE(Counter(BitBoard("K1k5/8/P7/8/8/8/8/8 w - - 0 1"), 6) == 2217);
-//   REQUIRE(Counter(BitBoard("8/k1P5/8/1K6/8/8/8/8 w - - 0 1"), 7) == 567584);
-//   REQUIRE(Counter(BitBoard("8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1"), 4) ==
-//   23527);
-// }
+#include "magic.hpp"
+#include "playout.hpp"
+
+using bitboard::BitBoard;
+using bitboard::boardFromFen;
+using bitboard::FenStatus;
+using bitboard::Figure;
+using bitboard::Position;
+using bitboard::Turn;
+using bitboard::operator"" _bm;
+using bitboard::operator"" _p;
+
+TEST_CASE("BitBoard tests", "[bitboard]")
+{
+  SECTION("Test of TestColor GetFigure GetColor")
+  {
+    BitBoard board;
+    for (uint8_t i = 0; i < 64; i++) {
+      for (int8_t figure = 1; figure < 7; figure++) {
+        for (int8_t color = -1; color <= 1; color += 2) {
+          const auto value = static_cast<Figure>(figure * color);
+          board.set(Position(i), value);
+
+          REQUIRE(board.get(Position(i)) == value);
+        }
+      }
+    }
+  }
+
+  SECTION("Test of TestEmp")
+  {
+    BitBoard board;
+    for (uint8_t i = 0; i < 64; i++) {
+      board.set(Position(i), Figure::kEmpty);
+      REQUIRE(board.get(Position(i)) == Figure::kEmpty);
+    }
+  }
+
+  SECTION("Test of Swap")
+  {
+    BitBoard board;
+    for (uint8_t i = 0; i < 64; i++) {
+      for (uint8_t j = 0; j < 64; j++) {
+        if (i == j) {
+          continue;
+        }
+
+        board.set(Position(i), Figure::kWPawn);
+        board.set(Position(j), Figure::kBKnight);
+        board.swap(Position(i), Position(j));
+        REQUIRE(board.get(Position(j)) == Figure::kWPawn);
+        REQUIRE(board.get(Position(i)) == Figure::kBKnight);
+      }
+    }
+  }
+}
+
+namespace
+{
+
+bool hasFlag(const BitBoard& board, BitBoard::Flags flag)
+{
+  return (static_cast<uint8_t>(board.flags()) & static_cast<uint8_t>(flag))
+      != 0;
+}
+
+}  // namespace
+
+TEST_CASE("BitBoard executeTurn", "[bitboard][turn]")
+{
+  using Flags = BitBoard::Flags;
+
+  SECTION("Test of el passant")
+  {
+    BitBoard board(bitboard::kStartPosition);
+    board.executeTurn(Turn("e2"_p, "e4"_p));
+    REQUIRE(board.elPassant() == "e3"_p);
+    REQUIRE(board.side() == bitboard::Color::kBlack);
+    board.executeTurn(Turn("g8"_p, "f6"_p));
+    REQUIRE(board.elPassant() == Position());
+    board.executeTurn(Turn("e4"_p, "e5"_p));
+    board.executeTurn(Turn("d7"_p, "d5"_p));
+    REQUIRE(board.elPassant() == "d6"_p);
+    board.executeTurn(Turn("e5"_p, "d6"_p));
+    REQUIRE(board.fen()
+            == "rnbqkb1r/ppp1pppp/3P1n2/8/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 3");
+  }
+
+  SECTION("Test of promotion and counters")
+  {
+    BitBoard board("4k3/1P6/8/8/8/8/6n1/4K3 w - - 7 40");
+    board.executeTurn(Turn("b7"_p, "b8"_p, Figure::kKnight));
+    REQUIRE(board.fen() == "1N2k3/8/8/8/8/8/6n1/4K3 b - - 0 40");
+    board.executeTurn(Turn("g2"_p, "e1"_p));
+    REQUIRE(board.fen() == "1N2k3/8/8/8/8/8/8/4n3 w - - 0 41");
+  }
+
+  SECTION("Changed figures")
+  {
+    const BitBoard board("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+    bitboard::FigureChange changes[bitboard::kTurnMaxChanges];
+    REQUIRE(board.turnChanges(Turn("e1"_p, "g1"_p), changes) == 4);
+    REQUIRE(changes[0].figure == Figure::kWRook);
+    REQUIRE(changes[0].position == "h1"_p);
+    REQUIRE(changes[0].count == -1);
+    REQUIRE(changes[1].position == "f1"_p);
+    REQUIRE(changes[3].figure == Figure::kWKing);
+    REQUIRE(changes[3].position == "g1"_p);
+    REQUIRE(changes[3].count == 1);
+    REQUIRE(board.turnChanges(Turn("a1"_p, "a8"_p), changes) == 3);
+    REQUIRE(changes[0].figure == Figure::kBRook);
+    REQUIRE(board.turnChanges(
+                Turn("e4"_p, "e5"_p, bitboard::TurnKind::kQuiet), changes)
+            == 0);
+  }
+
+  SECTION("Stale classified turns change nothing")
+  {
+    const BitBoard start = bitboard::kStartBitBoard;
+    for (const Turn turn :
+         {Turn("e2"_p, "e4"_p, bitboard::TurnKind::kCapture),
+          Turn("e4"_p, "e5"_p, bitboard::TurnKind::kQuiet),
+          Turn("a2"_p, "b3"_p, bitboard::TurnKind::kPromotionCapture),
+          Turn("e2"_p, "e7"_p, bitboard::TurnKind::kQuiet),
+          Turn("d1"_p, "d2"_p, bitboard::TurnKind::kCapture),
+          Turn("e7"_p, "e5"_p, bitboard::TurnKind::kDoublePush),
+          Turn("g1"_p, "e2"_p, bitboard::TurnKind::kCastling)})
+    {
+      BitBoard board = start;
+      board.executeTurn(turn);
+      REQUIRE(board == start);
+      REQUIRE(board.hash() == start.hash());
+      bitboard::FigureChange changes[bitboard::kTurnMaxChanges];
+      REQUIRE(start.turnChanges(turn, changes) == 0);
+    }
+  }
+
+  SECTION("Test of castling")
+  {
+    constexpr auto kFen =
+        "r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R w KQkq - 0 1";
+    constexpr auto kFenBlack =
+        "r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R b KQkq - 0 1";
+
+    const auto check = [](const char* fen,
+                          Turn turn,
+                          std::initializer_list<Flags> lost,
+                          std::initializer_list<Flags> kept)
+    {
+      BitBoard board(fen);
+      board.executeTurn(turn);
+      for (const auto flag : lost) {
+        REQUIRE(!hasFlag(board, flag));
+      }
+      for (const auto flag : kept) {
+        REQUIRE(hasFlag(board, flag));
+      }
+      return board.fen();
+    };
+
+    REQUIRE(check(kFen,
+                  Turn("e1"_p, "g1"_p),
+                  {Flags::kFlagsWhiteOo, Flags::kFlagsWhiteOoo},
+                  {Flags::kFlagsBlackOo, Flags::kFlagsBlackOoo})
+            == "r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/R4RK1 b kq - 1 1");
+    REQUIRE(check(kFen,
+                  Turn("e1"_p, "c1"_p),
+                  {Flags::kFlagsWhiteOo, Flags::kFlagsWhiteOoo},
+                  {})
+            == "r3k2r/1ppp1pp1/8/8/8/8/1PPP1PP1/2KR3R b kq - 1 1");
+    check(kFen,
+          Turn("e1"_p, "e2"_p),
+          {Flags::kFlagsWhiteOo, Flags::kFlagsWhiteOoo},
+          {});
+    check(kFen,
+          Turn("a1"_p, "a2"_p),
+          {Flags::kFlagsWhiteOoo},
+          {Flags::kFlagsWhiteOo});
+    check(kFen,
+          Turn("h1"_p, "h2"_p),
+          {Flags::kFlagsWhiteOo},
+          {Flags::kFlagsWhiteOoo});
+    check(kFen,
+          Turn("a1"_p, "a8"_p),
+          {Flags::kFlagsWhiteOoo, Flags::kFlagsBlackOoo},
+          {Flags::kFlagsWhiteOo, Flags::kFlagsBlackOo});
+    check(kFen,
+          Turn("h1"_p, "h8"_p),
+          {Flags::kFlagsWhiteOo, Flags::kFlagsBlackOo},
+          {Flags::kFlagsWhiteOoo, Flags::kFlagsBlackOoo});
+    REQUIRE(check(kFenBlack,
+                  Turn("e8"_p, "g8"_p),
+                  {Flags::kFlagsBlackOo, Flags::kFlagsBlackOoo},
+                  {Flags::kFlagsWhiteOo, Flags::kFlagsWhiteOoo})
+            == "r4rk1/1ppp1pp1/8/8/8/8/1PPP1PP1/R3K2R w KQ - 1 2");
+    check(kFenBlack,
+          Turn("e8"_p, "c8"_p),
+          {Flags::kFlagsBlackOo, Flags::kFlagsBlackOoo},
+          {});
+    check(kFenBlack,
+          Turn("a8"_p, "a7"_p),
+          {Flags::kFlagsBlackOoo},
+          {Flags::kFlagsBlackOo});
+    check(kFenBlack,
+          Turn("h8"_p, "h7"_p),
+          {Flags::kFlagsBlackOo},
+          {Flags::kFlagsBlackOoo});
+    check(kFenBlack,
+          Turn("a8"_p, "a1"_p),
+          {Flags::kFlagsBlackOoo, Flags::kFlagsWhiteOoo},
+          {Flags::kFlagsBlackOo, Flags::kFlagsWhiteOo});
+  }
+}
+
+TEST_CASE("BitBoard classify", "[bitboard][turn]")
+{
+  using bitboard::TurnKind;
+
+  const BitBoard board(
+      "r3k2r/1P6/8/3pP3/8/8/4P3/R3K2R w KQkq d6 0 1");
+  REQUIRE(board.classify(Turn("e2e3")).kind() == TurnKind::kQuiet);
+  REQUIRE(board.classify(Turn("e2e4")).kind() == TurnKind::kDoublePush);
+  REQUIRE(board.classify(Turn("e5d6")).kind() == TurnKind::kElPassant);
+  REQUIRE(board.classify(Turn("e1g1")).kind() == TurnKind::kCastling);
+  REQUIRE(board.classify(Turn("e1c1")).kind() == TurnKind::kCastling);
+  REQUIRE(board.classify(Turn("e1f1")).kind() == TurnKind::kQuiet);
+  REQUIRE(board.classify(Turn("a1a8")).kind() == TurnKind::kCapture);
+  REQUIRE(board.classify(Turn("b7b8n")).kind() == TurnKind::kPromotion);
+  REQUIRE(board.classify(Turn("b7b8n")).figure() == Figure::kKnight);
+  REQUIRE(board.classify(Turn("b7a8")).kind()
+          == TurnKind::kPromotionCapture);
+  REQUIRE(board.classify(Turn("b7a8")).figure() == Figure::kQueen);
+  REQUIRE(board.classify(Turn("d4d3")).kind() == TurnKind::kUnknown);
+
+  // a classified turn is kept as it is
+  const Turn quiet(Position("e2"), Position("e4"), TurnKind::kQuiet);
+  REQUIRE(board.classify(quiet).kind() == TurnKind::kQuiet);
+
+  BitBoard copy(board);
+  copy.executeTurn(board.classify(Turn("b7a8r")));
+  REQUIRE(copy.fen() == "R3k2r/8/8/3pP3/8/8/4P3/R3K2R b KQk - 0 1");
+  REQUIRE(copy.pieces(Figure::kBRook) == positionToMask(Position("h8")));
+}
+
+TEST_CASE("BitBoard isLegal", "[bitboard][turn]")
+{
+  using bitboard::TurnKind;
+
+  const auto legal = [](std::string_view fen, std::string_view turn)
+  { return BitBoard(fen).isLegal(Turn(turn)); };
+
+  SECTION("Reach")
+  {
+    REQUIRE(legal(bitboard::kStartPosition, "e2e4"));
+    REQUIRE(legal(bitboard::kStartPosition, "g1f3"));
+    REQUIRE_FALSE(legal(bitboard::kStartPosition, "e2e5"));
+    REQUIRE_FALSE(legal(bitboard::kStartPosition, "e7e5"));
+    REQUIRE_FALSE(legal(bitboard::kStartPosition, "e2d3"));
+    REQUIRE_FALSE(legal(bitboard::kStartPosition, "f1c4"));
+    REQUIRE_FALSE(legal(bitboard::kStartPosition, "d1d2"));
+    REQUIRE_FALSE(legal(bitboard::kStartPosition, "e3e4"));
+    REQUIRE_FALSE(BitBoard(bitboard::kStartPosition).isLegal(Turn()));
+    REQUIRE_FALSE(legal("4k3/8/8/8/8/4p3/4P3/4K3 w - - 0 1", "e2e4"));
+    REQUIRE_FALSE(legal("4k3/8/8/8/4p3/8/4P3/4K3 w - - 0 1", "e2e4"));
+    REQUIRE(legal("4k3/8/8/8/8/3p4/4P3/4K3 w - - 0 1", "e2d3"));
+    REQUIRE_FALSE(legal("4k3/8/8/8/3P4/8/8/4K3 w - - 0 1", "d4d2"));
+    REQUIRE_FALSE(legal("4k3/4p3/8/8/8/8/8/4K3 b - - 0 1", "e7e8q"));
+  }
+
+  SECTION("Promotion")
+  {
+    const std::string_view fen = "1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1";
+    REQUIRE(legal(fen, "a7a8q"));
+    REQUIRE(legal(fen, "a7b8n"));
+    REQUIRE_FALSE(legal(fen, "a7a8"));
+    REQUIRE_FALSE(legal(fen, "e1e2q"));
+
+    const BitBoard board(fen);
+    REQUIRE(board.isLegal(Turn(Position("a7"),
+                               Position("b8"),
+                               promotionKind(Figure::kRook, true))));
+    REQUIRE_FALSE(board.isLegal(Turn(Position("a7"),
+                                     Position("a8"),
+                                     promotionKind(Figure::kRook, true))));
+    REQUIRE_FALSE(board.isLegal(
+        Turn(Position("a7"), Position("a8"), TurnKind::kCapture)));
+  }
+
+  SECTION("Pins and checks")
+  {
+    // the knight is pinned, the bishop blocks the check of the rook
+    const std::string_view pin = "4r1k1/8/8/8/8/8/4N3/4K3 w - - 0 1";
+    REQUIRE_FALSE(legal(pin, "e2c3"));
+    REQUIRE(legal(pin, "e1d1"));
+    REQUIRE_FALSE(legal(pin, "e1e2"));
+
+    const std::string_view check = "4r1k1/8/8/8/8/8/2B5/4K3 w - - 0 1";
+    REQUIRE(legal(check, "c2e4"));
+    REQUIRE_FALSE(legal(check, "c2d3"));
+    REQUIRE(legal(check, "e1f2"));
+    REQUIRE_FALSE(legal(check, "e1e2"));
+
+    // the king can't step back along the ray of the checking rook
+    REQUIRE_FALSE(legal("4k3/8/8/8/4r3/8/4K3/8 w - - 0 1", "e2e1"));
+    REQUIRE(legal("4k3/8/8/8/4r3/8/4K3/8 w - - 0 1", "e2d1"));
+    // capturing the checking figure, but not into a defended square
+    REQUIRE(legal("4k3/8/8/8/8/8/3q4/4K3 w - - 0 1", "e1d2"));
+    REQUIRE_FALSE(legal("4k3/8/8/8/8/2b5/3q4/4K3 w - - 0 1", "e1d2"));
+  }
+
+  SECTION("El passant")
+  {
+    REQUIRE(legal("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6"));
+    REQUIRE_FALSE(legal("4k3/8/8/3pP3/8/8/8/4K3 w - - 0 1", "e5d6"));
+    // both pawns leave the rank of the king
+    REQUIRE_FALSE(legal("8/8/8/K2pP2r/8/8/8/4k3 w - d6 0 1", "e5d6"));
+    // the captured pawn gives the check
+    REQUIRE(legal("8/8/8/3pP3/4K3/8/8/4k3 w - d6 0 1", "e5d6"));
+  }
+
+  SECTION("Castling")
+  {
+    const std::string_view fen = "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1";
+    REQUIRE(legal(fen, "e1g1"));
+    REQUIRE(legal(fen, "e1c1"));
+    REQUIRE_FALSE(legal("r3k2r/8/8/8/8/8/8/R3K2R w Qkq - 0 1", "e1g1"));
+    REQUIRE_FALSE(legal("r3k2r/8/8/8/8/8/8/RN2K2R w KQkq - 0 1", "e1c1"));
+    REQUIRE_FALSE(legal("r3k2r/8/8/8/8/8/8/R3K1NR w KQkq - 0 1", "e1g1"));
+    // in check, through an attacked square, into an attacked square
+    REQUIRE_FALSE(legal("r3k2r/8/8/8/8/8/4r3/R3K2R w KQkq - 0 1", "e1g1"));
+    REQUIRE_FALSE(legal("r3k2r/8/8/8/8/8/5r2/R3K2R w KQkq - 0 1", "e1g1"));
+    REQUIRE_FALSE(legal("r3k2r/8/8/8/8/8/6r1/R3K2R w KQkq - 0 1", "e1g1"));
+    // only the squares the king crosses have to be safe
+    REQUIRE(legal("r3k2r/8/8/8/8/8/1r6/R3K2R w KQkq - 0 1", "e1c1"));
+    REQUIRE(legal("r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1", "e8c8"));
+  }
+
+  SECTION("Opera game")
+  {
+    BitBoard board(bitboard::kStartPosition);
+    for (const auto* text :
+         {"e2e4", "e7e5", "g1f3", "d7d6", "d2d4", "c8g4", "d4e5", "g4f3",
+          "d1f3", "d6e5", "f1c4", "g8f6", "f3b3", "d8e7", "b1c3", "c7c6",
+          "c1g5", "b7b5", "c3b5", "c6b5", "c4b5", "b8d7", "e1c1", "a8d8",
+          "d1d7", "d8d7", "h1d1", "e7e6", "b5d7", "f6d7", "b3b8", "d7b8",
+          "d1d8"})
+    {
+      const Turn turn(text);
+      REQUIRE(board.isLegal(turn));
+      REQUIRE(board.isLegal(board.classify(turn)));
+      board.executeTurn(turn);
+    }
+  }
+}
+
+TEST_CASE("BitBoard isLegal benchmark", "[.][benchmark][bitboard]")
+{
+  const BitBoard board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+  BENCHMARK("validate 4096 turns")
+  {
+    int legal = 0;
+    for (uint8_t from = 0; from < 64; ++from) {
+      for (uint8_t to = 0; to < 64; ++to) {
+        legal += board.isLegal(Turn(Position(from), Position(to))) ? 1 : 0;
+      }
+    }
+    return legal;
+  };
+}
+
+TEST_CASE("BitBoard attackersTo", "[bitboard][attack]")
+{
+  const BitBoard board("4k3/8/3p4/1n2r3/2P5/3K1B2/8/3R4 w - - 0 1");
+  const auto occupancy = board.occupancy();
+
+  REQUIRE(board.attackersTo("d5"_p, occupancy)
+          == ("c4"_bm | "e5"_bm | "f3"_bm));
+  REQUIRE(board.attackersTo("d3"_p, occupancy) == "d1"_bm);
+  REQUIRE(board.attackersTo("e4"_p, occupancy)
+          == ("d3"_bm | "f3"_bm | "e5"_bm));
+  // removing the king opens the d-file for the rook on d1
+  REQUIRE(board.attackersTo("d4"_p, occupancy & ~"d3"_bm)
+          == ("b5"_bm | "d1"_bm | "d3"_bm));
+  REQUIRE(!board.kingAttacked(bitboard::Color::kWhite));
+  REQUIRE(!board.kingAttacked(bitboard::Color::kBlack));
+}
+
+TEST_CASE("BitBoard attack maps", "[bitboard][attack]")
+{
+  // the squares attacked by a color with sliders seeing through the king of
+  // the other color
+  const auto reference = [](const BitBoard& board, bitboard::Color color)
+  {
+    const bool white = color == bitboard::Color::kWhite;
+    const bitboard::bitboard_field own =
+        white ? board.whites() : board.blacks();
+    const Figure enemy_king = white ? Figure::kBKing : Figure::kWKing;
+    bitboard::bitboard_field king = 0;
+    for (uint8_t i = 0; i < 64; i++) {
+      if (board.get(Position(i)) == enemy_king) {
+        king = bitboard::positionToMask(Position(i));
+      }
+    }
+    bitboard::bitboard_field result = 0;
+    for (uint8_t i = 0; i < 64; i++) {
+      if ((board.attackersTo(Position(i), board.occupancy() & ~king) & own)
+          != 0)
+      {
+        result |= bitboard::positionToMask(Position(i));
+      }
+    }
+    return result;
+  };
+
+  BitBoard board("4k3/4r3/8/8/7b/8/4NP2/4K3 w - - 0 1");
+  REQUIRE(board.attacks(bitboard::Color::kWhite)
+          == reference(board, bitboard::Color::kWhite));
+  REQUIRE(board.attacks(bitboard::Color::kBlack)
+          == reference(board, bitboard::Color::kBlack));
+  // the rook on e7 sees e1 and the square behind the king
+  REQUIRE((board.attacks(bitboard::Color::kBlack) & "e3"_bm) != 0);
+  REQUIRE(board.checkers() == 0);
+  REQUIRE(board.pinned() == ("e2"_bm | "f2"_bm));
+
+  SECTION("Figures of both colors between block the pin")
+  {
+    board.set("e4"_p, Figure::kBPawn);
+    REQUIRE(board.pinned() == "f2"_bm);
+    board.set("e4"_p, Figure::kWPawn);
+    REQUIRE(board.pinned() == "f2"_bm);
+  }
+
+  SECTION("The cache follows the turns")
+  {
+    board.executeTurn(Turn("e1"_p, "d1"_p));
+    REQUIRE(board.checkers() == 0);
+    REQUIRE(board.pinned() == 0);
+    REQUIRE(board.attacks(bitboard::Color::kWhite)
+            == reference(board, bitboard::Color::kWhite));
+    REQUIRE(board.attacks(bitboard::Color::kBlack)
+            == reference(board, bitboard::Color::kBlack));
+
+    board.executeTurn(Turn("e7"_p, "e1"_p));
+    REQUIRE(board.checkers() == "e1"_bm);
+    REQUIRE(board.pinned() == 0);
+    REQUIRE(board.attacks(bitboard::Color::kWhite)
+            == reference(board, bitboard::Color::kWhite));
+    REQUIRE(board.attacks(bitboard::Color::kBlack)
+            == reference(board, bitboard::Color::kBlack));
+  }
+
+  SECTION("Copies keep their own cache")
+  {
+    const BitBoard copy(board);
+    board.executeTurn(Turn("e1"_p, "d1"_p));
+    REQUIRE(copy.pinned() == ("e2"_bm | "f2"_bm));
+    REQUIRE(board.pinned() == 0);
+    REQUIRE(copy.attacks(bitboard::Color::kWhite)
+            != board.attacks(bitboard::Color::kWhite));
+  }
+}
+
+TEST_CASE("BitBoard attack counts", "[bitboard][attack]")
+{
+  SECTION("Adders")
+  {
+    bitboard::AttackCounts counts;
+    counts.add("a1"_bm | "b1"_bm, "b1"_bm | "c1"_bm);
+    counts.add("b1"_bm);
+    REQUIRE(counts.count("a1"_p) == 1);
+    REQUIRE(counts.count("b1"_p) == 3);
+    REQUIRE(counts.count("d1"_p) == 0);
+    REQUIRE(counts.once() == ("a1"_bm | "b1"_bm | "c1"_bm));
+    REQUIRE(counts.twice() == "b1"_bm);
+    for (int i = 0; i < 20; ++i) {
+      counts.add("a1"_bm);
+    }
+    REQUIRE(counts.count("a1"_p) == 15);
+    REQUIRE(counts.count("b1"_p) == 3);
+  }
+
+  SECTION("Figures of a position")
+  {
+    for (const char* fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/"
+          "R3K2R w KQkq - 0 1",
+          "4k3/4r3/8/8/7b/8/4NP2/4K3 w - - 0 1",
+          "1q2k2q/8/3qq3/8/8/3QQ3/8/1Q2K2Q w - - 0 1"})
+    {
+      const BitBoard board(fen);
+      for (const auto color :
+           {bitboard::Color::kWhite, bitboard::Color::kBlack})
+      {
+        const bool white = color == bitboard::Color::kWhite;
+        const bitboard::bitboard_field own =
+            white ? board.whites() : board.blacks();
+        const bitboard::bitboard_field occupancy = board.occupancy()
+            & ~board.pieces(white ? Figure::kBKing : Figure::kWKing);
+        const bitboard::AttackCounts counts = board.attackCounts(color);
+        uint8_t all[64];
+        counts.counts(all);
+        for (uint8_t i = 0; i < 64; i++) {
+          const auto attackers = static_cast<uint8_t>(bitboard::popCount(
+              board.attackersTo(Position(i), occupancy) & own));
+          REQUIRE(all[i] == attackers);
+        }
+        REQUIRE(counts.once() == board.attacks(color));
+      }
+    }
+  }
+}
+
+TEST_CASE("BitBoard mobility", "[bitboard][attack]")
+{
+  SECTION("Start position")
+  {
+    const BitBoard board(bitboard::kStartPosition);
+    bitboard::Mobility expected;
+    expected.figures[0] = 16;
+    expected.figures[1] = 4;
+    REQUIRE(board.mobility(bitboard::Color::kWhite) == expected);
+    REQUIRE(board.mobility(bitboard::Color::kBlack) == expected);
+  }
+
+  SECTION("Pawns")
+  {
+    // e4 pushes and takes d5, f5 is covered by the g6 pawn; a2 is blocked
+    const BitBoard board("4k3/8/6p1/3p1n2/4P3/n7/P7/4K3 w - - 0 1");
+    const auto mobility = board.mobility(bitboard::Color::kWhite);
+    REQUIRE(mobility.figures[0] == 2);
+    REQUIRE(mobility.figures[5] == 5);
+  }
+
+  SECTION("Figures against the lookups")
+  {
+    for (const char* fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/"
+          "R3K2R w KQkq - 0 1",
+          "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 1",
+          "6k1/5ppp/8/8/3N4/8/1B3PPP/3QR1K1 w - - 0 1"})
+    {
+      const BitBoard board(fen);
+      for (const auto color :
+           {bitboard::Color::kWhite, bitboard::Color::kBlack})
+      {
+        const bool white = color == bitboard::Color::kWhite;
+        const int sign = white ? 1 : -1;
+        const bitboard::bitboard_field own =
+            white ? board.whites() : board.blacks();
+        const bitboard::bitboard_field occupancy = board.occupancy();
+        const Figure enemy_pawn = white ? Figure::kBPawn : Figure::kWPawn;
+        const Figure enemy_king = white ? Figure::kBKing : Figure::kWKing;
+        const auto king_square = static_cast<uint8_t>(
+            bitboard::log2_64(board.pieces(enemy_king)));
+        bitboard::bitboard_field zone = 0;
+        for (uint8_t i = 0; i < 64; i++) {
+          const Position position(i);
+          const Position king(king_square);
+          const int dx = position.x() - king.x();
+          const int dy = position.y() - king.y();
+          if (dx >= -1 && dx <= 1 && dy >= -1 && dy <= 1) {
+            zone |= bitboard::positionToMask(position);
+          }
+        }
+
+        bitboard::Mobility expected;
+        bitboard::bitboard_field zone_attackers = 0;
+        for (uint8_t i = 0; i < 64; i++) {
+          const auto mask = bitboard::positionToMask(Position(i));
+          const auto attackers =
+              board.attackersTo(Position(i), occupancy) & own;
+          const bool safe = (own & mask) == 0
+              && (board.attackersTo(Position(i), occupancy)
+                  & board.pieces(enemy_pawn))
+                  == 0;
+          for (int8_t type = 2; safe && type <= 5; type++) {
+            expected.figures[type - 1] = static_cast<uint8_t>(
+                expected.figures[type - 1]
+                + bitboard::popCount(
+                    attackers
+                    & board.pieces(static_cast<Figure>(type * sign))));
+          }
+          if ((zone & mask) != 0) {
+            const auto figures =
+                attackers & ~board.pieces(static_cast<Figure>(6 * sign));
+            zone_attackers |= figures;
+            expected.king_attacks = static_cast<uint8_t>(
+                expected.king_attacks + bitboard::popCount(figures));
+          }
+        }
+        for (auto bit = bitboard::takeBit(zone_attackers); bit;
+             bit = bitboard::takeBit(zone_attackers))
+        {
+          const auto figure = static_cast<int8_t>(board.get(
+              Position(static_cast<uint8_t>(bitboard::log2_64(bit)))));
+          expected.king_attackers++;
+          expected.king_attack_weight +=
+              bitboard::kKingAttackWeights[(figure * sign) - 1];
+        }
+
+        const auto mobility = board.mobility(color);
+        for (std::size_t type = 1; type < 5; type++) {
+          REQUIRE(mobility.figures[type] == expected.figures[type]);
+        }
+        REQUIRE(mobility.king_attackers == expected.king_attackers);
+        REQUIRE(mobility.king_attacks == expected.king_attacks);
+        REQUIRE(mobility.king_attack_weight == expected.king_attack_weight);
+      }
+    }
+  }
+}
+
+TEST_CASE("BitBoard mobility benchmark", "[.][benchmark][attack]")
+{
+  const BitBoard board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+  BENCHMARK("mobility from the lookups")
+  {
+    return board.mobility(bitboard::Color::kWhite).figures[4];
+  };
+
+  BENCHMARK("turns counted per figure")
+  {
+    Turn turns[bitboard::kChessMaxTurns];
+    const std::size_t count = board.getTurns(turns);
+    uint8_t figures[6] = {};
+    for (std::size_t i = 0; i < count; ++i) {
+      figures[static_cast<int8_t>(board.get(turns[i].from())) - 1]++;
+    }
+    return figures[4];
+  };
+}
+
+TEST_CASE("BitBoard attack counts benchmark", "[.][benchmark][attack]")
+{
+  const BitBoard board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+  BENCHMARK("bit-sliced counters")
+  {
+    uint8_t counts[64];
+    board.attackCounts(bitboard::Color::kWhite).counts(counts);
+    return counts[20];
+  };
+
+  BENCHMARK("attackers of every square into an array")
+  {
+    uint8_t counts[64];
+    const auto all = board.occupancy() & ~board.pieces(Figure::kBKing);
+    for (uint8_t i = 0; i < 64; i++) {
+      counts[i] = static_cast<uint8_t>(bitboard::popCount(
+          board.attackersTo(Position(i), all) & board.whites()));
+    }
+    return counts[20];
+  };
+}
+
+TEST_CASE("BitBoard sliders", "[bitboard][attack]")
+{
+  // the hyperbola backend is compiled in every build, only one of them
+  // selects it; check it against the rays and the lookups of this build
+  std::mt19937_64 random(40);
+  for (std::size_t i = 0; i < 2000; ++i) {
+    // from dense to sparse occupancies
+    bitboard::bitboard_field occupancy = random();
+    for (std::size_t thin = 0; thin < i % 4; ++thin) {
+      occupancy &= random();
+    }
+    for (uint8_t square = 0; square < 64; ++square) {
+      const Position position(square);
+      const auto rook = bitboard::hyperbolaRook(position, occupancy);
+      const auto bishop = bitboard::hyperbolaBishop(position, occupancy);
+      INFO(position.toString() << " " << occupancy);
+      REQUIRE(rook == bitboard::generateRookAttack(square, occupancy));
+      REQUIRE(bishop == bitboard::generateBishopAttack(square, occupancy));
+      REQUIRE(rook == bitboard::processRook(position, occupancy));
+      REQUIRE(bishop == bitboard::processBishop(position, occupancy));
+    }
+  }
+}
+
+TEST_CASE("BitBoard slider benchmark", "[.][benchmark][attack]")
+{
+  // compare the BITBOARD_SLIDERS backends, attackersTo is mostly slider
+  // lookups
+  const BitBoard board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  const auto occupancy = board.occupancy();
+
+  BENCHMARK("attackers of 64 squares")
+  {
+    bitboard::bitboard_field result = 0;
+    for (uint8_t i = 0; i < 64; ++i) {
+      result ^= board.attackersTo(Position(i), occupancy);
+    }
+    return result;
+  };
+}
+
+TEST_CASE("BitBoard fen tests", "[bitboard][fen]")
+{
+  const char* const fens[] = {
+      "8/8/8/8/6pp/3P1ppP/1P3P2/8 w - - 0 0",
+      "8/8/1p3P2/8/3B4/4p3/5p2/8 w - - 0 0",
+      "8/8/2p5/8/2R1P3/8/8/8 w - - 0 0",
+      "2q5/8/8/8/8/8/4P3/3K4 w - - 0 0",
+      "8/8/8/4pP2/8/8/8/8 w - e6 0 0",
+      "r6r/1b2k1bq/8/8/7B/8/8/R3K2R b KQ - 0 0",
+      "8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 0",
+      "r1bqkbnr/pppppppp/n7/8/8/P7/1PPPPPPP/RNBQKBNR w KQkq - 0 0",
+      "r3k2r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQkq - 0 0",
+      "2kr3r/p1ppqpb1/bn2Qnp1/3PN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQ - 0 0",
+      "rnb2k1r/pp1Pbppp/2p5/q7/2B5/8/PPPQNnPP/RNB1K2R w KQ - 0 0",
+      "2r5/3pk3/8/2P5/8/2K5/8/8 w - - 5 4",
+      "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 0 0",
+      "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/"
+      "R4RK1 w - - 0 10",
+      "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1",
+      "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1",
+      "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+      "5k2/8/8/8/8/8/8/4K2R w K - 0 1",
+      "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1",
+      "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1",
+      "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1",
+      "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1",
+      "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1",
+      "4k3/1P6/8/8/8/8/K7/8 w - - 0 1",
+      "8/P1k5/K7/8/8/8/8/8 w - - 0 1",
+      "K1k5/8/P7/8/8/8/8/8 w - - 0 1",
+      "8/k1P5/8/1K6/8/8/8/8 w - - 0 1",
+      "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1",
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 65535 300",
+  };
+  for (const char* fen : fens) {
+    REQUIRE(BitBoard(fen).fen() == fen);
+  }
+}
+
+TEST_CASE("BitBoard fen parser", "[bitboard][fen]")
+{
+  SECTION("Startpos")
+  {
+    BitBoard board;
+    REQUIRE(boardFromFen("startpos", board) == FenStatus::kFenOk);
+    REQUIRE(board == bitboard::kStartBitBoard);
+    REQUIRE(board.fen() == bitboard::kStartPosition);
+    REQUIRE(boardFromFen("startposition", board) != FenStatus::kFenOk);
+
+    std::size_t index = 0;
+    REQUIRE(boardFromFen("  startpos moves", board, index)
+            == FenStatus::kFenOk);
+    REQUIRE(index == 10);
+    index = 100;
+    REQUIRE(boardFromFen("startpos", board, index)
+            == FenStatus::kFenIncomplete);
+  }
+
+  SECTION("Fields")
+  {
+    BitBoard board;
+    REQUIRE(boardFromFen("4k3/8/8/3pP3/8/8/8/4K3 w Kq d6 7 42", board)
+            == FenStatus::kFenOk);
+    REQUIRE(board.side() == bitboard::Color::kWhite);
+    REQUIRE(board.get("e1"_p) == Figure::kWKing);
+    REQUIRE(board.get("d5"_p) == Figure::kBPawn);
+    REQUIRE(board.turn() == bitboard::Turn("d7"_p, "d5"_p));
+    REQUIRE(board.halfmoveClock() == 7);
+    REQUIRE(board.fullmoveNumber() == 42);
+    REQUIRE(static_cast<int>(board.flags())
+            == (static_cast<int>(BitBoard::Flags::kFlagsElPassant)
+                | static_cast<int>(BitBoard::Flags::kFlagsWhiteOo)
+                | static_cast<int>(BitBoard::Flags::kFlagsBlackOoo)));
+  }
+
+  SECTION("EPD without counters")
+  {
+    constexpr std::string_view epd =
+        "4k3/8/8/8/8/8/8/4K3 b - - bm Kd7; id \"test\";";
+    BitBoard board;
+    std::size_t index = 0;
+    REQUIRE(boardFromFen(epd, board, index) == FenStatus::kFenOk);
+    REQUIRE(board.side() == bitboard::Color::kBlack);
+    REQUIRE(board.halfmoveClock() == 0);
+    REQUIRE(board.fullmoveNumber() == 1);
+    REQUIRE(epd.substr(index).starts_with(" bm"));
+  }
+
+  SECTION("Errors leave the board unchanged")
+  {
+    BitBoard board = bitboard::kStartBitBoard;
+    REQUIRE(boardFromFen("4k3/8/8/8/8/8/8/4K3x w - - 0 1", board)
+            == FenStatus::kFenInvalidCharacter);
+    REQUIRE(boardFromFen("4k3/8/8/8/8/8/8/4K4 w - - 0 1", board)
+            == FenStatus::kFenInvalidBoard);
+    REQUIRE(boardFromFen("4k3/8/8/8/8/8/8 w - - 0 1", board)
+            == FenStatus::kFenInvalidBoard);
+    REQUIRE(boardFromFen("4k3/8/8/8/8/8/8/4K3/8 w - - 0 1", board)
+            == FenStatus::kFenInvalidBoard);
+    REQUIRE(boardFromFen("4k3/8/8/8/8/8/8/4K3 w -", board)
+            == FenStatus::kFenIncomplete);
+    REQUIRE(boardFromFen("4k3/8/8/8/8/8/8/4K3 x - - 0 1", board)
+            == FenStatus::kFenInvalidSide);
+    REQUIRE(boardFromFen("4k3/8/8/8/8/8/8/4K3 w KX - 0 1", board)
+            == FenStatus::kFenInvalidCastling);
+    REQUIRE(boardFromFen("4k3/8/8/8/8/8/8/4K3 w - e3 0 1", board)
+            == FenStatus::kFenInvalidElPassant);
+    REQUIRE(boardFromFen("4k3/8/8/8/8/8/8/4K3 w - - 0x 1", board)
+            == FenStatus::kFenInvalidCounter);
+    REQUIRE(boardFromFen("4k3/8/8/8/8/8/8/4K3 w - - 0 70000", board)
+            == FenStatus::kFenInvalidCounter);
+    REQUIRE(board == bitboard::kStartBitBoard);
+    REQUIRE(BitBoard("garbage") == BitBoard());
+  }
+}
+
+
+namespace
+{
+
+// Counts the leaves of the legal game tree; in pseudo-legal mode the turns
+// are filtered with isLegalAfterPseudo.
+std::size_t perft(const BitBoard& board, std::size_t depth, bool pseudo = false)
+{
+  Turn turns[bitboard::kChessMaxTurns];
+  const std::size_t count =
+      pseudo ? board.getPseudoTurns(turns) : board.getTurns(turns);
+  std::size_t nodes = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (pseudo && !board.isLegalAfterPseudo(turns[i])) {
+      continue;
+    }
+    if (depth == 1) {
+      nodes++;
+      continue;
+    }
+    BitBoard next(board);
+    next.executeTurn(turns[i]);
+    nodes += perft(next, depth - 1, pseudo);
+  }
+  return nodes;
+}
+
+}  // namespace
+
+TEST_CASE("BitBoard generation tests", "[bitboard][generation]")
+{
+  const BitBoard& start = bitboard::kStartBitBoard;
+  REQUIRE(perft(start, 1) == 20);
+  REQUIRE(perft(start, 2) == 400);
+  REQUIRE(perft(start, 3) == 8902);
+  REQUIRE(perft(start, 4) == 197281);
+  REQUIRE(perft(start, 4, true) == 197281);
+
+  REQUIRE(BitBoard {"Q3k3/Q7/8/8/8/8/8/3K4 b - - 1 1"}.isCheckmate());
+  REQUIRE_FALSE(BitBoard {"4k3/Q7/8/8/8/8/8/3K3Q b - - 1 1"}.isCheckmate());
+
+  SECTION("Generated turns are classified and legal")
+  {
+    const BitBoard board(
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    Turn turns[bitboard::kChessMaxTurns];
+    const std::size_t count = board.getTurns(turns);
+    REQUIRE(count == 48);
+    for (std::size_t i = 0; i < count; ++i) {
+      REQUIRE(turns[i].kind() != bitboard::TurnKind::kUnknown);
+      REQUIRE(board.isLegal(turns[i]));
+      REQUIRE(board.classify(Turn(turns[i].toString())).kind()
+              == turns[i].kind());
+    }
+  }
+
+  SECTION("Pseudo-legal turns")
+  {
+    // the pinned knight and the king stepping into the rook are generated
+    const BitBoard board("4r1k1/8/8/8/8/8/4N3/4K3 w - - 0 1");
+    Turn turns[bitboard::kChessMaxTurns];
+    const std::size_t count = board.getPseudoTurns(turns);
+    REQUIRE(count == 10);
+    std::size_t legal = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      REQUIRE(board.isLegalAfterPseudo(turns[i]) == board.isLegal(turns[i]));
+      legal += board.isLegalAfterPseudo(turns[i]) ? std::size_t {1} : 0;
+    }
+    REQUIRE(legal == board.getTurns(turns));
+    REQUIRE(legal == 4);
+  }
+
+  SECTION("Pinned pawns and promotions")
+  {
+    // the e-pawn may only push along the file, the d-pawn only capture the
+    // pinning bishop
+    const BitBoard board("4k2n/4r1P1/8/8/8/2b5/3PP3/4K3 w - - 0 1");
+    Turn turns[bitboard::kChessMaxTurns];
+    const std::size_t count = board.getTurns(turns);
+    REQUIRE(count == 14);
+    std::size_t promotions = 0;
+    std::size_t captures = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      REQUIRE(board.isLegal(turns[i]));
+      promotions += turns[i].promotion() ? std::size_t {1} : 0;
+      captures += turns[i].capture() ? std::size_t {1} : 0;
+    }
+    REQUIRE(promotions == 8);
+    REQUIRE(captures == 5);
+    REQUIRE(board.getPseudoTurns(turns) == 16);
+  }
+}
+
+TEST_CASE("BitBoard terminal positions", "[bitboard][generation]")
+{
+  const auto hasTurns = [](const BitBoard& board)
+  {
+    Turn turns[bitboard::kChessMaxTurns];
+    return board.getTurns(turns) != 0;
+  };
+  const char* const fens[] = {
+      bitboard::kStartPosition,
+      "Q3k3/Q7/8/8/8/8/8/3K4 b - - 1 1",
+      "4k3/Q7/8/8/8/8/8/3K3Q b - - 1 1",
+      // stalemates beside a blocked pawn and a pinned bishop
+      "k7/p7/P7/8/8/8/8/1Q1K4 b - - 0 1",
+      "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1",
+      "k7/b1K5/8/8/8/8/8/R7 b - - 0 1",
+      // double checks, only the king may move
+      "4k3/8/8/8/8/3n4/8/R3K2r w - - 0 1",
+      "4k3/8/5N2/8/8/8/8/4RK2 b - - 0 1",
+      // a check by a double push, answered by el passant
+      "8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1",
+  };
+  for (const char* fen : fens) {
+    const BitBoard board(fen);
+    const bool has_turns = hasTurns(board);
+    REQUIRE(board.hasLegalMove() == has_turns);
+    const bool check = board.kingAttacked(board.side());
+    REQUIRE(board.isCheckmate() == (!has_turns && check));
+    REQUIRE(board.isStalemate() == (!has_turns && !check));
+  }
+
+  REQUIRE(BitBoard("k7/p7/P7/8/8/8/8/1Q1K4 b - - 0 1").isStalemate());
+  REQUIRE(BitBoard("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1").isStalemate());
+  REQUIRE(BitBoard("k7/b1K5/8/8/8/8/8/R7 b - - 0 1").isStalemate());
+  REQUIRE(BitBoard("4k3/8/5N2/8/8/8/8/4RK2 b - - 0 1").checkers()
+          == ("e1"_bm | "f6"_bm));
+  REQUIRE(bitboard::kStartBitBoard.checkers() == 0);
+}
+
+TEST_CASE("BitBoard terminal benchmark", "[.][benchmark][generation]")
+{
+  const BitBoard board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  const BitBoard mate("Q3k3/Q7/8/8/8/8/8/3K4 b - - 1 1");
+  Turn turns[bitboard::kChessMaxTurns];
+
+  BENCHMARK("getTurns")
+  {
+    return board.getTurns(turns);
+  };
+  BENCHMARK("hasLegalMove")
+  {
+    return board.hasLegalMove();
+  };
+  BENCHMARK("isCheckmate, mate")
+  {
+    return mate.isCheckmate();
+  };
+}
+
+TEST_CASE("BitBoard givesCheck", "[bitboard][generation]")
+{
+  const auto check = [](std::string_view fen, std::string_view turn)
+  { return BitBoard(fen).givesCheck(Turn(turn)); };
+
+  SECTION("Direct and discovered checks")
+  {
+    REQUIRE(check("4k3/8/8/8/8/8/8/R3K3 w - - 0 1", "a1a8"));
+    REQUIRE_FALSE(check("4k3/8/8/8/8/8/8/R3K3 w - - 0 1", "a1a7"));
+    REQUIRE(check("4k3/8/8/8/8/8/8/4K1N1 w - - 0 1", "g1f3") == false);
+    REQUIRE(check("4k3/8/8/8/6N1/8/8/4K3 w - - 0 1", "g4f6"));
+    REQUIRE(check("4k3/8/8/3P4/8/8/8/4K3 w - - 0 1", "d5d6") == false);
+    REQUIRE(check("4k3/8/3P4/8/8/8/8/4K3 w - - 0 1", "d6d7"));
+    // the bishop leaves the file of the rook, the pawn stays on it
+    REQUIRE(check("4k3/8/8/8/4B3/8/8/4R1K1 w - - 0 1", "e4c6"));
+    REQUIRE_FALSE(check("4k3/8/8/8/4P3/8/8/4R1K1 w - - 0 1", "e4e5"));
+    REQUIRE(check("4k3/8/8/8/8/8/4R3/4Q1K1 w - - 0 1", "e2a2"));
+    // a king move discovers the check
+    REQUIRE(check("7k/8/8/8/3K4/8/8/B7 w - - 0 1", "d4d3"));
+    REQUIRE_FALSE(check("7k/8/8/8/3K4/8/8/B7 w - - 0 1", "d4e5"));
+    // the figure between belongs to the enemy
+    REQUIRE_FALSE(check("4k3/8/8/4p3/8/8/4B3/4R1K1 w - - 0 1", "e2d3"));
+  }
+
+  SECTION("Promotions, el passant and castling")
+  {
+    REQUIRE(check("8/1P6/8/8/8/8/7k/4K3 w - - 0 1", "b7b8q"));
+    REQUIRE_FALSE(check("8/1P6/8/8/8/8/7k/4K3 w - - 0 1", "b7b8n"));
+    REQUIRE(check("8/1P2k3/8/8/8/8/8/4K3 w - - 0 1", "b7b8r") == false);
+    REQUIRE(check("2k5/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8n") == false);
+    REQUIRE(check("3k4/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8r"));
+    // the queen on a8 sees through the square the pawn left
+    REQUIRE(check("n7/1P6/8/8/4k3/8/8/4K3 w - - 0 1", "b7a8q"));
+    REQUIRE(check("8/8/8/2k5/3pP3/8/8/4K3 b - e3 0 1", "d4e3") == false);
+    REQUIRE(check("8/8/2k5/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6") == false);
+    REQUIRE(check("8/8/8/3pP3/8/2k5/8/4K3 w - d6 0 1", "e5d6") == false);
+    REQUIRE(check("7k/8/8/3pP3/8/8/8/B3K3 w - d6 0 1", "e5d6"));
+    REQUIRE(check("8/8/8/1k1pP2R/8/8/8/4K3 w - d6 0 1", "e5d6"));
+    REQUIRE(check("5k2/8/8/8/8/8/8/4K2R w K - 0 1", "e1g1"));
+    REQUIRE_FALSE(check("4k3/8/8/8/8/8/8/4K2R w K - 0 1", "e1g1"));
+    REQUIRE(check("3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", "e1c1"));
+  }
+
+  SECTION("Agrees with making the turn")
+  {
+    const char* const fens[] = {
+        bitboard::kStartPosition,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    };
+    for (const char* fen : fens) {
+      // two plies deep, so the el passant and castling turns come up
+      const BitBoard root(fen);
+      Turn turns[bitboard::kChessMaxTurns];
+      const std::size_t count = root.getTurns(turns);
+      for (std::size_t i = 0; i < count; ++i) {
+        BitBoard board(root);
+        board.executeTurn(turns[i]);
+        const auto info = board.checkInfo();
+        Turn replies[bitboard::kChessMaxTurns];
+        const std::size_t replies_count = board.getTurns(replies);
+        for (std::size_t j = 0; j < replies_count; ++j) {
+          BitBoard next(board);
+          next.executeTurn(replies[j]);
+          REQUIRE(board.givesCheck(replies[j], info)
+                  == next.kingAttacked(next.side()));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("BitBoard givesCheck benchmark", "[.][benchmark][generation]")
+{
+  const BitBoard board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  Turn turns[bitboard::kChessMaxTurns];
+  const std::size_t count = board.getTurns(turns);
+
+  BENCHMARK("givesCheck, 48 turns")
+  {
+    const auto info = board.checkInfo();
+    int checks = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      checks += board.givesCheck(turns[i], info) ? 1 : 0;
+    }
+    return checks;
+  };
+  BENCHMARK("make and test, 48 turns")
+  {
+    int checks = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      BitBoard next(board);
+      next.executeTurn(turns[i]);
+      checks += next.kingAttacked(next.side()) ? 1 : 0;
+    }
+    return checks;
+  };
+}
+
+TEST_CASE("BitBoard static exchange evaluation", "[bitboard][see]")
+{
+  const auto see = [](std::string_view fen, std::string_view turn)
+  { return BitBoard(fen).see(Turn(turn)); };
+
+  REQUIRE(see("4k3/8/8/3p4/4P3/8/8/4K3 w - - 0 1", "e4d5") == 100);
+  REQUIRE(see("4k3/8/2p5/3p4/4P3/8/8/4K3 w - - 0 1", "e4d5") == 0);
+  REQUIRE(see("4k3/8/2p5/3p4/8/8/8/3QK3 w - - 0 1", "d1d5") == -800);
+  REQUIRE(see("4k3/8/8/8/8/8/8/3QK3 w - - 0 1", "d1d5") == 0);
+  // the queen behind the rook joins through the x-ray
+  REQUIRE(see("4k3/8/2p5/3p4/8/8/3R4/3QK3 w - - 0 1", "d2d5") == -300);
+  REQUIRE(see("3rk3/3r4/8/3p4/8/8/3R4/3QK3 w - - 0 1", "d2d5") == -400);
+  REQUIRE(see("3rk3/3r4/8/3p4/8/8/3R4/3RK3 w - - 0 1", "d2d5") == -400);
+  REQUIRE(see("3rk3/3r4/8/3p4/8/3R4/3R4/3RK3 w - - 0 1", "d3d5") == 100);
+  // the king takes back only an undefended figure
+  REQUIRE(see("8/8/8/3pk3/8/8/8/3RK3 w - - 0 1", "d1d5") == -400);
+  REQUIRE(see("3Q4/8/8/3pk3/8/8/8/3RK3 w - - 0 1", "d1d5") == 100);
+  // the attacker may stop instead of losing more
+  REQUIRE(see("4k3/8/2p5/3n4/8/8/3R4/3QK3 w - - 0 1", "d2d5") == -80);
+  REQUIRE(see("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6") == 100);
+  REQUIRE(see("1n2k3/P7/8/8/8/8/8/4K3 w - - 0 1", "a7b8q") == 1120);
+  REQUIRE(see("1n2k3/P1b5/8/8/8/8/8/4K3 w - - 0 1", "a7b8q") == 220);
+  REQUIRE(see("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1g1") == 0);
+
+  SECTION("seeGE agrees with see")
+  {
+    const char* const fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1",
+        "8/8/8/3pk3/8/8/8/3RK3 w - - 0 1",
+    };
+    for (const char* fen : fens) {
+      const BitBoard board(fen);
+      Turn turns[bitboard::kChessMaxTurns];
+      const std::size_t count = board.getTurns(turns);
+      for (std::size_t i = 0; i < count; ++i) {
+        const int value = board.see(turns[i]);
+        for (const int threshold : {value - 1, value, value + 1, 0}) {
+          REQUIRE(board.seeGE(turns[i], threshold) == (value >= threshold));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("BitBoard static exchange benchmark", "[.][benchmark][see]")
+{
+  const BitBoard board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  Turn turns[bitboard::kChessMaxTurns];
+  const std::size_t count = board.getTurns(turns);
+  std::size_t captures = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (turns[i].capture()) {
+      turns[captures++] = turns[i];
+    }
+  }
+
+  BENCHMARK("see, " + std::to_string(captures) + " captures")
+  {
+    int sum = 0;
+    for (std::size_t i = 0; i < captures; ++i) {
+      sum += board.see(turns[i]);
+    }
+    return sum;
+  };
+  BENCHMARK("seeGE, " + std::to_string(captures) + " captures")
+  {
+    int good = 0;
+    for (std::size_t i = 0; i < captures; ++i) {
+      good += board.seeGE(turns[i], 0) ? 1 : 0;
+    }
+    return good;
+  };
+}
+
+TEST_CASE("BitBoard generation advanced tests", "[bitboard][generation]")
+{
+  REQUIRE(perft(BitBoard("rnbqkbnr/pppppp1p/8/8/5PpP/7R/PPPPP1P1/RNBQKBN1 b "
+                         "Qkq f3 0 1"),
+                5)
+          == 8581394);
+  REQUIRE(perft(BitBoard("rnbqkbnr/ppp2pp1/7p/3pP3/8/8/PPPKPPPP/RNBQ1BNR w "
+                         "kq d6 0 0"),
+                5)
+          == 21342522);
+  // test from issue #6
+  REQUIRE(perft(BitBoard("8/1p2N3/p4p1k/1r1p2p1/8/P7/6PP/4R1KR w - - 0 0"), 5)
+          == 2670607);
+  REQUIRE(perft(BitBoard("r6r/1b2k1bq/8/8/7B/8/8/R3K2R b KQ - 3 2"), 1) == 8);
+  REQUIRE(perft(BitBoard("8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 3"), 1) == 8);
+  REQUIRE(perft(BitBoard("r1bqkbnr/pppppppp/n7/8/8/P7/1PPPPPPP/RNBQKBNR w "
+                         "KQkq - 2 2"),
+                1)
+          == 19);
+  REQUIRE(perft(BitBoard("r3k2r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/PPPBBPPP/"
+                         "R3K2R b KQkq - 3 2"),
+                1)
+          == 5);
+  REQUIRE(perft(BitBoard("2kr3r/p1ppqpb1/bn2Qnp1/3PN3/1p2P3/2N5/PPPBBPPP/"
+                         "R3K2R b KQ - 3 2"),
+                1)
+          == 44);
+  REQUIRE(perft(BitBoard("rnb2k1r/pp1Pbppp/2p5/q7/2B5/8/PPPQNnPP/RNB1K2R w "
+                         "KQ - 3 9"),
+                1)
+          == 39);
+  REQUIRE(perft(BitBoard("2r5/3pk3/8/2P5/8/2K5/8/8 w - - 5 4"), 1) == 9);
+  REQUIRE(perft(BitBoard("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w "
+                         "KQ - 1 8"),
+                3)
+          == 62379);
+  REQUIRE(perft(BitBoard("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/"
+                         "1PP1QPPP/R4RK1 w - - 0 10"),
+                3)
+          == 89890);
+  REQUIRE(perft(BitBoard("3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1"), 6) == 1134888);
+  REQUIRE(perft(BitBoard("8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1"), 6)
+          == 1015133);
+  REQUIRE(perft(BitBoard("8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1"), 6)
+          == 1440467);
+  REQUIRE(perft(BitBoard("5k2/8/8/8/8/8/8/4K2R w K - 0 1"), 6) == 661072);
+  REQUIRE(perft(BitBoard("3k4/8/8/8/8/8/8/R3K3 w Q - 0 1"), 6) == 803711);
+  REQUIRE(perft(BitBoard("r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1"), 4)
+          == 1274206);
+  REQUIRE(perft(BitBoard("r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1"), 4)
+          == 1720476);
+  REQUIRE(perft(BitBoard("2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1"), 6) == 3821001);
+  REQUIRE(perft(BitBoard("8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1"), 5)
+          == 1004658);
+  REQUIRE(perft(BitBoard("4k3/1P6/8/8/8/8/K7/8 w - - 0 1"), 6) == 217342);
+  REQUIRE(perft(BitBoard("8/P1k5/K7/8/8/8/8/8 w - - 0 1"), 6) == 92683);
+  REQUIRE(perft(BitBoard("K1k5/8/P7/8/8/8/8/8 w - - 0 1"), 6) == 2217);
+  REQUIRE(perft(BitBoard("8/k1P5/8/1K6/8/8/8/8 w - - 0 1"), 7) == 567584);
+  REQUIRE(perft(BitBoard("8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1"), 4) == 23527);
+}
+
+TEST_CASE("BitBoard turn targets", "[bitboard][generation]")
+{
+  const auto check = [](const BitBoard& board, Turn /*turn*/)
+  {
+    Turn turns[bitboard::kChessMaxTurns];
+    const std::size_t count = board.getTurns(turns);
+    const bitboard::TurnTargets targets = board.getTargets();
+    INFO(board.fen());
+
+    bitboard::TurnTargets expected;
+    for (std::size_t i = 0; i < count; ++i) {
+      const uint8_t from = turns[i].from().index();
+      expected.targets[from] |= bitboard::positionToMask(turns[i].to());
+      if (turns[i].promotion()) {
+        expected.promotions |= bitboard::positionToMask(turns[i].from());
+      }
+    }
+    for (std::size_t from = 0; from < 64; ++from) {
+      REQUIRE(targets.targets[from] == expected.targets[from]);
+    }
+    REQUIRE(targets.promotions == expected.promotions);
+    REQUIRE(targets.count() == count);
+  };
+
+  std::vector<const char*> fens(std::begin(test::kPlayoutFens),
+                                std::end(test::kPlayoutFens));
+  fens.insert(fens.end(),
+              {"8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+               "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1",
+               // a blocked pawn on the seventh rank doesn't promote
+               "3r4/3P4/8/8/8/8/8/k3K3 w - - 0 1"});
+  for (const char* fen : fens) {
+    for (std::size_t seed = 0; seed < 6; ++seed) {
+      test::playout(fen, seed, 40, check);
+    }
+  }
+}
+
+TEST_CASE("BitBoard turn targets benchmark", "[.][benchmark][generation]")
+{
+  const BitBoard board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+  BENCHMARK("getTurns")
+  {
+    Turn turns[bitboard::kChessMaxTurns];
+    return board.getTurns(turns);
+  };
+
+  BENCHMARK("getTargets")
+  {
+    return board.getTargets().targets[bitboard::Position("e1").index()];
+  };
+
+  BENCHMARK("getTargets and count")
+  {
+    return board.getTargets().count();
+  };
+}
+
+TEST_CASE("BitBoard perft benchmark", "[.][benchmark][generation]")
+{
+  // the standard perft positions, depths chosen for a few million nodes
+  const std::pair<const char*, std::size_t> positions[] = {
+      {bitboard::kStartPosition, 5},
+      {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+       4},
+      {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5},
+      {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4},
+      {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4},
+      {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 "
+       "10",
+       4},
+  };
+  const std::size_t expected[] = {
+      4865609, 4085603, 674624, 422333, 2103487, 3894594};
+
+  for (std::size_t i = 0; i < std::size(positions); ++i) {
+    const BitBoard board(positions[i].first);
+    const std::size_t depth = positions[i].second;
+    REQUIRE(perft(board, depth) == expected[i]);
+    REQUIRE(perft(board, depth, true) == expected[i]);
+
+    BENCHMARK("legal, position " + std::to_string(i + 1))
+    {
+      return perft(board, depth);
+    };
+    BENCHMARK("pseudo-legal, position " + std::to_string(i + 1))
+    {
+      return perft(board, depth, true);
+    };
+  }
+}
@@ -0,0 +1,204 @@
+#include <bit>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include <bitboard/bitboard.hpp>
+#include <bitboard/utils/bit_utils.hpp>
+#include <bitboard/utils/cpu.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "kernels.hpp"
+#include "magic.hpp"
+#include "playout.hpp"
+
+using bitboard::BitBoard;
+using bitboard::bitboard_field;
+using bitboard::Color;
+using bitboard::CpuLevel;
+using bitboard::Figure;
+using bitboard::Kernels;
+using bitboard::Position;
+using bitboard::Turn;
+using bitboard::operator"" _bm;
+
+TEST_CASE("CPU dispatch", "[cpu]")
+{
+  const CpuLevel level = bitboard::cpuLevel();
+  REQUIRE(level == bitboard::cpuLevel());
+  REQUIRE(level <= CpuLevel::kCpuV4);
+  REQUIRE(std::string_view(bitboard::cpuLevelName(level))
+              .starts_with("x86-64"));
+  REQUIRE(std::string_view(bitboard::cpuLevelName(CpuLevel::kCpuV3))
+          == "x86-64-v3");
+
+  // the slider kernel of the active level
+  const BitBoard board("4k3/8/8/3q4/8/8/8/R3K3 w - - 0 1");
+  REQUIRE((board.attacks(bitboard::Color::kBlack) & "a8"_bm) != 0);
+  REQUIRE((board.attacks(bitboard::Color::kBlack) & "d1"_bm) != 0);
+  REQUIRE((board.attacks(bitboard::Color::kWhite) & "a8"_bm) != 0);
+  REQUIRE((board.attacks(bitboard::Color::kWhite) & "h1"_bm) == 0);
+}
+
+TEST_CASE("CPU dispatch kernels", "[cpu]")
+{
+  // every level the host runs, not only the selected one
+  std::vector<const Kernels*> levels;
+  for (const CpuLevel level : {CpuLevel::kCpuBaseline,
+                               CpuLevel::kCpuV2,
+                               CpuLevel::kCpuV3,
+                               CpuLevel::kCpuV4})
+  {
+    const Kernels* kernels = bitboard::kernels(level);
+    if (kernels != nullptr) {
+      REQUIRE(kernels->level == level);
+      levels.push_back(kernels);
+    }
+  }
+  REQUIRE(!levels.empty());
+  REQUIRE(levels.front()->level == CpuLevel::kCpuBaseline);
+  REQUIRE(levels.back()->level >= bitboard::cpuLevel());
+
+  SECTION("Slider attacks match the per-square attacks")
+  {
+    std::mt19937_64 random(42);
+    for (std::size_t i = 0; i < 200000; ++i) {
+      // sparse sets, as on boards
+      const bitboard_field rooks = random() & random() & random();
+      const bitboard_field bishops = random() & random() & random();
+      const bitboard_field occupancy =
+          (random() & random()) | rooks | bishops;
+
+      bitboard_field expected = 0;
+      for (uint8_t square = 0; square < 64; ++square) {
+        const bitboard_field mask = bitboard_field {1} << square;
+        if ((rooks & mask) != 0) {
+          expected |= bitboard::processRook(Position(square), occupancy);
+        }
+        if ((bishops & mask) != 0) {
+          expected |= bitboard::processBishop(Position(square), occupancy);
+        }
+      }
+      for (const Kernels* kernels : levels) {
+        const bitboard_field attacks =
+            kernels->slider_attacks(rooks, bishops, occupancy);
+        if (attacks != expected) {
+          INFO(bitboard::cpuLevelName(kernels->level)
+               << " " << rooks << " " << bishops << " " << occupancy);
+          REQUIRE(attacks == expected);
+        }
+      }
+    }
+  }
+
+  SECTION("Batch kernels match the boards")
+  {
+    std::vector<BitBoard> boards;
+    for (const char* fen : test::kPlayoutFens) {
+      for (std::size_t seed = 0; seed < 3; ++seed) {
+        test::playout(fen,
+                      seed,
+                      30,
+                      [&boards](const BitBoard& board, Turn /*turn*/)
+                      { boards.push_back(board); });
+      }
+    }
+    boards.pop_back();
+    REQUIRE(boards.size() % bitboard::kBatchLanes != 0);
+
+    // the layout BitBoardBatch::add() writes
+    constexpr std::size_t kLanes = bitboard::kBatchLanes;
+    std::vector<bitboard_field> blocks(
+        ((boards.size() + kLanes - 1) / kLanes) * bitboard::kBatchPlanes
+        * kLanes);
+    for (std::size_t i = 0; i < boards.size(); ++i) {
+      bitboard_field* block =
+          blocks.data() + ((i / kLanes) * bitboard::kBatchPlanes * kLanes);
+      const std::size_t lane = i % kLanes;
+      for (std::size_t figure = 0; figure < 6; ++figure) {
+        const auto white = static_cast<Figure>(figure + 1);
+        const auto black = static_cast<Figure>(-static_cast<int>(figure + 1));
+        block[((bitboard::kBatchWhitePawn + figure) * kLanes) + lane] =
+            boards[i].pieces(white);
+        block[((bitboard::kBatchBlackPawn + figure) * kLanes) + lane] =
+            boards[i].pieces(black);
+      }
+      block[(bitboard::kBatchFlags * kLanes) + lane] =
+          static_cast<uint8_t>(boards[i].flags());
+      const Position el_passant = boards[i].elPassant();
+      block[(bitboard::kBatchElPassant * kLanes) + lane] =
+          el_passant.valid() ? bitboard::positionToMask(el_passant) : 0;
+    }
+
+    for (const Kernels* kernels : levels) {
+      INFO(bitboard::cpuLevelName(kernels->level));
+      std::vector<bitboard_field> white(boards.size());
+      std::vector<bitboard_field> black(boards.size());
+      std::vector<bitboard_field> checkers(boards.size());
+      std::vector<uint8_t> counts(boards.size());
+      const std::size_t size = boards.size();
+      kernels->batch_attacks(blocks.data(), size, true, white.data());
+      kernels->batch_attacks(blocks.data(), size, false, black.data());
+      kernels->batch_checkers(blocks.data(), size, checkers.data());
+      kernels->batch_legal_counts(blocks.data(), size, counts.data());
+
+      for (std::size_t i = 0; i < boards.size(); ++i) {
+        INFO(boards[i].fen());
+        Turn turns[bitboard::kChessMaxTurns];
+        REQUIRE(white[i] == boards[i].attacks(Color::kWhite));
+        REQUIRE(black[i] == boards[i].attacks(Color::kBlack));
+        REQUIRE(checkers[i] == boards[i].checkers());
+        REQUIRE(counts[i] == boards[i].getTurns(turns));
+      }
+    }
+  }
+
+  SECTION("Expand kernels match the bits")
+  {
+    std::mt19937_64 random(7);
+    std::vector<bitboard_field> planes(37);
+    for (auto& plane : planes) {
+      plane = random();
+    }
+    planes.front() = 0;
+    planes.back() = ~bitboard_field {0};
+
+    for (const Kernels* kernels : levels) {
+      INFO(bitboard::cpuLevelName(kernels->level));
+      std::vector<uint8_t> bytes(planes.size() * 64, 0xFF);
+      std::vector<float> floats(planes.size() * 64, -1.0F);
+      kernels->expand_bytes(planes.data(), planes.size(), bytes.data());
+      kernels->expand_floats(planes.data(), planes.size(), floats.data());
+      for (std::size_t i = 0; i < bytes.size(); ++i) {
+        const auto bit =
+            static_cast<uint8_t>((planes[i / 64] >> (i % 64)) & 1U);
+        REQUIRE(bytes[i] == bit);
+        // compared as bits, 0.0F and 1.0F are exact
+        REQUIRE(std::bit_cast<uint32_t>(floats[i])
+                == std::bit_cast<uint32_t>(static_cast<float>(bit)));
+      }
+    }
+  }
+}
+
+TEST_CASE("CPU dispatch benchmark", "[.][benchmark][cpu]")
+{
+  // compare the levels with BITBOARD_CPU_LEVEL, the queens make the slider
+  // part of the attack maps dominate
+  const BitBoard board("1q2k2q/8/3qq3/8/8/3QQ3/8/1Q2K2Q w - - 0 1");
+  Turn turns[bitboard::kChessMaxTurns];
+  const std::size_t count = board.getTurns(turns);
+
+  BENCHMARK("attack maps after every turn")
+  {
+    bitboard::bitboard_field result = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      BitBoard next(board);
+      next.executeTurn(turns[i]);
+      result ^= next.attacks(bitboard::Color::kWhite)
+          ^ next.attacks(bitboard::Color::kBlack);
+    }
+    return result;
+  };
+}
@@ -0,0 +1,108 @@
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <bitboard/utils/epd_reader.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using bitboard::BitBoard;
+using bitboard::EpdReader;
+
+namespace
+{
+
+std::string generateEpd(std::vector<std::string>& fens)
+{
+  const char* const samples[] = {
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      "r3k2r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQkq - 0 0",
+      "8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 0",
+      "2r5/3pk3/8/2P5/8/2K5/8/8 w - - 5 4",
+  };
+  std::string text;
+  for (std::size_t i = 0; i < 1000; i++) {
+    const std::string fen = samples[i % 4];
+    fens.push_back(fen);
+    text += fen;
+    // EPD operations, blank lines and CRLF endings are all tolerated
+    if (i % 3 == 0) {
+      text += " bm e4;";
+    }
+    text += (i % 5 == 0) ? "\r\n" : "\n";
+    if (i % 7 == 0) {
+      text += "\n";
+    }
+  }
+  return text;
+}
+
+}  // namespace
+
+TEST_CASE("EpdReader ordered read", "[epd]")
+{
+  std::vector<std::string> fens;
+  const auto text = generateEpd(fens);
+
+  for (const unsigned threads : {1U, 2U, 4U}) {
+    EpdReader reader(text);
+    REQUIRE(reader.valid());
+
+    std::vector<std::string> result;
+    std::size_t last_chunk = 0;
+    bool in_order = true;
+    const auto count = reader.read(
+        [&](std::span<const BitBoard> boards, std::size_t chunk)
+        {
+          in_order = in_order && chunk >= last_chunk;
+          last_chunk = chunk;
+          for (const auto& board : boards) {
+            result.push_back(board.fen());
+          }
+        },
+        threads,
+        true,
+        777);
+
+    REQUIRE(in_order);
+    REQUIRE(count == fens.size());
+    REQUIRE(result == fens);
+  }
+}
+
+TEST_CASE("EpdReader unordered read from file", "[epd]")
+{
+  std::vector<std::string> fens;
+  const auto text = generateEpd(fens);
+
+  const char* const path = "epd_reader_test.epd";
+  {
+    std::FILE* file = std::fopen(path, "wb");
+    REQUIRE(file != nullptr);
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+  }
+
+  {
+    EpdReader reader(path);
+    REQUIRE(reader.valid());
+    REQUIRE(reader.data() == text);
+
+    std::mutex mutex;
+    std::size_t seen = 0;
+    const auto count = reader.read(
+        [&](std::span<const BitBoard> boards, std::size_t)
+        {
+          const std::lock_guard<std::mutex> lock(mutex);
+          seen += boards.size();
+        },
+        4,
+        false,
+        4096);
+    REQUIRE(count == fens.size());
+    REQUIRE(seen == fens.size());
+  }
+  std::remove(path);
+
+  REQUIRE_FALSE(EpdReader("no_such_file.epd").valid());
+}
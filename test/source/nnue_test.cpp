@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <vector>
+
+#include <bitboard/bitboard.hpp>
+#include <bitboard/utils/nnue.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "playout.hpp"
+
+using bitboard::BitBoard;
+using bitboard::Color;
+using bitboard::Figure;
+using bitboard::NnueDelta;
+using bitboard::NnueFeatureSet;
+using bitboard::Turn;
+using bitboard::operator"" _p;
+
+namespace
+{
+
+std::vector<uint32_t> features(const BitBoard& board,
+                               Color perspective,
+                               NnueFeatureSet set)
+{
+  uint32_t buffer[bitboard::kNnueMaxActive];
+  const std::size_t count =
+      bitboard::nnueFeatures(board, perspective, set, buffer);
+  std::vector<uint32_t> result(buffer, buffer + count);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("NNUE features", "[nnue]")
+{
+  SECTION("Indices")
+  {
+    // white king e1 = 4, own pawn e2 = 12; black sees the board rotated
+    REQUIRE(bitboard::nnueFeature(NnueFeatureSet::kHalfKP,
+                                  Color::kWhite,
+                                  "e1"_p,
+                                  Figure::kWPawn,
+                                  "e2"_p)
+            == (4 * 641) + 1 + 12);
+    REQUIRE(bitboard::nnueFeature(NnueFeatureSet::kHalfKP,
+                                  Color::kBlack,
+                                  "e8"_p,
+                                  Figure::kBPawn,
+                                  "e7"_p)
+            == (3 * 641) + 1 + 11);
+    REQUIRE(bitboard::nnueFeature(NnueFeatureSet::kHalfKA,
+                                  Color::kWhite,
+                                  "e1"_p,
+                                  Figure::kBKing,
+                                  "e8"_p)
+            == (4 * 768) + (11 * 64) + 60);
+  }
+
+  SECTION("Full refresh")
+  {
+    const BitBoard board(bitboard::kStartPosition);
+    REQUIRE(features(board, Color::kWhite, NnueFeatureSet::kHalfKP).size()
+            == 30);
+    REQUIRE(features(board, Color::kBlack, NnueFeatureSet::kHalfKA).size()
+            == 32);
+    REQUIRE(features(board, Color::kWhite, NnueFeatureSet::kHalfKA).back()
+            < bitboard::kHalfKADimensions);
+
+    uint32_t small[4];
+    REQUIRE(bitboard::nnueFeatures(
+                board, Color::kWhite, NnueFeatureSet::kHalfKP, small)
+            == 4);
+  }
+
+  SECTION("Deltas match the refresh")
+  {
+    for (const auto set : {NnueFeatureSet::kHalfKP, NnueFeatureSet::kHalfKA})
+    {
+      for (const char* fen : test::kPlayoutFens) {
+        for (std::size_t seed = 0; seed < 6; ++seed) {
+          test::playout(
+              fen,
+              seed,
+              50,
+              [set](const BitBoard& board, Turn turn)
+              {
+                if (!turn.valid()) {
+                  return;
+                }
+                const NnueDelta delta = bitboard::nnueDelta(board, turn, set);
+                BitBoard next(board);
+                next.executeTurn(turn);
+                INFO(board.fen() << " " << turn.toString());
+
+                for (std::size_t side = 0; side < 2; ++side) {
+                  const Color perspective =
+                      side == 0 ? Color::kWhite : Color::kBlack;
+                  if (delta.refresh[side]) {
+                    continue;
+                  }
+                  std::vector<uint32_t> expected =
+                      features(board, perspective, set);
+                  for (std::size_t i = 0; i < delta.removed_count[side]; ++i)
+                  {
+                    const auto found = std::find(expected.begin(),
+                                                 expected.end(),
+                                                 delta.removed[side][i]);
+                    REQUIRE(found != expected.end());
+                    expected.erase(found);
+                  }
+                  for (std::size_t i = 0; i < delta.added_count[side]; ++i) {
+                    expected.push_back(delta.added[side][i]);
+                  }
+                  std::sort(expected.begin(), expected.end());
+                  REQUIRE(expected == features(next, perspective, set));
+                }
+              });
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("NNUE features benchmark", "[.][benchmark][nnue]")
+{
+  const BitBoard board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  Turn turns[bitboard::kChessMaxTurns];
+  const std::size_t count = board.getTurns(turns);
+
+  BENCHMARK("deltas of every turn")
+  {
+    uint32_t result = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      result += bitboard::nnueDelta(board, turns[i], NnueFeatureSet::kHalfKP)
+                    .added_count[0];
+    }
+    return result;
+  };
+
+  BENCHMARK("refresh after every turn")
+  {
+    uint32_t buffer[bitboard::kNnueMaxActive];
+    std::size_t result = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      BitBoard next(board);
+      next.executeTurn(turns[i]);
+      result += bitboard::nnueFeatures(
+          next, Color::kWhite, NnueFeatureSet::kHalfKP, buffer);
+    }
+    return result;
+  };
+}
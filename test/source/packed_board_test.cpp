@@ -0,0 +1,140 @@
+#include <memory>
+#include <vector>
+
+#include <bitboard/bitboard.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using bitboard::BitBoard;
+using bitboard::Figure;
+using bitboard::PackedBoard;
+
+namespace
+{
+
+const char* const kFens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQkq - 0 0",
+    "8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 0",
+    "8/8/8/4pP2/8/8/8/8 w - e6 0 0",
+    "2r5/3pk3/8/2P5/8/2K5/8/8 w - - 5 4",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/"
+    "R4RK1 w - - 99 300",
+    "8/8/8/8/8/8/8/8 w - - 65535 65535",
+};
+
+}  // namespace
+
+TEST_CASE("PackedBoard fixed round trip", "[packed]")
+{
+  for (const char* fen : kFens) {
+    const BitBoard board(fen);
+    PackedBoard packed {};
+    REQUIRE(bitboard::packBoard(board, packed));
+
+    BitBoard result;
+    REQUIRE(bitboard::unpackBoard(packed, result));
+    REQUIRE(result == board);
+  }
+
+  SECTION("Byte layout")
+  {
+    PackedBoard packed {};
+    REQUIRE(bitboard::packBoard(BitBoard("4k3/8/8/8/8/8/8/4K3 b - - 1 2"),
+                                packed));
+    const PackedBoard expected {{0x10, 0, 0, 0, 0, 0, 0, 0x10, 0x5B, 0, 0,
+                                 0,    0, 0, 0, 0, 0, 0, 0,    0,    0, 0,
+                                 0,    0, 1, 64, 1, 0, 2, 0, 0, 0}};
+    REQUIRE(packed == expected);
+  }
+
+  SECTION("Too many figures")
+  {
+    BitBoard board;
+    for (uint8_t i = 0; i < 33; i++) {
+      board.set(bitboard::Position(i), Figure::kWPawn);
+    }
+    PackedBoard packed {};
+    REQUIRE_FALSE(bitboard::packBoard(board, packed));
+  }
+
+  SECTION("Corrupted data")
+  {
+    PackedBoard packed {};
+    REQUIRE(bitboard::packBoard(bitboard::kStartBitBoard, packed));
+    packed.data[8] = 0xFF;
+    BitBoard board;
+    REQUIRE_FALSE(bitboard::unpackBoard(packed, board));
+    REQUIRE(board == BitBoard());
+  }
+}
+
+TEST_CASE("PackedBoard variable round trip", "[packed]")
+{
+  std::vector<uint8_t> stream;
+  for (const char* fen : kFens) {
+    uint8_t buffer[bitboard::kPackedBoardMaxLength];
+    const auto size = bitboard::packBoard(BitBoard(fen), buffer);
+    REQUIRE(size <= bitboard::kPackedBoardMaxLength);
+    stream.insert(stream.end(), buffer, buffer + size);
+  }
+  REQUIRE(stream.size() < sizeof(PackedBoard) * std::size(kFens));
+
+  std::span<const uint8_t> data(stream);
+  for (const char* fen : kFens) {
+    BitBoard board;
+    const auto size = bitboard::unpackBoard(data, board);
+    REQUIRE(size != 0);
+    REQUIRE(board == BitBoard(fen));
+    data = data.subspan(size);
+  }
+  REQUIRE(data.empty());
+
+  BitBoard board;
+  REQUIRE(bitboard::unpackBoard(std::span<const uint8_t>(stream).first(9),
+                                board)
+          == 0);
+}
+
+TEST_CASE("PackedBoard batch round trip", "[packed]")
+{
+  constexpr std::size_t kCount = 4096;
+  const auto boards = std::make_unique<BitBoard[]>(kCount);
+  const auto result = std::make_unique<BitBoard[]>(kCount);
+  std::vector<PackedBoard> packed(kCount);
+  for (std::size_t i = 0; i < kCount; i++) {
+    bitboard::boardFromFen(kFens[i % std::size(kFens)], boards[i]);
+  }
+
+  const std::span<const BitBoard> input(boards.get(), kCount);
+  const std::span<BitBoard> output(result.get(), kCount);
+
+  REQUIRE(bitboard::packBoards(input, packed) == kCount);
+  REQUIRE(bitboard::unpackBoards(packed, output) == kCount);
+  for (std::size_t i = 0; i < kCount; i++) {
+    REQUIRE(result[i] == boards[i]);
+  }
+}
+
+TEST_CASE("PackedBoard batch benchmark", "[.][benchmark][packed]")
+{
+  constexpr std::size_t kCount = 4096;
+  const auto boards = std::make_unique<BitBoard[]>(kCount);
+  const auto result = std::make_unique<BitBoard[]>(kCount);
+  std::vector<PackedBoard> packed(kCount);
+  for (std::size_t i = 0; i < kCount; i++) {
+    bitboard::boardFromFen(kFens[i % std::size(kFens)], boards[i]);
+  }
+
+  const std::span<const BitBoard> input(boards.get(), kCount);
+  const std::span<BitBoard> output(result.get(), kCount);
+
+  BENCHMARK("pack 4096 boards")
+  {
+    return bitboard::packBoards(input, packed);
+  };
+  BENCHMARK("unpack 4096 boards")
+  {
+    return bitboard::unpackBoards(packed, output);
+  };
+}
@@ -0,0 +1,254 @@
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <bitboard/utils/pgn_reader.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using bitboard::BitBoard;
+using bitboard::PgnGame;
+using bitboard::PgnReader;
+using bitboard::PgnStatus;
+using bitboard::Turn;
+using bitboard::operator"" _p;
+
+namespace
+{
+
+const char* const kOperaGame = R"([Event "Paris"]
+[White "Morphy, Paul"]
+[Black "Duke Karl / Count Isouard"]
+[Result "1-0"]
+
+1. e4 e5 2. Nf3 d6 3. d4 Bg4 4. dxe5 Bxf3 5. Qxf3 dxe5 6. Bc4 Nf6 7. Qb3 Qe7
+8. Nc3 c6 9. Bg5 b5 10. Nxb5 cxb5 11. Bxb5+ Nbd7 12. O-O-O Rd8 13. Rxd7 Rxd7
+14. Rd1 Qe6 15. Bxd7+ Nxd7 16. Qb8+ Nxb8 17. Rd8# 1-0
+)";
+
+const char* const kOperaFinal =
+    "1n1Rkb1r/p4ppp/4q3/4p1B1/4P3/8/PPP2PPP/2K5 b k - 1 17";
+
+const char* const kAnnotatedGame = R"([Event "Annotated"]
+[FEN "4k3/1P6/8/8/8/8/8/4K3 w - - 0 1"]
+
+1. b8=Q+ {a comment with ( and 1-0} (1. b8=N $2 (1. Kd2) Kd7) 1... Kd7
+2. Qb7+ $1 ; rest of the line 2... Kd8
+Ke6 1/2-1/2
+)";
+
+const char* const kInvalidGame = R"([Event "Invalid"]
+
+1. e4 e5 2. e5 Nc6 *
+)";
+
+const char* const kIllegalGame = R"([Event "Illegal"]
+[FEN "4k3/4r3/8/8/8/8/4N3/4K3 w - - 0 1"]
+
+1. Nc3 Kd8 0-1
+)";
+
+std::string generatePgn(std::size_t games)
+{
+  const char* const samples[] = {
+      kOperaGame, kAnnotatedGame, kInvalidGame, kIllegalGame};
+  std::string text;
+  for (std::size_t i = 0; i < games; i++) {
+    text += samples[i % 4];
+    text += (i % 3 == 0) ? "\r\n" : "\n";
+  }
+  return text;
+}
+
+}  // namespace
+
+TEST_CASE("PGN game decoding", "[pgn]")
+{
+  PgnGame game;
+  std::vector<Turn> turns;
+
+  REQUIRE(readPgnGame(kOperaGame, game, turns) == PgnStatus::kPgnOk);
+  REQUIRE(game.tag("White") == "Morphy, Paul");
+  REQUIRE(game.tag("Black") == "Duke Karl / Count Isouard");
+  REQUIRE(game.tag("Site").empty());
+  REQUIRE(game.result == "1-0");
+  REQUIRE(game.turns.size() == 33);
+  REQUIRE(game.turns[22] == Turn("e1"_p, "c1"_p));
+  REQUIRE(game.board.fen() == kOperaFinal);
+
+  REQUIRE(readPgnGame(kAnnotatedGame, game, turns) == PgnStatus::kPgnOk);
+  REQUIRE(game.start.fen() == "4k3/1P6/8/8/8/8/8/4K3 w - - 0 1");
+  REQUIRE(game.result == "1/2-1/2");
+  REQUIRE(game.turns.size() == 4);
+  REQUIRE(game.board.fen() == "8/1Q6/4k3/8/8/8/8/4K3 w - - 3 3");
+
+  REQUIRE(readPgnGame(kInvalidGame, game, turns)
+          == PgnStatus::kPgnInvalidMove);
+  REQUIRE(game.turns.size() == 2);
+  REQUIRE(game.result == "*");
+
+  REQUIRE(readPgnGame(kIllegalGame, game, turns)
+          == PgnStatus::kPgnIllegalMove);
+  REQUIRE(game.turns.empty());
+  REQUIRE(game.board.fen() == game.start.fen());
+
+  REQUIRE(readPgnGame("[FEN \"8/8/8 w - -\"]\n\n*", game, turns)
+          == PgnStatus::kPgnInvalidFen);
+  REQUIRE(game.turns.empty());
+  REQUIRE(game.start.fen() == BitBoard().fen());
+  REQUIRE(game.board.fen() == BitBoard().fen());
+  REQUIRE(readPgnGame("1. d4 d5 *", game, turns) == PgnStatus::kPgnOk);
+  REQUIRE(game.turns.size() == 2);
+
+  // castling without the rook, out of check and through an attacked square
+  for (const char* fen : {"4k3/8/8/8/8/8/8/4K3 w K - 0 1",
+                          "4k3/8/8/8/8/8/4r3/4K2R w K - 0 1",
+                          "4k3/8/8/8/8/5r2/8/4K2R w K - 0 1"})
+  {
+    INFO(fen);
+    const std::string text =
+        std::string("[SetUp \"1\"]\n[FEN \"") + fen + "\"]\n\n1. O-O *";
+    REQUIRE(readPgnGame(text, game, turns) == PgnStatus::kPgnInvalidMove);
+    REQUIRE(game.turns.empty());
+    REQUIRE(game.board.fen() == fen);
+  }
+}
+
+TEST_CASE("PgnReader ordered read", "[pgn]")
+{
+  const auto text = generatePgn(200);
+
+  for (const unsigned threads : {1U, 2U, 4U}) {
+    PgnReader reader(text);
+    REQUIRE(reader.valid());
+
+    std::vector<std::string> events;
+    std::size_t last_chunk = 0;
+    bool in_order = true;
+    bool opera_final = true;
+    const auto count = reader.read(
+        [&](const PgnGame& game, std::size_t chunk)
+        {
+          in_order = in_order && chunk >= last_chunk;
+          last_chunk = chunk;
+          events.emplace_back(game.tag("Event"));
+          if (game.tag("Event") == "Paris") {
+            opera_final = opera_final && game.board.fen() == kOperaFinal
+                && game.turns.size() == 33;
+          }
+        },
+        threads,
+        true,
+        1000);
+
+    REQUIRE(in_order);
+    REQUIRE(opera_final);
+    REQUIRE(count == 200);
+    REQUIRE(events.size() == 200);
+    for (std::size_t i = 0; i < events.size(); i++) {
+      const char* const expected[] = {
+          "Paris", "Annotated", "Invalid", "Illegal"};
+      REQUIRE(events[i] == expected[i % 4]);
+    }
+  }
+}
+
+TEST_CASE("PgnReader comment lines", "[pgn]")
+{
+  // lines of a comment may start with a bracket, they don't begin a game
+  const std::string_view clocked =
+      "[Event \"Clock\"]\n"
+      "[Result \"*\"]\n"
+      "\n"
+      "1. e4 { [%clk 0:01:00]\n"
+      "[%clk 0:01:00] } 1... e5 {\n"
+      "[%clk 0:00:59] } 2. Nf3 *\n"
+      "\n";
+  std::string text;
+  for (int i = 0; i < 50; i++) {
+    text += clocked;
+  }
+
+  for (const unsigned threads : {1U, 4U}) {
+    for (const std::size_t chunk_size : {std::size_t {16}, std::size_t {100}})
+    {
+      PgnReader reader(text);
+      std::mutex mutex;
+      std::size_t ok = 0;
+      const auto count = reader.read(
+          [&](const PgnGame& game, std::size_t)
+          {
+            const std::lock_guard<std::mutex> lock(mutex);
+            ok += game.status == PgnStatus::kPgnOk && game.turns.size() == 3
+                ? 1U
+                : 0U;
+          },
+          threads,
+          false,
+          chunk_size);
+      REQUIRE(count == 50);
+      REQUIRE(ok == 50);
+    }
+  }
+}
+
+TEST_CASE("PgnReader unordered read from file", "[pgn]")
+{
+  const auto text = generatePgn(400);
+
+  const char* const path = "pgn_reader_test.pgn";
+  {
+    std::FILE* file = std::fopen(path, "wb");
+    REQUIRE(file != nullptr);
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+  }
+
+  {
+    PgnReader reader(path);
+    REQUIRE(reader.valid());
+    REQUIRE(reader.data() == text);
+
+    std::mutex mutex;
+    std::size_t ok = 0;
+    std::size_t turns = 0;
+    const auto count = reader.read(
+        [&](const PgnGame& game, std::size_t)
+        {
+          const std::lock_guard<std::mutex> lock(mutex);
+          ok += game.status == PgnStatus::kPgnOk ? 1 : 0;
+          turns += game.turns.size();
+        },
+        4,
+        false,
+        4096);
+    REQUIRE(count == 400);
+    REQUIRE(ok == 200);
+    REQUIRE(turns == 100 * (33 + 4 + 2));
+  }
+  std::remove(path);
+
+  REQUIRE_FALSE(PgnReader("no_such_file.pgn").valid());
+}
+
+TEST_CASE("PgnReader benchmark", "[.][benchmark][pgn]")
+{
+  const auto text = generatePgn(4000);
+  PgnGame game;
+  std::vector<Turn> turns;
+
+  BENCHMARK("decode the opera game")
+  {
+    return readPgnGame(kOperaGame, game, turns);
+  };
+  BENCHMARK("read 4000 games, one thread")
+  {
+    return PgnReader(text).read([](const PgnGame&, std::size_t) {}, 1);
+  };
+  BENCHMARK("read 4000 games, all threads")
+  {
+    return PgnReader(text).read([](const PgnGame&, std::size_t) {}, 0, false);
+  };
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include <bitboard/bitboard.hpp>
+
+namespace test
+{
+
+/**
+ * @brief Starts of the playouts: the standard perft positions and one with
+ * promotions on both sides.
+ */
+inline const char* const kPlayoutFens[] = {
+    bitboard::kStartPosition,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "4k2n/4r1P1/8/8/8/2b5/3PP3/4K3 w - - 0 1",
+};
+
+/**
+ * @brief Plays up to `plies` legal turns from the FEN, each picked by a fixed
+ * pattern of `seed` so the games differ but repeat between runs.
+ *
+ * Calls `visit(board, turn)` before every turn is made, and once with an
+ * invalid turn when the game ends without a legal turn.
+ */
+template<typename Visitor>
+void playout(std::string_view fen,
+             std::size_t seed,
+             std::size_t plies,
+             Visitor&& visit)
+{
+  bitboard::BitBoard board(fen);
+  for (std::size_t ply = 0; ply < plies; ++ply) {
+    bitboard::Turn turns[bitboard::kChessMaxTurns];
+    const std::size_t count = board.getTurns(turns);
+    if (count == 0) {
+      visit(static_cast<const bitboard::BitBoard&>(board), bitboard::Turn {});
+      return;
+    }
+    const bitboard::Turn turn = turns[((ply * 7) + (seed * 13)) % count];
+    visit(static_cast<const bitboard::BitBoard&>(board), turn);
+    board.executeTurn(turn);
+  }
+}
+
+}  // namespace test
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <vector>
+
+#include <bitboard/bitboard.hpp>
+#include <bitboard/utils/policy.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "playout.hpp"
+
+using bitboard::BitBoard;
+using bitboard::Color;
+using bitboard::Figure;
+using bitboard::PolicyEncoding;
+using bitboard::Turn;
+using bitboard::operator"" _p;
+
+namespace
+{
+
+constexpr PolicyEncoding kEncodings[] = {PolicyEncoding::kAlphaZero,
+                                         PolicyEncoding::kCompact};
+
+// Positions besides the playout starts: black promotions to move and an en
+// passant capture.
+const char* const kExtraFens[] = {
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 b kq - 0 1",
+    "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+};
+
+}  // namespace
+
+TEST_CASE("Policy indices", "[policy]")
+{
+  SECTION("Known indices")
+  {
+    using bitboard::policyIndex;
+    // north by two from e2, a8 first: plane 1, square 52
+    REQUIRE(policyIndex(PolicyEncoding::kAlphaZero,
+                        Color::kWhite,
+                        Turn("e2"_p, "e4"_p))
+            == 64 + 52);
+    REQUIRE(policyIndex(PolicyEncoding::kAlphaZero,
+                        Color::kBlack,
+                        Turn("e7"_p, "e5"_p))
+            == 64 + 52);
+    REQUIRE(policyIndex(PolicyEncoding::kCompact,
+                        Color::kWhite,
+                        Turn("a1"_p, "b1"_p))
+            == 0);
+    REQUIRE(policyIndex(PolicyEncoding::kCompact,
+                        Color::kWhite,
+                        Turn("h7"_p, "h8"_p, Figure::kBishop))
+            == 1857);
+    REQUIRE(policyIndex(PolicyEncoding::kCompact,
+                        Color::kBlack,
+                        Turn("a2"_p, "a1"_p, Figure::kQueen))
+            == 1792);
+    // knights promote with the plain move, queens with the queen move
+    REQUIRE(policyIndex(PolicyEncoding::kCompact,
+                        Color::kWhite,
+                        Turn("b7"_p, "b8"_p, Figure::kKnight))
+            == policyIndex(PolicyEncoding::kCompact,
+                           Color::kWhite,
+                           Turn("b7"_p, "b8"_p)));
+    REQUIRE(policyIndex(PolicyEncoding::kAlphaZero,
+                        Color::kWhite,
+                        Turn("b7"_p, "b8"_p, Figure::kQueen))
+            == policyIndex(PolicyEncoding::kAlphaZero,
+                           Color::kWhite,
+                           Turn("b7"_p, "b8"_p)));
+    REQUIRE(policyIndex(PolicyEncoding::kAlphaZero,
+                        Color::kWhite,
+                        Turn("a1"_p, "b4"_p))
+            == bitboard::kNoPolicyIndex);
+    REQUIRE(policyIndex(PolicyEncoding::kCompact,
+                        Color::kWhite,
+                        Turn("b2"_p, "b3"_p, Figure::kRook))
+            == bitboard::kNoPolicyIndex);
+  }
+
+  SECTION("Indices and turns round trip")
+  {
+    for (const char* fen : {"4k3/8/8/8/8/8/8/4K3 w - - 0 1",
+                            "4k3/8/8/8/8/8/8/4K3 b - - 0 1"})
+    {
+      const BitBoard board(fen);
+      for (const auto encoding : kEncodings) {
+        std::size_t valid = 0;
+        for (std::size_t i = 0; i < bitboard::policySize(encoding); ++i) {
+          const auto index = static_cast<uint16_t>(i);
+          const Turn turn = bitboard::policyTurn(board, encoding, index);
+          if (!turn.valid()) {
+            continue;
+          }
+          valid++;
+          INFO(i << " " << turn.toString());
+          REQUIRE(bitboard::policyIndex(encoding, board.side(), turn) == index);
+        }
+        REQUIRE(valid
+                == (encoding == PolicyEncoding::kAlphaZero
+                        ? 1792 + (22 * 3)
+                        : bitboard::kCompactPolicySize));
+        REQUIRE(!bitboard::policyTurn(
+                     board,
+                     encoding,
+                     static_cast<uint16_t>(bitboard::policySize(encoding)))
+                     .valid());
+      }
+    }
+  }
+
+  SECTION("Legal masks")
+  {
+    std::vector<const char*> fens(std::begin(test::kPlayoutFens),
+                                  std::end(test::kPlayoutFens));
+    fens.insert(fens.end(), std::begin(kExtraFens), std::end(kExtraFens));
+    for (const char* fen : fens) {
+      const BitBoard board(fen);
+      Turn turns[bitboard::kChessMaxTurns];
+      const std::size_t count = board.getTurns(turns);
+      for (const auto encoding : kEncodings) {
+        INFO(fen);
+        std::vector<uint64_t> mask(bitboard::policyWords(encoding), ~0ULL);
+        REQUIRE(bitboard::policyMask(board, encoding, mask) == count);
+
+        std::vector<uint16_t> indices(count);
+        bitboard::policyIndices(
+            encoding, board.side(), std::span(turns, count), indices);
+        std::size_t bits = 0;
+        for (const uint64_t word : mask) {
+          bits += static_cast<std::size_t>(std::popcount(word));
+        }
+        REQUIRE(bits == count);
+        for (std::size_t i = 0; i < count; ++i) {
+          const uint16_t index = indices[i];
+          REQUIRE(((mask[index / 64] >> (index % 64)) & 1U) == 1);
+          const Turn turn = bitboard::policyTurn(board, encoding, index);
+          REQUIRE(turn == turns[i]);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Policy indices benchmark", "[.][benchmark][policy]")
+{
+  const BitBoard board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  uint64_t mask[bitboard::policyWords(PolicyEncoding::kAlphaZero)];
+
+  BENCHMARK("legal mask")
+  {
+    return bitboard::policyMask(board, PolicyEncoding::kAlphaZero, mask);
+  };
+}
@@ -0,0 +1,96 @@
+#include <bitboard/bitboard.hpp>
+#include <bitboard/utils/psqt.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "playout.hpp"
+
+using bitboard::BitBoard;
+using bitboard::Figure;
+using bitboard::Position;
+using bitboard::PsqtScore;
+using bitboard::Turn;
+using bitboard::operator"" _p;
+
+using Board = bitboard::PsqtBoard<bitboard::SimplifiedPsqt>;
+
+TEST_CASE("PsqtBoard", "[psqt]")
+{
+  SECTION("Start position is balanced")
+  {
+    const Board board(bitboard::kStartPosition);
+    REQUIRE(board.score() == PsqtScore {});
+    REQUIRE(Board::evaluate(board.board()) == PsqtScore {});
+  }
+
+  SECTION("Tables are mirrored for black")
+  {
+    const Board board("4k3/8/8/8/3P4/8/8/4K3 w - - 0 1");
+    REQUIRE(board.score().material == 100);
+    // d4 +20, the kings cancel out
+    REQUIRE(board.score().midgame == 20);
+    REQUIRE(board.score().endgame == 20);
+  }
+
+  SECTION("Sums follow set and swap")
+  {
+    Board board(bitboard::kStartPosition);
+    board.set("e2"_p, Figure::kEmpty);
+    REQUIRE(board.score().material == -100);
+    board.set("e4"_p, Figure::kWQueen);
+    board.swap("e4"_p, "a7"_p);
+    board.set("h8"_p, Figure::kWKnight);
+    REQUIRE(board.score() == Board::evaluate(board.board()));
+  }
+
+  SECTION("Sums follow every kind of turn")
+  {
+    for (const char* fen : test::kPlayoutFens) {
+      for (std::size_t seed = 0; seed < 8; ++seed) {
+        Board board(fen);
+        test::playout(fen,
+                      seed,
+                      60,
+                      [&board](const BitBoard& played, Turn turn)
+                      {
+                        INFO(played.fen());
+                        REQUIRE(board.board().fen() == played.fen());
+                        REQUIRE(board.score() == Board::evaluate(played));
+                        if (turn.valid()) {
+                          board.executeTurn(turn);
+                        }
+                      });
+      }
+    }
+  }
+}
+
+TEST_CASE("PsqtBoard benchmark", "[.][benchmark][psqt]")
+{
+  const Board board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  Turn turns[bitboard::kChessMaxTurns];
+  const std::size_t count = board.board().getTurns(turns);
+
+  BENCHMARK("incremental sums after every turn")
+  {
+    int32_t result = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      Board next(board);
+      next.executeTurn(turns[i]);
+      result += next.score().midgame;
+    }
+    return result;
+  };
+
+  BENCHMARK("recomputed sums after every turn")
+  {
+    int32_t result = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      BitBoard next(board.board());
+      next.executeTurn(turns[i]);
+      result += Board::evaluate(next).midgame;
+    }
+    return result;
+  };
+}
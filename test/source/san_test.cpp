@@ -0,0 +1,187 @@
+#include <string>
+#include <string_view>
+
+#include <bitboard/bitboard.hpp>
+#include <bitboard/utils/san.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using bitboard::BitBoard;
+using bitboard::Figure;
+using bitboard::Turn;
+using bitboard::turnFromSan;
+using bitboard::turnToSan;
+using bitboard::operator"" _p;
+
+TEST_CASE("SAN decoding", "[san]")
+{
+  SECTION("Pawns and figures from the start position")
+  {
+    const BitBoard board(bitboard::kStartPosition);
+    REQUIRE(turnFromSan(board, "e4") == Turn("e2"_p, "e4"_p));
+    REQUIRE(turnFromSan(board, "e3") == Turn("e2"_p, "e3"_p));
+    REQUIRE(turnFromSan(board, "Nf3") == Turn("g1"_p, "f3"_p));
+    REQUIRE(turnFromSan(board, "Na3!?") == Turn("b1"_p, "a3"_p));
+    REQUIRE_FALSE(turnFromSan(board, "e5").valid());
+    REQUIRE_FALSE(turnFromSan(board, "Ke2").valid());
+    REQUIRE_FALSE(turnFromSan(board, "Bc4").valid());
+    REQUIRE_FALSE(turnFromSan(board, "exd3").valid());
+    REQUIRE_FALSE(turnFromSan(board, "").valid());
+    REQUIRE_FALSE(turnFromSan(board, "Nf3x").valid());
+    REQUIRE_FALSE(turnFromSan(board, "O-O").valid());
+  }
+
+  SECTION("Disambiguation")
+  {
+    const BitBoard knights("4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1");
+    REQUIRE_FALSE(turnFromSan(knights, "Nd2").valid());
+    REQUIRE(turnFromSan(knights, "Nbd2") == Turn("b1"_p, "d2"_p));
+    REQUIRE(turnFromSan(knights, "Nfd2") == Turn("f1"_p, "d2"_p));
+    REQUIRE(turnFromSan(knights, "Nf1d2") == Turn("f1"_p, "d2"_p));
+
+    const BitBoard rooks("4k3/8/8/R7/8/8/8/R3K3 w - - 0 1");
+    REQUIRE_FALSE(turnFromSan(rooks, "Ra3").valid());
+    REQUIRE(turnFromSan(rooks, "R1a3") == Turn("a1"_p, "a3"_p));
+    REQUIRE(turnFromSan(rooks, "R5a3") == Turn("a5"_p, "a3"_p));
+
+    // the knight on e2 is pinned, so Nc3 isn't ambiguous
+    const BitBoard pinned("4r1k1/8/8/8/8/8/4N3/1N2K3 w - - 0 1");
+    REQUIRE(turnFromSan(pinned, "Nc3") == Turn("b1"_p, "c3"_p));
+  }
+
+  SECTION("Castling, promotion and el passant")
+  {
+    const BitBoard castling("r3k2r/8/8/8/8/8/8/R3K2R b Kq - 0 1");
+    REQUIRE(turnFromSan(castling, "O-O-O") == Turn("e8"_p, "c8"_p));
+    REQUIRE(turnFromSan(castling, "0-0-0+") == Turn("e8"_p, "c8"_p));
+    REQUIRE_FALSE(turnFromSan(castling, "O-O").valid());
+    // no rook, out of check, through an attacked square
+    for (const char* fen : {"4k3/8/8/8/8/8/8/4K3 w K - 0 1",
+                            "4k3/8/8/8/8/8/4r3/4K2R w K - 0 1",
+                            "4k3/8/8/8/8/5r2/8/4K2R w K - 0 1"})
+    {
+      INFO(fen);
+      REQUIRE_FALSE(turnFromSan(BitBoard(fen), "O-O").valid());
+    }
+
+    const BitBoard promotion("3r1k2/4P3/8/8/8/8/8/4K3 w - - 0 1");
+    REQUIRE(turnFromSan(promotion, "exd8=Q+")
+            == Turn("e7"_p, "d8"_p, Figure::kQueen));
+    REQUIRE(turnFromSan(promotion, "e8N")
+            == Turn("e7"_p, "e8"_p, Figure::kKnight));
+    REQUIRE_FALSE(turnFromSan(promotion, "e8").valid());
+    REQUIRE_FALSE(turnFromSan(promotion, "e8=K").valid());
+
+    const BitBoard el_passant(
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3");
+    REQUIRE(turnFromSan(el_passant, "exf6") == Turn("e5"_p, "f6"_p));
+    REQUIRE_FALSE(turnFromSan(el_passant, "exd6").valid());
+    REQUIRE(turnFromSan(el_passant, "Kf2").valid() == false);
+  }
+}
+
+namespace
+{
+
+std::string toSan(const BitBoard& board, Turn turn)
+{
+  char buffer[bitboard::kSanMaxLength];
+  return {buffer, turnToSan(board, turn, buffer)};
+}
+
+}  // namespace
+
+TEST_CASE("SAN formatting", "[san]")
+{
+  SECTION("Figures, disambiguation and captures")
+  {
+    const BitBoard board(bitboard::kStartPosition);
+    REQUIRE(toSan(board, Turn("e2"_p, "e4"_p)) == "e4");
+    REQUIRE(toSan(board, Turn("g1"_p, "f3"_p)) == "Nf3");
+    REQUIRE(toSan(board, Turn("e7"_p, "e5"_p)).empty());
+    REQUIRE(toSan(board, Turn("e4"_p, "e5"_p)).empty());
+
+    const BitBoard knights("4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1");
+    REQUIRE(toSan(knights, Turn("b1"_p, "d2"_p)) == "Nbd2");
+    REQUIRE(toSan(knights, Turn("f1"_p, "g3"_p)) == "Ng3");
+
+    const BitBoard rooks("4k3/8/8/R7/8/8/8/R3K3 w - - 0 1");
+    REQUIRE(toSan(rooks, Turn("a1"_p, "a3"_p)) == "R1a3");
+
+    const BitBoard pinned("4r1k1/8/8/8/8/8/4N3/1N2K3 w - - 0 1");
+    REQUIRE(toSan(pinned, Turn("b1"_p, "c3"_p)) == "Nc3");
+
+    const BitBoard queens("7k/8/8/8/8/Q7/1p6/Q1Q4K w - - 0 1");
+    REQUIRE(toSan(queens, Turn("a1"_p, "b2"_p)) == "Qa1xb2+");
+    REQUIRE(toSan(queens, Turn("c1"_p, "b2"_p)) == "Qcxb2+");
+    REQUIRE(toSan(queens, Turn("a3"_p, "b2"_p)) == "Q3xb2+");
+  }
+
+  SECTION("Castling, promotion, el passant and mate")
+  {
+    const BitBoard castling("r3k2r/8/8/8/8/8/8/R3K2R b Kq - 0 1");
+    REQUIRE(toSan(castling, Turn("e8"_p, "c8"_p)) == "O-O-O");
+
+    const BitBoard promotion("3r1k2/4P3/8/8/8/8/8/4K3 w - - 0 1");
+    REQUIRE(toSan(promotion, Turn("e7"_p, "d8"_p, Figure::kQueen))
+            == "exd8=Q+");
+    REQUIRE(toSan(promotion, Turn("e7"_p, "e8"_p, Figure::kKnight))
+            == "e8=N");
+
+    const BitBoard el_passant(
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3");
+    REQUIRE(toSan(el_passant, Turn("e5"_p, "f6"_p)) == "exf6");
+
+    const BitBoard mate("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    REQUIRE(toSan(mate, Turn("a1"_p, "a8"_p)) == "Ra8#");
+    const BitBoard escape("6k1/5pp1/8/8/8/8/8/R5K1 w - - 0 1");
+    REQUIRE(toSan(escape, Turn("a1"_p, "a8"_p)) == "Ra8+");
+  }
+
+  SECTION("Round trip of a game")
+  {
+    const std::string_view moves[] = {
+        "e4",   "e5",   "Nf3",  "d6",   "d4",    "Bg4",  "dxe5", "Bxf3",
+        "Qxf3", "dxe5", "Bc4",  "Nf6",  "Qb3",   "Qe7",  "Nc3",  "c6",
+        "Bg5",  "b5",   "Nxb5", "cxb5", "Bxb5+", "Nbd7", "O-O-O", "Rd8",
+        "Rxd7", "Rxd7", "Rd1",  "Qe6",  "Bxd7+", "Nxd7", "Qb8+", "Nxb8",
+        "Rd8#"};
+
+    BitBoard board(bitboard::kStartPosition);
+    for (const auto san : moves) {
+      const Turn turn = turnFromSan(board, san);
+      REQUIRE(turn.valid());
+      REQUIRE(toSan(board, turn) == san);
+      board.executeTurn(turn);
+    }
+  }
+}
+
+TEST_CASE("SAN benchmark", "[.][benchmark][san]")
+{
+  const BitBoard board(
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  const Turn turns[] = {Turn("e5"_p, "f7"_p),
+                        Turn("e2"_p, "a6"_p),
+                        Turn("e1"_p, "g1"_p),
+                        Turn("d5"_p, "e6"_p),
+                        Turn("f3"_p, "f6"_p)};
+  char buffer[bitboard::kSanMaxLength];
+
+  BENCHMARK("format 5 turns")
+  {
+    std::size_t size = 0;
+    for (const auto turn : turns) {
+      size += turnToSan(board, turn, buffer);
+    }
+    return size;
+  };
+  BENCHMARK("decode 5 turns")
+  {
+    int valid = 0;
+    for (const auto* san : {"Nxf7", "Bxa6", "O-O", "dxe6", "Qxf6"}) {
+      valid += turnFromSan(board, san).valid() ? 1 : 0;
+    }
+    return valid;
+  };
+}
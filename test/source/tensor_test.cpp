@@ -0,0 +1,127 @@
+#include <vector>
+
+#include <bitboard/bitboard.hpp>
+#include <bitboard/utils/tensor.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "playout.hpp"
+
+using bitboard::BitBoard;
+using bitboard::Color;
+using bitboard::Figure;
+using bitboard::Position;
+using bitboard::operator"" _p;
+
+namespace
+{
+
+// Plane of the figure as the tensor lays them out, empty squares have none.
+int plane(Figure figure)
+{
+  const auto value = static_cast<int>(figure);
+  if (value == 0) {
+    return -1;
+  }
+  return value > 0 ? value - 1 : 5 - value;
+}
+
+// The tensors hold only zeros and ones, compared as integers so that floats
+// need no equality.
+template<typename Value>
+void check(const BitBoard& board, const Value* tensor)
+{
+  INFO(board.fen());
+  const auto at = [tensor](int plane_index, uint8_t square)
+  { return static_cast<int>(tensor[(plane_index * 64) + square]); };
+  for (uint8_t square = 0; square < 64; ++square) {
+    const Position position(square);
+    const int expected = plane(board.get(position));
+    for (int i = 0; i < 12; ++i) {
+      REQUIRE(at(i, square) == (i == expected ? 1 : 0));
+    }
+    const int side = board.side() == Color::kBlack ? 1 : 0;
+    REQUIRE(at(bitboard::kTensorSidePlane, square) == side);
+    const int el_passant = board.elPassant() == position ? 1 : 0;
+    REQUIRE(at(bitboard::kTensorElPassantPlane, square) == el_passant);
+  }
+}
+
+// Planes the playout starts don't fill: an en passant square and uneven
+// castling rights.
+const char* const kElPassantFen =
+    "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3";
+const char* const kCastlingFen =
+    "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b Kq - 0 1";
+
+}  // namespace
+
+TEST_CASE("Board tensors", "[tensor]")
+{
+  std::vector<BitBoard> boards;
+  for (std::size_t i = 0; i < 7; ++i) {
+    for (const char* fen : test::kPlayoutFens) {
+      boards.emplace_back(fen);
+    }
+    boards.emplace_back(kElPassantFen);
+    boards.emplace_back(kCastlingFen);
+  }
+
+  SECTION("Bytes")
+  {
+    std::vector<uint8_t> tensor(boards.size() * bitboard::kTensorBoardSize);
+    bitboard::boardsToTensor(boards, tensor.data());
+    for (std::size_t i = 0; i < boards.size(); ++i) {
+      check(boards[i], tensor.data() + (i * bitboard::kTensorBoardSize));
+    }
+  }
+
+  SECTION("Floats")
+  {
+    std::vector<float> tensor(boards.size() * bitboard::kTensorBoardSize);
+    bitboard::boardsToTensor(boards, tensor.data());
+    for (std::size_t i = 0; i < boards.size(); ++i) {
+      check(boards[i], tensor.data() + (i * bitboard::kTensorBoardSize));
+    }
+  }
+
+  SECTION("Castling planes are constant")
+  {
+    const BitBoard board(kCastlingFen);
+    std::vector<uint8_t> tensor(bitboard::kTensorBoardSize);
+    bitboard::boardsToTensor(std::span(&board, 1), tensor.data());
+    const uint8_t* castling =
+        tensor.data() + (bitboard::kTensorCastlingPlane * 64);
+    // Kq: white king side and black queen side only
+    const uint8_t expected[4] = {1, 0, 0, 1};
+    for (std::size_t right = 0; right < 4; ++right) {
+      for (std::size_t square = 0; square < 64; ++square) {
+        REQUIRE(castling[(right * 64) + square] == expected[right]);
+      }
+    }
+    REQUIRE(tensor[(bitboard::kTensorSidePlane * 64) + "e2"_p.index()] == 1);
+  }
+}
+
+TEST_CASE("Board tensors benchmark", "[.][benchmark][tensor]")
+{
+  std::vector<BitBoard> boards;
+  for (std::size_t i = 0; i < 256; ++i) {
+    boards.emplace_back(
+        test::kPlayoutFens[i % std::size(test::kPlayoutFens)]);
+  }
+  std::vector<uint8_t> bytes(boards.size() * bitboard::kTensorBoardSize);
+  std::vector<float> floats(boards.size() * bitboard::kTensorBoardSize);
+
+  BENCHMARK("256 boards to bytes")
+  {
+    bitboard::boardsToTensor(boards, bytes.data());
+    return bytes.back();
+  };
+
+  BENCHMARK("256 boards to floats")
+  {
+    bitboard::boardsToTensor(boards, floats.data());
+    return floats.back();
+  };
+}
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <iterator>
+
 #include <bitboard/turn.hpp>
 #include <catch2/catch_test_macros.hpp>
 
@@ -97,3 +100,54 @@ TEST_CASE("Turn toString", "[Turn]")
   REQUIRE(Turn("a4b3").toString() == "a4b3");
   REQUIRE(Turn("a4b3q").toString() == "a4b3q");
 }
+
+TEST_CASE("Turn from UCI notation", "[Turn]")
+{
+  REQUIRE(Turn("e7e8n").figure() == Figure::kKnight);
+  REQUIRE(Turn("e7e8n").toString() == "e7e8n");
+  REQUIRE_FALSE(Turn("e7e8k").valid());
+  REQUIRE_FALSE(Turn("e2e").valid());
+  REQUIRE_FALSE(Turn("e2e4q5").valid());
+  REQUIRE_FALSE(Turn("").valid());
+
+  char buffer[bitboard::kTurnMaxLength];
+  REQUIRE(Turn("h2h1r").toChars(buffer) == 5);
+  REQUIRE(std::string_view(buffer, 5) == "h2h1r");
+  REQUIRE(Turn("a8h1").toChars(buffer) == 4);
+  REQUIRE(std::string_view(buffer, 4) == "a8h1");
+}
+
+TEST_CASE("Turn kinds", "[Turn]")
+{
+  using bitboard::TurnKind;
+
+  const Turn push(Position("e2"), Position("e4"), TurnKind::kDoublePush);
+  REQUIRE(push.valid());
+  REQUIRE(push.kind() == TurnKind::kDoublePush);
+  REQUIRE_FALSE(push.capture());
+  REQUIRE(push == Turn("e2e4"));
+  REQUIRE(Turn("e2e4").kind() == TurnKind::kUnknown);
+
+  const Turn promotion(Position("b7"),
+                       Position("a8"),
+                       bitboard::promotionKind(Figure::kRook, true));
+  REQUIRE(promotion.kind() == TurnKind::kPromotionCapture);
+  REQUIRE(promotion.figure() == Figure::kRook);
+  REQUIRE(promotion.promotion());
+  REQUIRE(promotion.capture());
+  REQUIRE(promotion == Turn("b7a8r"));
+  REQUIRE(promotion != Turn("b7a8q"));
+
+  REQUIRE(Turn(Position("e7"), Position("e8"), Figure::kQueen).kind()
+          == TurnKind::kPromotion);
+  REQUIRE(Turn(Position("e5"), Position("d6"), TurnKind::kElPassant).capture());
+  REQUIRE_FALSE(
+      Turn(Position("e1"), Position("g1"), static_cast<TurnKind>(6)).valid());
+  REQUIRE_FALSE(Turn(Position("e7"), Position("e8"), Figure::kKing).valid());
+  REQUIRE_FALSE(Turn(Position("e7"), Position("e8"), Figure::kBQueen).valid());
+
+  bitboard::ScoredTurn turns[] = {{push, 10}, {promotion, 900}, {Turn(), -5}};
+  std::sort(std::begin(turns), std::end(turns));
+  REQUIRE(turns[0].turn == promotion);
+  REQUIRE(turns[2].score == -5);
+}
@@ -0,0 +1,102 @@
+#include <string>
+#include <vector>
+
+#include <bitboard/bitboard.hpp>
+#include <bitboard/utils/uci.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using bitboard::BitBoard;
+using bitboard::Turn;
+using bitboard::UciStatus;
+using bitboard::operator"" _p;
+
+TEST_CASE("UCI move lists", "[uci]")
+{
+  Turn turns[8];
+  std::size_t count = 0;
+
+  REQUIRE(bitboard::turnsFromUci(" e2e4\te7e5  g1f3 b8c6\r\n", turns, count)
+          == UciStatus::kUciOk);
+  REQUIRE(count == 4);
+  REQUIRE(turns[3] == Turn("b8"_p, "c6"_p));
+
+  REQUIRE(bitboard::turnsFromUci("e2e4 e7e9 g1f3", turns, count)
+          == UciStatus::kUciInvalidTurn);
+  REQUIRE(count == 1);
+
+  REQUIRE(bitboard::turnsFromUci("a2a3 a7a6 b2b3 b7b6 c2c3 c7c6 d2d3 d7d6 e2e3",
+                                 turns,
+                                 count)
+          == UciStatus::kUciTooManyTurns);
+  REQUIRE(count == 8);
+
+  char buffer[8 * (bitboard::kTurnMaxLength + 1)];
+  REQUIRE(std::string(buffer, bitboard::turnsToUci({turns, 8}, buffer))
+          == "a2a3 a7a6 b2b3 b7b6 c2c3 c7c6 d2d3 d7d6");
+  REQUIRE(bitboard::turnsToUci({}, buffer) == 0);
+}
+
+TEST_CASE("UCI position command", "[uci]")
+{
+  Turn turns[8];
+  std::size_t count = 0;
+  BitBoard board;
+
+  REQUIRE(bitboard::positionFromUci(
+              "position startpos moves e2e4 e7e5 e7e8q", board, turns, count)
+          == UciStatus::kUciOk);
+  REQUIRE(board == bitboard::kStartBitBoard);
+  REQUIRE(count == 3);
+  REQUIRE(turns[2].figure() == bitboard::Figure::kQueen);
+
+  REQUIRE(bitboard::positionFromUci(
+              "position fen 4k3/8/8/8/8/8/8/4K2R w K - 3 20 moves e1g1",
+              board,
+              turns,
+              count)
+          == UciStatus::kUciOk);
+  REQUIRE(board.fen() == "4k3/8/8/8/8/8/8/4K2R w K - 3 20");
+  REQUIRE(count == 1);
+
+  REQUIRE(bitboard::positionFromUci(
+              "fen 4k3/8/8/8/8/8/8/4K3 b - -", board, turns, count)
+          == UciStatus::kUciOk);
+  REQUIRE(board.fen() == "4k3/8/8/8/8/8/8/4K3 b - - 0 1");
+  REQUIRE(count == 0);
+
+  REQUIRE(bitboard::positionFromUci("startpos", board, turns, count)
+          == UciStatus::kUciOk);
+  REQUIRE(board == bitboard::kStartBitBoard);
+
+  const BitBoard copy(board);
+  REQUIRE(bitboard::positionFromUci("position fen 8/8 w", board, turns, count)
+          == UciStatus::kUciInvalidPosition);
+  REQUIRE(bitboard::positionFromUci("position", board, turns, count)
+          == UciStatus::kUciInvalidPosition);
+  REQUIRE(board == copy);
+  REQUIRE(bitboard::positionFromUci(
+              "position startpos e2e4", board, turns, count)
+          == UciStatus::kUciInvalidTurn);
+}
+
+TEST_CASE("UCI benchmark", "[.][benchmark][uci]")
+{
+  std::string command = "position startpos moves";
+  for (int i = 0; i < 40; i++) {
+    command += " g1f3 g8f6 f3g1 f6g8 b1c3 b8c6 c3b1 c6b8";
+  }
+  std::vector<Turn> turns(512);
+  std::vector<char> buffer(turns.size() * (bitboard::kTurnMaxLength + 1));
+  BitBoard board;
+  std::size_t count = 0;
+
+  BENCHMARK("parse 320 moves")
+  {
+    return bitboard::positionFromUci(command, board, turns, count);
+  };
+  BENCHMARK("format 320 moves")
+  {
+    return bitboard::turnsToUci({turns.data(), count}, buffer.data());
+  };
+}